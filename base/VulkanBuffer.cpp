@@ -22,6 +22,14 @@ namespace vks
 	*/
 	VkResult Buffer::map(VkDeviceSize size, VkDeviceSize offset)
 	{
+		// Sub-allocated memory stays mapped, mapping only hands out the pointer
+		if (allocator) {
+			if (!allocation.mapped) {
+				return VK_ERROR_MEMORY_MAP_FAILED;
+			}
+			mapped = static_cast<uint8_t*>(allocation.mapped) + offset;
+			return VK_SUCCESS;
+		}
 		return vkMapMemory(device, memory, offset, size, 0, &mapped);
 	}
 
@@ -34,7 +42,9 @@ namespace vks
 	{
 		if (mapped)
 		{
-			vkUnmapMemory(device, memory);
+			if (!allocator) {
+				vkUnmapMemory(device, memory);
+			}
 			mapped = nullptr;
 		}
 	}
@@ -48,7 +58,7 @@ namespace vks
 	*/
 	VkResult Buffer::bind(VkDeviceSize offset)
 	{
-		return vkBindBufferMemory(device, buffer, memory, offset);
+		return vkBindBufferMemory(device, buffer, memory, allocation.offset + offset);
 	}
 
 	/**
@@ -90,6 +100,9 @@ namespace vks
 	*/
 	VkResult Buffer::flush(VkDeviceSize size, VkDeviceSize offset)
 	{
+		if (allocator) {
+			return allocator->flush(allocation, size, offset);
+		}
 		VkMappedMemoryRange mappedRange = {};
 		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
 		mappedRange.memory = memory;
@@ -110,6 +123,9 @@ namespace vks
 	*/
 	VkResult Buffer::invalidate(VkDeviceSize size, VkDeviceSize offset)
 	{
+		if (allocator) {
+			return allocator->invalidate(allocation, size, offset);
+		}
 		VkMappedMemoryRange mappedRange = {};
 		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
 		mappedRange.memory = memory;
@@ -127,7 +143,11 @@ namespace vks
 		{
 			vkDestroyBuffer(device, buffer, nullptr);
 		}
-		if (memory)
+		if (allocator)
+		{
+			allocator->free(allocation);
+		}
+		else if (memory)
 		{
 			vkFreeMemory(device, memory, nullptr);
 		}
@@ -14,6 +14,7 @@
 
 #include "vulkan/vulkan.h"
 #include "VulkanTools.h"
+#include "VulkanMemoryAllocator.h"
 
 namespace vks
 {	
@@ -34,6 +35,9 @@ namespace vks
 		VkBufferUsageFlags usageFlags;
 		/** @brief Memory property flags to be filled by external source at buffer creation (to query at some later point) */
 		VkMemoryPropertyFlags memoryPropertyFlags;
+		/** @brief Set if the memory was sub-allocated, memory is then shared with other resources and only the allocation's range belongs to this buffer */
+		vks::MemoryAllocator* allocator = nullptr;
+		vks::Allocation allocation;
 		VkResult map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 		void unmap();
 		VkResult bind(VkDeviceSize offset = 0);
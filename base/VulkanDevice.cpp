@@ -64,6 +64,14 @@ namespace vks
 	*/
 	VulkanDevice::~VulkanDevice()
 	{
+		if (uploader.isCreated())
+		{
+			uploader.destroy();
+		}
+		if (memoryAllocator.isCreated())
+		{
+			memoryAllocator.destroy();
+		}
 		if (commandPool)
 		{
 			vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
@@ -301,6 +309,8 @@ namespace vks
 		// Create a default command pool for graphics command buffers
 		commandPool = createCommandPool(queueFamilyIndices.graphics);
 
+		memoryAllocator.create(logicalDevice, properties.limits, memoryProperties);
+
 		return result;
 	}
 
@@ -314,6 +324,8 @@ namespace vks
 	* @param memory Pointer to the memory handle acquired by the function
 	* @param data Pointer to the data that should be copied to the buffer after creation (optional, if not set, no data is copied over)
 	*
+	* @note The buffer gets its own memory object, use the overloads taking a vks::Buffer or vks::Allocation to sub-allocate
+	*
 	* @return VK_SUCCESS if buffer handle and memory have been created and (optionally passed) data has been copied
 	*/
 	VkResult VulkanDevice::createBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize size, VkBuffer *buffer, VkDeviceMemory *memory, void *data)
@@ -382,21 +394,18 @@ namespace vks
 		VkBufferCreateInfo bufferCreateInfo = vks::initializers::bufferCreateInfo(usageFlags, size);
 		VK_CHECK_RESULT(vkCreateBuffer(logicalDevice, &bufferCreateInfo, nullptr, &buffer->buffer));
 
-		// Create the memory backing up the buffer handle
+		// Sub-allocate the memory backing up the buffer handle
 		VkMemoryRequirements memReqs;
-		VkMemoryAllocateInfo memAlloc = vks::initializers::memoryAllocateInfo();
 		vkGetBufferMemoryRequirements(logicalDevice, buffer->buffer, &memReqs);
-		memAlloc.allocationSize = memReqs.size;
-		// Find a memory type index that fits the properties of the buffer
-		memAlloc.memoryTypeIndex = getMemoryType(memReqs.memoryTypeBits, memoryPropertyFlags);
 		// If the buffer has VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT set we also need to enable the appropriate flag during allocation
 		VkMemoryAllocateFlagsInfoKHR allocFlagsInfo{};
 		if (usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
 			allocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO_KHR;
 			allocFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-			memAlloc.pNext = &allocFlagsInfo;
 		}
-		VK_CHECK_RESULT(vkAllocateMemory(logicalDevice, &memAlloc, nullptr, &buffer->memory));
+		VK_CHECK_RESULT(memoryAllocator.allocate(memReqs, getMemoryType(memReqs.memoryTypeBits, memoryPropertyFlags), vks::MemoryAllocator::ResourceKind::Buffer, vks::MemoryAllocator::Strategy::FreeList, &buffer->allocation, allocFlagsInfo.sType ? &allocFlagsInfo : nullptr));
+		buffer->allocator = &memoryAllocator;
+		buffer->memory = buffer->allocation.memory;
 
 		buffer->alignment = memReqs.alignment;
 		buffer->size = size;
@@ -421,6 +430,68 @@ namespace vks
 		return buffer->bind();
 	}
 
+	/**
+	* Create a buffer with sub-allocated memory
+	*
+	* @param usageFlags Usage flag bit mask for the buffer (i.e. index, vertex, uniform buffer)
+	* @param memoryPropertyFlags Memory properties for this buffer (i.e. device local, host visible, coherent)
+	* @param size Size of the buffer in bytes
+	* @param buffer Pointer to the buffer handle acquired by the function
+	* @param allocation Pointer to the allocation acquired by the function, free with memoryAllocator.free()
+	* @param data Pointer to the data that should be copied to the buffer after creation (optional, if not set, no data is copied over)
+	* @param strategy (Optional) Allocation strategy, short lived buffers like staging buffers should use the linear strategy
+	*
+	* @return VK_SUCCESS if buffer handle and memory have been created and (optionally passed) data has been copied
+	*/
+	VkResult VulkanDevice::createBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize size, VkBuffer *buffer, vks::Allocation *allocation, void *data, vks::MemoryAllocator::Strategy strategy)
+	{
+		VkBufferCreateInfo bufferCreateInfo = vks::initializers::bufferCreateInfo(usageFlags, size);
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VK_CHECK_RESULT(vkCreateBuffer(logicalDevice, &bufferCreateInfo, nullptr, buffer));
+
+		VkMemoryRequirements memReqs;
+		vkGetBufferMemoryRequirements(logicalDevice, *buffer, &memReqs);
+		VkMemoryAllocateFlagsInfoKHR allocFlagsInfo{};
+		if (usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+			allocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO_KHR;
+			allocFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
+		}
+		VK_CHECK_RESULT(memoryAllocator.allocate(memReqs, getMemoryType(memReqs.memoryTypeBits, memoryPropertyFlags), vks::MemoryAllocator::ResourceKind::Buffer, strategy, allocation, allocFlagsInfo.sType ? &allocFlagsInfo : nullptr));
+
+		if (data != nullptr)
+		{
+			assert(allocation->mapped);
+			memcpy(allocation->mapped, data, size);
+			if ((memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
+			{
+				memoryAllocator.flush(*allocation, size);
+			}
+		}
+
+		VK_CHECK_RESULT(vkBindBufferMemory(logicalDevice, *buffer, allocation->memory, allocation->offset));
+
+		return VK_SUCCESS;
+	}
+
+	/**
+	* Sub-allocate memory for an image and bind it
+	*
+	* @param image Image to allocate memory for
+	* @param memoryPropertyFlags Memory properties for the image (usually device local)
+	* @param allocation Pointer to the allocation acquired by the function, free with memoryAllocator.free()
+	* @param linearTiling (Optional) Set for images created with VK_IMAGE_TILING_LINEAR, these may share blocks with buffers
+	*
+	* @return VK_SUCCESS if the memory has been allocated and bound
+	*/
+	VkResult VulkanDevice::allocateImageMemory(VkImage image, VkMemoryPropertyFlags memoryPropertyFlags, vks::Allocation *allocation, bool linearTiling)
+	{
+		VkMemoryRequirements memReqs;
+		vkGetImageMemoryRequirements(logicalDevice, image, &memReqs);
+		const vks::MemoryAllocator::ResourceKind kind = linearTiling ? vks::MemoryAllocator::ResourceKind::Buffer : vks::MemoryAllocator::ResourceKind::OptimalImage;
+		VK_CHECK_RESULT(memoryAllocator.allocate(memReqs, getMemoryType(memReqs.memoryTypeBits, memoryPropertyFlags), kind, vks::MemoryAllocator::Strategy::FreeList, allocation));
+		return vkBindImageMemory(logicalDevice, image, allocation->memory, allocation->offset);
+	}
+
 	/**
 	* Copy buffer data from src to dst using VkCmdCopyBuffer
 	* 
@@ -11,7 +11,9 @@
 #pragma once
 
 #include "VulkanBuffer.h"
+#include "VulkanMemoryAllocator.h"
 #include "VulkanTools.h"
+#include "VulkanUploader.h"
 #include "vulkan/vulkan.h"
 #include <algorithm>
 #include <assert.h>
@@ -37,6 +39,10 @@ struct VulkanDevice
 	std::vector<VkQueueFamilyProperties> queueFamilyProperties;
 	/** @brief List of extensions supported by the device */
 	std::vector<std::string> supportedExtensions;
+	/** @brief Sub-allocator for buffer and image memory, created with the logical device */
+	vks::MemoryAllocator memoryAllocator;
+	/** @brief Batched uploads on the transfer queue, only created if the device supports timeline semaphores */
+	vks::Uploader uploader;
 	/** @brief Default command pool for the graphics queue family index */
 	VkCommandPool commandPool = VK_NULL_HANDLE;
 	/** @brief Contains queue family indices */
@@ -57,6 +63,8 @@ struct VulkanDevice
 	VkResult        createLogicalDevice(VkPhysicalDeviceFeatures enabledFeatures, std::vector<const char *> enabledExtensions, void *pNextChain, bool useSwapChain = true, VkQueueFlags requestedQueueTypes = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
 	VkResult        createBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize size, VkBuffer *buffer, VkDeviceMemory *memory, void *data = nullptr);
 	VkResult        createBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, vks::Buffer *buffer, VkDeviceSize size, void *data = nullptr);
+	VkResult        createBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags, VkDeviceSize size, VkBuffer *buffer, vks::Allocation *allocation, void *data = nullptr, vks::MemoryAllocator::Strategy strategy = vks::MemoryAllocator::Strategy::FreeList);
+	VkResult        allocateImageMemory(VkImage image, VkMemoryPropertyFlags memoryPropertyFlags, vks::Allocation *allocation, bool linearTiling = false);
 	void            copyBuffer(vks::Buffer *src, vks::Buffer *dst, VkQueue queue, VkBufferCopy *copyRegion = nullptr);
 	VkCommandPool   createCommandPool(uint32_t queueFamilyIndex, VkCommandPoolCreateFlags createFlags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 	VkCommandBuffer createCommandBuffer(VkCommandBufferLevel level, VkCommandPool pool, bool begin = false);
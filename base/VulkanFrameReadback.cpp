@@ -0,0 +1,285 @@
+/*
+* Vulkan frame readback class
+*
+* Streams rendered frames to disk without stalling the queue
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include "VulkanFrameReadback.h"
+#include "VulkanTrace.h"
+
+#include <fstream>
+#include <iostream>
+#include <array>
+#include <algorithm>
+
+namespace vks
+{
+	namespace
+	{
+		uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+		{
+			static std::array<uint32_t, 256> table = [] {
+				std::array<uint32_t, 256> t{};
+				for (uint32_t i = 0; i < 256; i++) {
+					uint32_t c = i;
+					for (uint32_t k = 0; k < 8; k++) {
+						c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+					}
+					t[i] = c;
+				}
+				return t;
+			}();
+			crc = ~crc;
+			for (size_t i = 0; i < size; i++) {
+				crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+			}
+			return ~crc;
+		}
+
+		void appendBigEndian(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data)
+		{
+			std::vector<uint8_t> chunk;
+			appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+			chunk.insert(chunk.end(), type, type + 4);
+			chunk.insert(chunk.end(), data.begin(), data.end());
+			appendBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+			file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+		}
+
+		// Writes an 8 bit RGB PNG with uncompressed (stored) deflate blocks, which keeps encoding as cheap as copying the pixels
+		void writePNG(std::ofstream& file, const uint8_t* rgba, uint32_t width, uint32_t height, bool swizzle)
+		{
+			const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+			std::vector<uint8_t> header;
+			appendBigEndian(header, width);
+			appendBigEndian(header, height);
+			header.insert(header.end(), { 8, 2, 0, 0, 0 });	// Bit depth, color type RGB, compression, filter, interlace
+			writeChunk(file, "IHDR", header);
+
+			// Scanlines with filter type 0, alpha is dropped as the swap chain alpha is not meaningful
+			std::vector<uint8_t> scanlines;
+			scanlines.reserve(static_cast<size_t>(width * 3 + 1) * height);
+			for (uint32_t y = 0; y < height; y++) {
+				scanlines.push_back(0);
+				const uint8_t* row = rgba + static_cast<size_t>(y) * width * 4;
+				for (uint32_t x = 0; x < width; x++) {
+					const uint8_t* pixel = row + x * 4;
+					scanlines.push_back(swizzle ? pixel[2] : pixel[0]);
+					scanlines.push_back(pixel[1]);
+					scanlines.push_back(swizzle ? pixel[0] : pixel[2]);
+				}
+			}
+
+			// zlib stream made of stored blocks of at most 65535 bytes
+			std::vector<uint8_t> zlib = { 0x78, 0x01 };
+			uint32_t adlerA = 1, adlerB = 0;
+			size_t offset = 0;
+			do {
+				const size_t blockSize = std::min<size_t>(scanlines.size() - offset, 65535);
+				const bool finalBlock = (offset + blockSize == scanlines.size());
+				zlib.push_back(finalBlock ? 1 : 0);
+				zlib.push_back(static_cast<uint8_t>(blockSize));
+				zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+				zlib.push_back(static_cast<uint8_t>(~blockSize));
+				zlib.push_back(static_cast<uint8_t>(~blockSize >> 8));
+				for (size_t i = offset; i < offset + blockSize; i++) {
+					adlerA = (adlerA + scanlines[i]) % 65521;
+					adlerB = (adlerB + adlerA) % 65521;
+				}
+				zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+				offset += blockSize;
+			} while (offset < scanlines.size());
+			appendBigEndian(zlib, (adlerB << 16) | adlerA);
+			writeChunk(file, "IDAT", zlib);
+			writeChunk(file, "IEND", {});
+		}
+	}
+
+	/**
+	* Create the readback ring
+	*
+	* @param device Device the captured images belong to
+	* @param queue Queue the images are rendered on, the copies are submitted to the same queue
+	* @param slotCount Number of frames that can be in flight between capture and disk, a slot is drained once its copy has finished
+	* @param workerCount Number of threads encoding and writing frames
+	* @param prefix Frames are written to <prefix>_<frame>.raw or <prefix>_<frame>.png
+	* @param encoding Raw writes the tightly packed pixels in the image format, PNG writes 8 bit RGB
+	*/
+	void FrameReadback::create(vks::VulkanDevice* device, VkQueue queue, uint32_t slotCount, uint32_t workerCount, const std::string& prefix, Encoding encoding)
+	{
+		this->device = device;
+		this->queue = queue;
+		this->prefix = prefix;
+		this->encoding = encoding;
+
+		VkCommandPoolCreateInfo cmdPoolInfo{};
+		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolInfo.queueFamilyIndex = device->queueFamilyIndices.graphics;
+		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		VK_CHECK_RESULT(vkCreateCommandPool(device->logicalDevice, &cmdPoolInfo, nullptr, &commandPool));
+
+		slots.resize(slotCount);
+		for (auto& slot : slots) {
+			VkCommandBufferAllocateInfo cmdBufAllocateInfo = vks::initializers::commandBufferAllocateInfo(commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(device->logicalDevice, &cmdBufAllocateInfo, &slot.commandBuffer));
+			VkFenceCreateInfo fenceCreateInfo = vks::initializers::fenceCreateInfo();
+			VK_CHECK_RESULT(vkCreateFence(device->logicalDevice, &fenceCreateInfo, nullptr, &slot.fence));
+		}
+		workers.setThreadCount(std::max(workerCount, 1u));
+		for (auto& thread : workers.threads) {
+			thread->addJob([] { vks::trace::setThreadName("frame readback"); });
+		}
+	}
+
+	void FrameReadback::destroy()
+	{
+		if (!isCreated()) {
+			return;
+		}
+		flush();
+		workers.setThreadCount(0);
+		for (auto& slot : slots) {
+			slot.buffer.destroy();
+			vkDestroyFence(device->logicalDevice, slot.fence, nullptr);
+		}
+		vkDestroyCommandPool(device->logicalDevice, commandPool, nullptr);
+		slots.clear();
+	}
+
+	// Hands slots whose copy has finished to a worker, never waits for the GPU
+	void FrameReadback::collectFinishedCopies()
+	{
+		for (uint32_t i = 0; i < slots.size(); i++) {
+			if ((getState(i) == SlotState::InFlight) && (vkGetFenceStatus(device->logicalDevice, slots[i].fence) == VK_SUCCESS)) {
+				write(i);
+			}
+		}
+	}
+
+	FrameReadback::SlotState FrameReadback::getState(uint32_t slotIndex)
+	{
+		std::lock_guard<std::mutex> lock(slotMutex);
+		return slots[slotIndex].state;
+	}
+
+	void FrameReadback::write(uint32_t slotIndex)
+	{
+		{
+			std::lock_guard<std::mutex> lock(slotMutex);
+			slots[slotIndex].state = SlotState::Writing;
+		}
+		// Frames are distributed round robin, so consecutive frames are written in parallel
+		workers.threads[nextWorker]->addJob([this, slotIndex] {
+			VKS_TRACE_SCOPE("FrameReadback::writeFile");
+			writeFile(slots[slotIndex]);
+			{
+				std::lock_guard<std::mutex> lock(slotMutex);
+				slots[slotIndex].state = SlotState::Free;
+			}
+			slotFreed.notify_all();
+		});
+		nextWorker = (nextWorker + 1) % static_cast<uint32_t>(workers.threads.size());
+	}
+
+	// Runs on a worker thread, reads directly from the persistently mapped buffer
+	void FrameReadback::writeFile(const Slot& slot)
+	{
+		char filename[512];
+		snprintf(filename, sizeof(filename), "%s_%05u.%s", prefix.c_str(), slot.frame, (encoding == Encoding::PNG) ? "png" : "raw");
+		std::ofstream file(filename, std::ios::out | std::ios::binary);
+		if (!file.is_open()) {
+			std::cerr << "Could not write frame \"" << filename << "\"" << "\n";
+			return;
+		}
+		const uint8_t* data = static_cast<const uint8_t*>(slot.buffer.mapped);
+		if (encoding == Encoding::PNG) {
+			const bool swizzle = (slot.format == VK_FORMAT_B8G8R8A8_UNORM) || (slot.format == VK_FORMAT_B8G8R8A8_SRGB);
+			writePNG(file, data, slot.width, slot.height, swizzle);
+		} else {
+			file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(slot.width) * slot.height * 4);
+		}
+	}
+
+	void FrameReadback::capture(VkImage image, VkFormat format, uint32_t width, uint32_t height, VkImageLayout layout)
+	{
+		collectFinishedCopies();
+
+		const uint32_t slotIndex = nextSlot;
+		Slot& slot = slots[slotIndex];
+		// Only waits if all slots are still in use, i.e. the copies or the workers are behind by more than the ring size
+		if (getState(slotIndex) == SlotState::InFlight) {
+			VK_CHECK_RESULT(vkWaitForFences(device->logicalDevice, 1, &slot.fence, VK_TRUE, UINT64_MAX));
+			write(slotIndex);
+		}
+		{
+			std::unique_lock<std::mutex> lock(slotMutex);
+			slotFreed.wait(lock, [&slot] { return slot.state == SlotState::Free; });
+		}
+
+		// Only 32 bit formats are captured, which covers all swap chain formats used by the examples
+		const VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4;
+		if (slot.buffer.size < size) {
+			slot.buffer.destroy();
+			// Host cached memory would speed up reading on some implementations, coherent memory is available everywhere
+			VK_CHECK_RESULT(device->createBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &slot.buffer, size));
+			VK_CHECK_RESULT(slot.buffer.map());
+		}
+		slot.width = width;
+		slot.height = height;
+		slot.format = format;
+		slot.frame = capturedFrames++;
+
+		VkCommandBufferBeginInfo cmdBufInfo = vks::initializers::commandBufferBeginInfo();
+		cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK_RESULT(vkResetCommandBuffer(slot.commandBuffer, 0));
+		VK_CHECK_RESULT(vkBeginCommandBuffer(slot.commandBuffer, &cmdBufInfo));
+		// Submitted after the frame on the same queue, so the barrier orders the copy after the frame's color attachment writes
+		const VkImageSubresourceRange subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vks::tools::insertImageMemoryBarrier(slot.commandBuffer, image, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, subresourceRange);
+		VkBufferImageCopy copyRegion{};
+		copyRegion.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copyRegion.imageExtent = { width, height, 1 };
+		vkCmdCopyImageToBuffer(slot.commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer.buffer, 1, &copyRegion);
+		vks::tools::insertImageMemoryBarrier(slot.commandBuffer, image, VK_ACCESS_TRANSFER_READ_BIT, 0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, layout, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, subresourceRange);
+		// Makes the copy visible to the host once the fence has been signaled
+		VkMemoryBarrier hostBarrier = vks::initializers::memoryBarrier();
+		hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+		VK_CHECK_RESULT(vkEndCommandBuffer(slot.commandBuffer));
+
+		VK_CHECK_RESULT(vkResetFences(device->logicalDevice, 1, &slot.fence));
+		VkSubmitInfo submitInfo = vks::initializers::submitInfo();
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &slot.commandBuffer;
+		VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, slot.fence));
+		{
+			std::lock_guard<std::mutex> lock(slotMutex);
+			slot.state = SlotState::InFlight;
+		}
+		nextSlot = (nextSlot + 1) % static_cast<uint32_t>(slots.size());
+	}
+
+	void FrameReadback::flush()
+	{
+		for (uint32_t i = 0; i < slots.size(); i++) {
+			if (getState(i) == SlotState::InFlight) {
+				VK_CHECK_RESULT(vkWaitForFences(device->logicalDevice, 1, &slots[i].fence, VK_TRUE, UINT64_MAX));
+				write(i);
+			}
+		}
+		workers.wait();
+	}
+}
@@ -0,0 +1,75 @@
+/*
+* Vulkan frame readback class
+*
+* Streams rendered frames to disk without stalling the queue
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+
+#include "vulkan/vulkan.h"
+#include "VulkanDevice.h"
+#include "VulkanBuffer.h"
+#include "threadpool.hpp"
+
+namespace vks
+{
+	/**
+	* @brief Copies frames into a ring of host visible buffers and writes them on worker threads
+	* @note A slot is only reused after its copy has finished and its file has been written, i.e. capture() only blocks if the GPU or the disk can't keep up
+	*/
+	class FrameReadback
+	{
+	public:
+		enum class Encoding { Raw, PNG };
+
+		void create(vks::VulkanDevice* device, VkQueue queue, uint32_t slotCount, uint32_t workerCount, const std::string& prefix, Encoding encoding);
+		/** @brief Writes all pending frames and frees all resources */
+		void destroy();
+		bool isCreated() const { return !slots.empty(); }
+		/**
+		* @brief Submits a copy of the image to the next slot, call after the submission that rendered the image
+		* @note The image has to be in the given layout and is returned to it, it needs to have been created with transfer source usage
+		*/
+		void capture(VkImage image, VkFormat format, uint32_t width, uint32_t height, VkImageLayout layout);
+		/** @brief Waits until all captured frames have been written */
+		void flush();
+		uint32_t getCapturedFrames() const { return capturedFrames; }
+	private:
+		enum class SlotState { Free, InFlight, Writing };
+		struct Slot {
+			vks::Buffer buffer;
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			VkFence fence = VK_NULL_HANDLE;
+			SlotState state = SlotState::Free;
+			uint32_t frame = 0;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			VkFormat format = VK_FORMAT_UNDEFINED;
+		};
+		vks::VulkanDevice* device = nullptr;
+		VkQueue queue = VK_NULL_HANDLE;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		std::vector<Slot> slots;
+		uint32_t nextSlot = 0;
+		uint32_t capturedFrames = 0;
+		std::string prefix;
+		Encoding encoding = Encoding::PNG;
+		vks::ThreadPool workers;
+		uint32_t nextWorker = 0;
+		// Guards the slot states shared with the workers
+		std::mutex slotMutex;
+		std::condition_variable slotFreed;
+
+		SlotState getState(uint32_t slotIndex);
+		void collectFinishedCopies();
+		void write(uint32_t slotIndex);
+		void writeFile(const Slot& slot);
+	};
+}
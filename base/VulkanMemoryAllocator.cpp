@@ -0,0 +1,360 @@
+/*
+* Vulkan device memory allocator
+*
+* Sub-allocates buffers and images from large device memory blocks, pooled per memory type
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include "VulkanMemoryAllocator.h"
+#include "VulkanTools.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+
+namespace vks
+{
+	namespace
+	{
+		VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		VkDeviceSize alignDown(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return value / alignment * alignment;
+		}
+	}
+
+	void MemoryAllocator::create(VkDevice device, const VkPhysicalDeviceLimits& limits, const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize preferredBlockSize)
+	{
+		this->device = device;
+		this->memoryProperties = memoryProperties;
+		this->nonCoherentAtomSize = std::max<VkDeviceSize>(limits.nonCoherentAtomSize, 1);
+		this->preferredBlockSize = preferredBlockSize;
+	}
+
+	void MemoryAllocator::destroy()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& pool : pools) {
+			for (auto& block : pool.second.blocks) {
+				vkFreeMemory(device, block->memory, nullptr);
+			}
+		}
+		for (auto& dedicated : dedicatedAllocations) {
+			vkFreeMemory(device, dedicated.first, nullptr);
+		}
+		pools.clear();
+		dedicatedAllocations.clear();
+		deviceMemoryCount = 0;
+		device = VK_NULL_HANDLE;
+	}
+
+	bool MemoryAllocator::isHostVisible(uint32_t memoryTypeIndex) const
+	{
+		return (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+	}
+
+	bool MemoryAllocator::isNonCoherent(uint32_t memoryTypeIndex) const
+	{
+		return isHostVisible(memoryTypeIndex) && ((memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0);
+	}
+
+	bool MemoryAllocator::isLazilyAllocated(uint32_t memoryTypeIndex) const
+	{
+		return (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+	}
+
+	// Small heaps (e.g. the 256 MB host visible device local heap on some GPUs) get smaller blocks so a few blocks don't exhaust them
+	VkDeviceSize MemoryAllocator::getBlockSize(uint32_t memoryTypeIndex) const
+	{
+		const VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+		return std::max<VkDeviceSize>(std::min(preferredBlockSize, heapSize / 8), 1024 * 1024);
+	}
+
+	VkResult MemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, const void* pNext, VkDeviceMemory* memory, void** mapped)
+	{
+		VkMemoryAllocateInfo memAlloc{};
+		memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memAlloc.pNext = pNext;
+		memAlloc.allocationSize = size;
+		memAlloc.memoryTypeIndex = memoryTypeIndex;
+		VkResult result = vkAllocateMemory(device, &memAlloc, nullptr, memory);
+		if (result != VK_SUCCESS) {
+			return result;
+		}
+		*mapped = nullptr;
+		if (isHostVisible(memoryTypeIndex)) {
+			result = vkMapMemory(device, *memory, 0, VK_WHOLE_SIZE, 0, mapped);
+			if (result != VK_SUCCESS) {
+				vkFreeMemory(device, *memory, nullptr);
+				return result;
+			}
+		}
+		deviceMemoryCount++;
+		peakDeviceMemoryCount = std::max(peakDeviceMemoryCount, deviceMemoryCount);
+		return VK_SUCCESS;
+	}
+
+	void MemoryAllocator::freeDeviceMemory(VkDeviceMemory memory)
+	{
+		// Freeing implicitly unmaps
+		vkFreeMemory(device, memory, nullptr);
+		deviceMemoryCount--;
+	}
+
+	bool MemoryAllocator::allocateFromBlock(MemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, Allocation* allocation)
+	{
+		VkDeviceSize regionOffset = 0;
+		VkDeviceSize offset = 0;
+		if (block.linear) {
+			offset = alignUp(block.head, alignment);
+			if (offset + size > block.size) {
+				return false;
+			}
+			regionOffset = block.head;
+			block.head = offset + size;
+		} else {
+			auto range = block.freeRanges.begin();
+			while ((range != block.freeRanges.end()) && (alignUp(range->first, alignment) + size > range->first + range->second)) {
+				range++;
+			}
+			if (range == block.freeRanges.end()) {
+				return false;
+			}
+			regionOffset = range->first;
+			offset = alignUp(range->first, alignment);
+			const VkDeviceSize rangeEnd = range->first + range->second;
+			block.freeRanges.erase(range);
+			if (rangeEnd > offset + size) {
+				block.freeRanges[offset + size] = rangeEnd - (offset + size);
+			}
+		}
+		allocation->memory = block.memory;
+		allocation->offset = offset;
+		allocation->regionOffset = regionOffset;
+		allocation->regionSize = offset + size - regionOffset;
+		allocation->block = &block;
+		allocation->mapped = block.mapped ? static_cast<uint8_t*>(block.mapped) + offset : nullptr;
+		block.allocationCount++;
+		block.usedBytes += allocation->regionSize;
+		block.paddingBytes += offset - regionOffset;
+		return true;
+	}
+
+	VkResult MemoryAllocator::allocate(const VkMemoryRequirements& memoryRequirements, uint32_t memoryTypeIndex, ResourceKind kind, Strategy strategy, Allocation* allocation, const void* pNext)
+	{
+		assert(isCreated());
+		std::lock_guard<std::mutex> lock(mutex);
+		*allocation = Allocation();
+		allocation->memoryTypeIndex = memoryTypeIndex;
+		allocation->size = memoryRequirements.size;
+
+		// Non-coherent allocations never share an atom, so flushing or invalidating one never touches a neighbour
+		VkDeviceSize alignment = std::max<VkDeviceSize>(memoryRequirements.alignment, 1);
+		VkDeviceSize size = memoryRequirements.size;
+		if (isNonCoherent(memoryTypeIndex)) {
+			alignment = alignUp(alignment, nonCoherentAtomSize);
+			size = alignUp(size, nonCoherentAtomSize);
+		}
+
+		const VkDeviceSize blockSize = getBlockSize(memoryTypeIndex);
+		// Large resources would mostly waste block space, so they get their own memory like before
+		// Lazily allocated memory is committed per memory object, so transient attachments don't share blocks either
+		if ((pNext != nullptr) || (size > blockSize / 2) || isLazilyAllocated(memoryTypeIndex)) {
+			VkResult result = allocateDeviceMemory(memoryRequirements.size, memoryTypeIndex, pNext, &allocation->memory, &allocation->mapped);
+			if (result == VK_SUCCESS) {
+				allocation->regionSize = memoryRequirements.size;
+				dedicatedAllocations[allocation->memory] = memoryRequirements.size;
+			}
+			return result;
+		}
+
+		const uint32_t key = (memoryTypeIndex << 2) | (static_cast<uint32_t>(kind) << 1) | static_cast<uint32_t>(strategy);
+		auto poolIt = pools.find(key);
+		if (poolIt == pools.end()) {
+			Pool newPool;
+			newPool.memoryTypeIndex = memoryTypeIndex;
+			newPool.kind = kind;
+			newPool.strategy = strategy;
+			newPool.blockSize = blockSize;
+			poolIt = pools.emplace(key, std::move(newPool)).first;
+		}
+		Pool& pool = poolIt->second;
+		for (auto& block : pool.blocks) {
+			if (allocateFromBlock(*block, size, alignment, allocation)) {
+				return VK_SUCCESS;
+			}
+		}
+
+		std::unique_ptr<MemoryBlock> block(new MemoryBlock());
+		VkResult result = allocateDeviceMemory(pool.blockSize, memoryTypeIndex, nullptr, &block->memory, &block->mapped);
+		if (result != VK_SUCCESS) {
+			return result;
+		}
+		block->size = pool.blockSize;
+		block->poolKey = key;
+		block->linear = (strategy == Strategy::Linear);
+		if (!block->linear) {
+			block->freeRanges[0] = block->size;
+		}
+		pool.blocks.push_back(std::move(block));
+		const bool allocated = allocateFromBlock(*pool.blocks.back(), size, alignment, allocation);
+		assert(allocated);
+		return allocated ? VK_SUCCESS : VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	void MemoryAllocator::free(Allocation& allocation)
+	{
+		if (allocation.memory == VK_NULL_HANDLE) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!allocation.block) {
+			dedicatedAllocations.erase(allocation.memory);
+			freeDeviceMemory(allocation.memory);
+			allocation = Allocation();
+			return;
+		}
+
+		MemoryBlock& block = *allocation.block;
+		block.allocationCount--;
+		block.usedBytes -= allocation.regionSize;
+		block.paddingBytes -= allocation.offset - allocation.regionOffset;
+		if (block.linear) {
+			if (block.allocationCount == 0) {
+				block.head = 0;
+			}
+		} else {
+			// Merge with the free ranges directly before and after
+			VkDeviceSize offset = allocation.regionOffset;
+			VkDeviceSize size = allocation.regionSize;
+			auto next = block.freeRanges.lower_bound(offset);
+			if (next != block.freeRanges.begin()) {
+				auto previous = std::prev(next);
+				if (previous->first + previous->second == offset) {
+					offset = previous->first;
+					size += previous->second;
+					block.freeRanges.erase(previous);
+				}
+			}
+			if ((next != block.freeRanges.end()) && (next->first == offset + size)) {
+				size += next->second;
+				block.freeRanges.erase(next);
+			}
+			block.freeRanges[offset] = size;
+		}
+
+		// Keep one empty block per pool around, so allocating and freeing in a loop doesn't hit the driver every time
+		if (block.allocationCount == 0) {
+			auto& blocks = pools[block.poolKey].blocks;
+			const bool otherEmptyBlock = std::any_of(blocks.begin(), blocks.end(), [&block](const std::unique_ptr<MemoryBlock>& b) { return (b.get() != &block) && (b->allocationCount == 0); });
+			if (otherEmptyBlock) {
+				freeDeviceMemory(block.memory);
+				blocks.erase(std::find_if(blocks.begin(), blocks.end(), [&block](const std::unique_ptr<MemoryBlock>& b) { return b.get() == &block; }));
+			}
+		}
+		allocation = Allocation();
+	}
+
+	VkMappedMemoryRange MemoryAllocator::getMappedRange(const Allocation& allocation, VkDeviceSize size, VkDeviceSize offset) const
+	{
+		VkMappedMemoryRange mappedRange{};
+		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		mappedRange.memory = allocation.memory;
+		if (!allocation.block) {
+			mappedRange.offset = offset;
+			mappedRange.size = size;
+			return mappedRange;
+		}
+		// Both ends have to be aligned to nonCoherentAtomSize unless the range reaches the end of the block
+		const VkDeviceSize begin = alignDown(allocation.offset + offset, nonCoherentAtomSize);
+		const VkDeviceSize end = alignUp((size == VK_WHOLE_SIZE) ? allocation.regionOffset + allocation.regionSize : allocation.offset + offset + size, nonCoherentAtomSize);
+		mappedRange.offset = begin;
+		mappedRange.size = std::min(end, allocation.block->size) - begin;
+		return mappedRange;
+	}
+
+	VkResult MemoryAllocator::flush(const Allocation& allocation, VkDeviceSize size, VkDeviceSize offset)
+	{
+		VkMappedMemoryRange mappedRange = getMappedRange(allocation, size, offset);
+		return vkFlushMappedMemoryRanges(device, 1, &mappedRange);
+	}
+
+	VkResult MemoryAllocator::invalidate(const Allocation& allocation, VkDeviceSize size, VkDeviceSize offset)
+	{
+		VkMappedMemoryRange mappedRange = getMappedRange(allocation, size, offset);
+		return vkInvalidateMappedMemoryRanges(device, 1, &mappedRange);
+	}
+
+	MemoryAllocator::Statistics MemoryAllocator::getStatistics()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Statistics stats;
+		for (const auto& pool : pools) {
+			for (const auto& block : pool.second.blocks) {
+				stats.blockCount++;
+				stats.allocationCount += block->allocationCount;
+				stats.allocatedBytes += block->size;
+				stats.usedBytes += block->usedBytes - block->paddingBytes;
+				stats.paddingBytes += block->paddingBytes;
+				if (block->linear) {
+					// Space freed in the middle of a linear block is only reclaimed once the block is empty
+					const VkDeviceSize tail = block->size - block->head;
+					stats.freeBytes += tail;
+					stats.largestFreeRange = std::max(stats.largestFreeRange, tail);
+					stats.freeRangeCount += (tail > 0) ? 1 : 0;
+				} else {
+					for (const auto& range : block->freeRanges) {
+						stats.freeBytes += range.second;
+						stats.largestFreeRange = std::max(stats.largestFreeRange, range.second);
+						stats.freeRangeCount++;
+					}
+				}
+			}
+		}
+		for (const auto& dedicated : dedicatedAllocations) {
+			stats.allocationCount++;
+			stats.dedicatedAllocationCount++;
+			stats.allocatedBytes += dedicated.second;
+			stats.usedBytes += dedicated.second;
+		}
+		stats.deviceMemoryCount = deviceMemoryCount;
+		stats.peakDeviceMemoryCount = peakDeviceMemoryCount;
+		return stats;
+	}
+
+	void MemoryAllocator::printStatistics(std::ostream& stream)
+	{
+		const Statistics stats = getStatistics();
+		const double MiB = 1024.0 * 1024.0;
+		// The stream's formatting is restored afterwards, callers usually pass std::cout
+		const std::ios_base::fmtflags flags = stream.flags();
+		const std::streamsize precision = stream.precision();
+		stream << std::fixed << std::setprecision(2);
+		stream << "Device memory: " << stats.allocationCount << " allocations in " << stats.deviceMemoryCount << " device memory objects (peak " << stats.peakDeviceMemoryCount << ", " << stats.dedicatedAllocationCount << " dedicated), "
+			<< stats.usedBytes / MiB << " of " << stats.allocatedBytes / MiB << " MiB used, " << stats.paddingBytes / 1024.0 << " KiB alignment padding, "
+			<< stats.freeRangeCount << " free ranges (" << stats.fragmentation() * 100.0f << "% fragmented)" << "\n";
+		std::lock_guard<std::mutex> lock(mutex);
+		for (const auto& pool : pools) {
+			uint32_t allocationCount = 0;
+			VkDeviceSize usedBytes = 0;
+			VkDeviceSize paddingBytes = 0;
+			for (const auto& block : pool.second.blocks) {
+				allocationCount += block->allocationCount;
+				usedBytes += block->usedBytes - block->paddingBytes;
+				paddingBytes += block->paddingBytes;
+			}
+			stream << "  memory type " << pool.second.memoryTypeIndex
+				<< ((pool.second.kind == ResourceKind::Buffer) ? " buffers" : " images")
+				<< ((pool.second.strategy == Strategy::Linear) ? " (linear)" : " (free list)") << ": "
+				<< allocationCount << " allocations in " << pool.second.blocks.size() << " x " << pool.second.blockSize / MiB << " MiB blocks, "
+				<< usedBytes / MiB << " MiB used, " << paddingBytes / 1024.0 << " KiB padding" << "\n";
+		}
+		stream.flags(flags);
+		stream.precision(precision);
+	}
+}
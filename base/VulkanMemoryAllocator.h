@@ -0,0 +1,145 @@
+/*
+* Vulkan device memory allocator
+*
+* Sub-allocates buffers and images from large device memory blocks, pooled per memory type
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+#include "vulkan/vulkan.h"
+
+namespace vks
+{
+	/** @brief One VkDeviceMemory object of a MemoryAllocator pool */
+	struct MemoryBlock
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize size = 0;
+		void* mapped = nullptr;
+		/** @brief Key of the pool owning this block */
+		uint32_t poolKey = 0;
+		bool linear = false;
+		/** @brief Free ranges by offset (free list strategy) */
+		std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+		/** @brief Start of the unused tail of the block (linear strategy) */
+		VkDeviceSize head = 0;
+		uint32_t allocationCount = 0;
+		VkDeviceSize usedBytes = 0;
+		VkDeviceSize paddingBytes = 0;
+	};
+
+	/** @brief A range of device memory handed out by the MemoryAllocator, memory and offset are what resources are bound to */
+	struct Allocation
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		/** @brief Host pointer to offset, blocks of host visible memory types stay mapped for their whole lifetime */
+		void* mapped = nullptr;
+		uint32_t memoryTypeIndex = 0;
+		/** @brief Block this allocation was taken from, null for dedicated allocations */
+		MemoryBlock* block = nullptr;
+		/** @brief Range reserved in the block including alignment padding */
+		VkDeviceSize regionOffset = 0;
+		VkDeviceSize regionSize = 0;
+	};
+
+	/**
+	* @brief Block based device memory sub-allocator
+	* @note Blocks are pooled per memory type, per resource kind (buffers and linear images vs. optimal images, so bufferImageGranularity never applies) and per strategy
+	* @note Allocating and freeing is thread safe
+	*/
+	class MemoryAllocator
+	{
+	public:
+		enum class Strategy {
+			/** @brief First fit from a sorted free list, freed ranges are merged with their neighbours */
+			FreeList,
+			/** @brief Bump allocation, a block is reset once all of its allocations have been freed, e.g. for staging buffers */
+			Linear
+		};
+		enum class ResourceKind {
+			Buffer,
+			OptimalImage
+		};
+		struct Statistics {
+			/** @brief Live resource allocations */
+			uint32_t allocationCount = 0;
+			/** @brief Live VkDeviceMemory objects (blocks and dedicated allocations) */
+			uint32_t deviceMemoryCount = 0;
+			uint32_t peakDeviceMemoryCount = 0;
+			uint32_t dedicatedAllocationCount = 0;
+			uint32_t blockCount = 0;
+			/** @brief Bytes allocated from the driver */
+			VkDeviceSize allocatedBytes = 0;
+			/** @brief Bytes requested by resources */
+			VkDeviceSize usedBytes = 0;
+			/** @brief Bytes lost to alignment inside blocks */
+			VkDeviceSize paddingBytes = 0;
+			/** @brief Unused bytes inside blocks */
+			VkDeviceSize freeBytes = 0;
+			VkDeviceSize largestFreeRange = 0;
+			uint32_t freeRangeCount = 0;
+			/** @brief Share of free block memory that is not part of the largest free range, 0 = not fragmented */
+			float fragmentation() const { return (freeBytes > 0) ? 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes) : 0.0f; }
+		};
+
+		void create(VkDevice device, const VkPhysicalDeviceLimits& limits, const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize preferredBlockSize = 64 * 1024 * 1024);
+		/** @brief Frees all blocks and dedicated allocations, resources still bound to them have to be destroyed before */
+		void destroy();
+		bool isCreated() const { return device != VK_NULL_HANDLE; }
+		/**
+		* Allocate memory for a resource
+		*
+		* @param memoryRequirements Requirements of the resource as returned by vkGet*MemoryRequirements
+		* @param memoryTypeIndex Memory type to allocate from, e.g. from VulkanDevice::getMemoryType
+		* @param kind Buffers (and linear images) and optimal images are never placed in the same block
+		* @param strategy Strategy of the pool to allocate from
+		* @param pNext Allocations with extension structures (e.g. device address flags) always get dedicated memory
+		* @note Lazily allocated memory types always get dedicated memory
+		*/
+		VkResult allocate(const VkMemoryRequirements& memoryRequirements, uint32_t memoryTypeIndex, ResourceKind kind, Strategy strategy, Allocation* allocation, const void* pNext = nullptr);
+		void free(Allocation& allocation);
+		/** @brief Flush a range of a host visible allocation, aligned to nonCoherentAtomSize */
+		VkResult flush(const Allocation& allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+		VkResult invalidate(const Allocation& allocation, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+		Statistics getStatistics();
+		/** @brief Prints the statistics of all pools, one line per pool */
+		void printStatistics(std::ostream& stream);
+	private:
+		struct Pool {
+			uint32_t memoryTypeIndex;
+			ResourceKind kind;
+			Strategy strategy;
+			VkDeviceSize blockSize;
+			std::vector<std::unique_ptr<MemoryBlock>> blocks;
+		};
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDeviceMemoryProperties memoryProperties{};
+		VkDeviceSize nonCoherentAtomSize = 1;
+		VkDeviceSize preferredBlockSize = 0;
+		std::mutex mutex;
+		std::map<uint32_t, Pool> pools;
+		// Dedicated allocations by memory handle, so they can be released in destroy()
+		std::map<VkDeviceMemory, VkDeviceSize> dedicatedAllocations;
+		uint32_t deviceMemoryCount = 0;
+		uint32_t peakDeviceMemoryCount = 0;
+
+		bool isHostVisible(uint32_t memoryTypeIndex) const;
+		bool isNonCoherent(uint32_t memoryTypeIndex) const;
+		bool isLazilyAllocated(uint32_t memoryTypeIndex) const;
+		VkDeviceSize getBlockSize(uint32_t memoryTypeIndex) const;
+		VkResult allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, const void* pNext, VkDeviceMemory* memory, void** mapped);
+		void freeDeviceMemory(VkDeviceMemory memory);
+		static bool allocateFromBlock(MemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, Allocation* allocation);
+		VkMappedMemoryRange getMappedRange(const Allocation& allocation, VkDeviceSize size, VkDeviceSize offset) const;
+	};
+}
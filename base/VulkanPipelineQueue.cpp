@@ -0,0 +1,182 @@
+/*
+* Vulkan pipeline queue class
+*
+* Collects pipeline create infos and creates the pipelines concurrently on a thread pool
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include "VulkanPipelineQueue.h"
+#include "VulkanTrace.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace vks
+{
+	namespace
+	{
+		template<typename T>
+		std::vector<T> copyArray(const T* data, uint32_t count)
+		{
+			return (data && count > 0) ? std::vector<T>(data, data + count) : std::vector<T>();
+		}
+
+		template<typename T>
+		const T* dataOrNull(const std::vector<T>& v)
+		{
+			return v.empty() ? nullptr : v.data();
+		}
+	}
+
+	void PipelineQueue::create(VkDevice device, VkPipelineCache pipelineCache, uint32_t threadCount)
+	{
+		this->device = device;
+		this->pipelineCache = pipelineCache;
+		workers.setThreadCount(std::max(threadCount, 1u));
+		for (auto& thread : workers.threads) {
+			thread->addJob([] { vks::trace::setThreadName("pipeline queue"); });
+		}
+	}
+
+	void PipelineQueue::destroy()
+	{
+		graphicsRequests.clear();
+		computeRequests.clear();
+		workers.threads.clear();
+		device = VK_NULL_HANDLE;
+	}
+
+	void PipelineQueue::copyShaderStage(const VkPipelineShaderStageCreateInfo& source, ShaderStage& stage)
+	{
+		stage.createInfo = source;
+		if (source.pSpecializationInfo) {
+			const VkSpecializationInfo& info = *source.pSpecializationInfo;
+			stage.mapEntries = copyArray(info.pMapEntries, info.mapEntryCount);
+			const uint8_t* data = static_cast<const uint8_t*>(info.pData);
+			stage.specializationData = copyArray(data, static_cast<uint32_t>(info.dataSize));
+			stage.specializationInfo = info;
+			stage.specializationInfo.pMapEntries = dataOrNull(stage.mapEntries);
+			stage.specializationInfo.pData = dataOrNull(stage.specializationData);
+			stage.createInfo.pSpecializationInfo = &stage.specializationInfo;
+		}
+	}
+
+	void PipelineQueue::add(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline* pipeline)
+	{
+		std::unique_ptr<GraphicsRequest> request(new GraphicsRequest());
+		GraphicsRequest& r = *request;
+		r.createInfo = createInfo;
+		r.target = pipeline;
+
+		r.stages.resize(createInfo.stageCount);
+		for (uint32_t i = 0; i < createInfo.stageCount; i++) {
+			copyShaderStage(createInfo.pStages[i], r.stages[i]);
+			r.stageCreateInfos.push_back(r.stages[i].createInfo);
+		}
+		r.createInfo.pStages = dataOrNull(r.stageCreateInfos);
+
+		if (createInfo.pVertexInputState) {
+			r.vertexInputState = *createInfo.pVertexInputState;
+			r.vertexBindings = copyArray(r.vertexInputState.pVertexBindingDescriptions, r.vertexInputState.vertexBindingDescriptionCount);
+			r.vertexAttributes = copyArray(r.vertexInputState.pVertexAttributeDescriptions, r.vertexInputState.vertexAttributeDescriptionCount);
+			r.vertexInputState.pVertexBindingDescriptions = dataOrNull(r.vertexBindings);
+			r.vertexInputState.pVertexAttributeDescriptions = dataOrNull(r.vertexAttributes);
+			r.createInfo.pVertexInputState = &r.vertexInputState;
+		}
+		if (createInfo.pInputAssemblyState) {
+			r.inputAssemblyState = *createInfo.pInputAssemblyState;
+			r.createInfo.pInputAssemblyState = &r.inputAssemblyState;
+		}
+		if (createInfo.pTessellationState) {
+			r.tessellationState = *createInfo.pTessellationState;
+			r.createInfo.pTessellationState = &r.tessellationState;
+		}
+		if (createInfo.pViewportState) {
+			r.viewportState = *createInfo.pViewportState;
+			r.viewports = copyArray(r.viewportState.pViewports, r.viewportState.viewportCount);
+			r.scissors = copyArray(r.viewportState.pScissors, r.viewportState.scissorCount);
+			r.viewportState.pViewports = dataOrNull(r.viewports);
+			r.viewportState.pScissors = dataOrNull(r.scissors);
+			r.createInfo.pViewportState = &r.viewportState;
+		}
+		if (createInfo.pRasterizationState) {
+			r.rasterizationState = *createInfo.pRasterizationState;
+			r.createInfo.pRasterizationState = &r.rasterizationState;
+		}
+		if (createInfo.pMultisampleState) {
+			r.multisampleState = *createInfo.pMultisampleState;
+			// One mask word per 32 samples
+			const uint32_t maskWords = (static_cast<uint32_t>(r.multisampleState.rasterizationSamples) + 31) / 32;
+			r.sampleMask = copyArray(r.multisampleState.pSampleMask, maskWords);
+			r.multisampleState.pSampleMask = dataOrNull(r.sampleMask);
+			r.createInfo.pMultisampleState = &r.multisampleState;
+		}
+		if (createInfo.pDepthStencilState) {
+			r.depthStencilState = *createInfo.pDepthStencilState;
+			r.createInfo.pDepthStencilState = &r.depthStencilState;
+		}
+		if (createInfo.pColorBlendState) {
+			r.colorBlendState = *createInfo.pColorBlendState;
+			r.blendAttachments = copyArray(r.colorBlendState.pAttachments, r.colorBlendState.attachmentCount);
+			r.colorBlendState.pAttachments = dataOrNull(r.blendAttachments);
+			r.createInfo.pColorBlendState = &r.colorBlendState;
+		}
+		if (createInfo.pDynamicState) {
+			r.dynamicState = *createInfo.pDynamicState;
+			r.dynamicStates = copyArray(r.dynamicState.pDynamicStates, r.dynamicState.dynamicStateCount);
+			r.dynamicState.pDynamicStates = dataOrNull(r.dynamicStates);
+			r.createInfo.pDynamicState = &r.dynamicState;
+		}
+
+		graphicsRequests.push_back(std::move(request));
+	}
+
+	void PipelineQueue::add(const VkComputePipelineCreateInfo& createInfo, VkPipeline* pipeline)
+	{
+		std::unique_ptr<ComputeRequest> request(new ComputeRequest());
+		request->createInfo = createInfo;
+		request->target = pipeline;
+		copyShaderStage(createInfo.stage, request->stage);
+		request->createInfo.stage = request->stage.createInfo;
+		computeRequests.push_back(std::move(request));
+	}
+
+	void PipelineQueue::build()
+	{
+		assert(isCreated());
+		VKS_TRACE_SCOPE("PipelineQueue::build");
+		const auto buildStart = std::chrono::high_resolution_clock::now();
+		const size_t threadCount = workers.threads.size();
+		size_t jobIndex = 0;
+		// The pipeline cache is internally synchronized, so all workers can create pipelines against it at the same time
+		for (auto& request : graphicsRequests) {
+			GraphicsRequest* r = request.get();
+			workers.threads[jobIndex++ % threadCount]->addJob([this, r] {
+				VKS_TRACE_SCOPE("vkCreateGraphicsPipelines");
+				r->result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &r->createInfo, nullptr, &r->pipeline);
+			});
+		}
+		for (auto& request : computeRequests) {
+			ComputeRequest* r = request.get();
+			workers.threads[jobIndex++ % threadCount]->addJob([this, r] {
+				VKS_TRACE_SCOPE("vkCreateComputePipelines");
+				r->result = vkCreateComputePipelines(device, pipelineCache, 1, &r->createInfo, nullptr, &r->pipeline);
+			});
+		}
+		workers.wait();
+
+		// Results are checked and handed out on the calling thread only
+		for (auto& request : graphicsRequests) {
+			VK_CHECK_RESULT(request->result);
+			*request->target = request->pipeline;
+		}
+		for (auto& request : computeRequests) {
+			VK_CHECK_RESULT(request->result);
+			*request->target = request->pipeline;
+		}
+		graphicsRequests.clear();
+		computeRequests.clear();
+		buildTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+	}
+}
@@ -0,0 +1,88 @@
+/*
+* Vulkan pipeline queue class
+*
+* Collects pipeline create infos and creates the pipelines concurrently on a thread pool
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "vulkan/vulkan.h"
+#include "VulkanTools.h"
+#include "threadpool.hpp"
+
+namespace vks
+{
+	/**
+	* @brief Creates queued pipelines in parallel against a shared pipeline cache
+	* @note add() copies the create info including all state, shader stages and specialization data it points to, so the caller may change or release them right away
+	* @note pNext chains, the layout, render pass and shader modules are not copied and have to stay valid until build() returns
+	*/
+	class PipelineQueue
+	{
+	public:
+		void create(VkDevice device, VkPipelineCache pipelineCache, uint32_t threadCount);
+		void destroy();
+		bool isCreated() const { return device != VK_NULL_HANDLE; }
+		/** @brief Queues a graphics pipeline, the handle is written to pipeline once build() returns */
+		void add(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline* pipeline);
+		/** @brief Queues a compute pipeline, the handle is written to pipeline once build() returns */
+		void add(const VkComputePipelineCreateInfo& createInfo, VkPipeline* pipeline);
+		/** @brief Creates all queued pipelines on the worker threads and waits for them (join point) */
+		void build();
+		size_t size() const { return graphicsRequests.size() + computeRequests.size(); }
+		/** @brief Wall clock time of all build() calls so far in milliseconds */
+		double getBuildTime() const { return buildTime; }
+	private:
+		struct ShaderStage {
+			VkPipelineShaderStageCreateInfo createInfo;
+			VkSpecializationInfo specializationInfo;
+			std::vector<VkSpecializationMapEntry> mapEntries;
+			std::vector<uint8_t> specializationData;
+		};
+		struct GraphicsRequest {
+			VkGraphicsPipelineCreateInfo createInfo;
+			std::vector<ShaderStage> stages;
+			std::vector<VkPipelineShaderStageCreateInfo> stageCreateInfos;
+			VkPipelineVertexInputStateCreateInfo vertexInputState;
+			std::vector<VkVertexInputBindingDescription> vertexBindings;
+			std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+			VkPipelineInputAssemblyStateCreateInfo inputAssemblyState;
+			VkPipelineTessellationStateCreateInfo tessellationState;
+			VkPipelineViewportStateCreateInfo viewportState;
+			std::vector<VkViewport> viewports;
+			std::vector<VkRect2D> scissors;
+			VkPipelineRasterizationStateCreateInfo rasterizationState;
+			VkPipelineMultisampleStateCreateInfo multisampleState;
+			std::vector<VkSampleMask> sampleMask;
+			VkPipelineDepthStencilStateCreateInfo depthStencilState;
+			VkPipelineColorBlendStateCreateInfo colorBlendState;
+			std::vector<VkPipelineColorBlendAttachmentState> blendAttachments;
+			VkPipelineDynamicStateCreateInfo dynamicState;
+			std::vector<VkDynamicState> dynamicStates;
+			VkPipeline* target;
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			VkResult result = VK_SUCCESS;
+		};
+		struct ComputeRequest {
+			VkComputePipelineCreateInfo createInfo;
+			ShaderStage stage;
+			VkPipeline* target;
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			VkResult result = VK_SUCCESS;
+		};
+		VkDevice device = VK_NULL_HANDLE;
+		VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+		vks::ThreadPool workers;
+		double buildTime = 0.0;
+		// Requests are kept behind pointers so the copied create infos can point into them
+		std::vector<std::unique_ptr<GraphicsRequest>> graphicsRequests;
+		std::vector<std::unique_ptr<ComputeRequest>> computeRequests;
+
+		static void copyShaderStage(const VkPipelineShaderStageCreateInfo& source, ShaderStage& stage);
+	};
+}
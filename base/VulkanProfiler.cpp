@@ -0,0 +1,129 @@
+/*
+* Vulkan GPU profiler class
+*
+* Measures the GPU time of command buffer scopes with timestamp queries
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include "VulkanProfiler.h"
+
+namespace vks
+{
+	GpuProfiler::Scope::Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const std::string& name) : profiler(profiler), commandBuffer(commandBuffer)
+	{
+		scope = profiler.beginScope(commandBuffer, name);
+	}
+
+	GpuProfiler::Scope::~Scope()
+	{
+		profiler.endScope(commandBuffer, scope);
+	}
+
+	/**
+	* Create the query pools
+	*
+	* @param device Device to create the query pools on, timestamps must be supported by its graphics queue
+	* @param frameCount Number of frames in flight
+	* @param maxScopes (Optional) Maximum number of scopes per frame, additional scopes are ignored
+	*/
+	void GpuProfiler::create(vks::VulkanDevice* device, uint32_t frameCount, uint32_t maxScopes)
+	{
+		this->device = device->logicalDevice;
+		this->maxScopes = maxScopes;
+		const uint32_t validBits = device->queueFamilyProperties[device->queueFamilyIndices.graphics].timestampValidBits;
+		supported = (validBits > 0) && (device->properties.limits.timestampPeriod > 0.0f);
+		timestampMask = (validBits >= 64) ? ~0ULL : ((1ULL << validBits) - 1);
+		timestampPeriod = device->properties.limits.timestampPeriod;
+		frames.resize(frameCount);
+		if (!supported) {
+			return;
+		}
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = maxScopes * 2;
+		queryData.resize(queryPoolInfo.queryCount * 2);
+		for (auto& frame : frames) {
+			VK_CHECK_RESULT(vkCreateQueryPool(this->device, &queryPoolInfo, nullptr, &frame.queryPool));
+		}
+	}
+
+	void GpuProfiler::destroy()
+	{
+		for (auto& frame : frames) {
+			if (frame.queryPool != VK_NULL_HANDLE) {
+				vkDestroyQueryPool(device, frame.queryPool, nullptr);
+			}
+		}
+		frames.clear();
+		results.clear();
+	}
+
+	void GpuProfiler::beginFrame(uint32_t frameIndex)
+	{
+		currentFrame = frameIndex;
+		newResults = false;
+		FrameQueries& frame = frames[currentFrame];
+		if (!supported || frame.scopeNames.empty()) {
+			return;
+		}
+		// Each query is followed by its availability value, queries that are not available yet are skipped instead of waited for
+		const uint32_t queryCount = static_cast<uint32_t>(frame.scopeNames.size()) * 2;
+		const VkResult result = vkGetQueryPoolResults(device, frame.queryPool, 0, queryCount, queryCount * 2 * sizeof(uint64_t), queryData.data(), 2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if ((result != VK_SUCCESS) && (result != VK_NOT_READY)) {
+			VK_CHECK_RESULT(result);
+		}
+		if (results.size() != frame.scopeNames.size()) {
+			results.resize(frame.scopeNames.size());
+		}
+		for (size_t i = 0; i < frame.scopeNames.size(); i++) {
+			const uint64_t* begin = &queryData[i * 4];
+			const uint64_t* end = &queryData[i * 4 + 2];
+			if ((begin[1] == 0) || (end[1] == 0)) {
+				continue;
+			}
+			ScopeResult& scopeResult = results[i];
+			const double time = static_cast<double>((end[0] - begin[0]) & timestampMask) * timestampPeriod / 1000000.0;
+			// Restart the average if the set of scopes changed
+			scopeResult.averageTime = (scopeResult.name == frame.scopeNames[i]) ? scopeResult.averageTime * 0.95 + time * 0.05 : time;
+			scopeResult.name = frame.scopeNames[i];
+			scopeResult.time = time;
+			newResults = true;
+		}
+		frame.scopeNames.clear();
+	}
+
+	void GpuProfiler::resetQueries(VkCommandBuffer commandBuffer)
+	{
+		if (supported) {
+			vkCmdResetQueryPool(commandBuffer, frames[currentFrame].queryPool, 0, maxScopes * 2);
+		}
+	}
+
+	/**
+	* Start a named scope
+	*
+	* @note Both timestamps are written at the bottom of the pipe, so each scope measures the time between the completion of all previous work and the completion of its own work
+	*
+	* @return Index of the scope to be passed to endScope()
+	*/
+	uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name)
+	{
+		FrameQueries& frame = frames[currentFrame];
+		if (!supported || (frame.scopeNames.size() >= maxScopes)) {
+			return UINT32_MAX;
+		}
+		const uint32_t scope = static_cast<uint32_t>(frame.scopeNames.size());
+		frame.scopeNames.push_back(name);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, scope * 2);
+		return scope;
+	}
+
+	void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope)
+	{
+		if (scope != UINT32_MAX) {
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames[currentFrame].queryPool, scope * 2 + 1);
+		}
+	}
+}
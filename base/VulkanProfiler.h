@@ -0,0 +1,76 @@
+/*
+* Vulkan GPU profiler class
+*
+* Measures the GPU time of command buffer scopes with timestamp queries
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "vulkan/vulkan.h"
+#include "VulkanDevice.h"
+
+namespace vks
+{
+	/**
+	* @brief Timestamp based GPU profiler with one query pool per frame in flight
+	* @note Results of a frame are read once the frame's query pool is reused, i.e. after waiting for its fence, so reading them never stalls
+	*/
+	class GpuProfiler
+	{
+	public:
+		struct ScopeResult {
+			std::string name;
+			// GPU time of the last frame that has results available
+			double time = 0.0;
+			// Exponential moving average for display
+			double averageTime = 0.0;
+		};
+
+		/** @brief Writes the begin timestamp on construction and the end timestamp on destruction */
+		class Scope
+		{
+		public:
+			Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const std::string& name);
+			~Scope();
+		private:
+			GpuProfiler& profiler;
+			VkCommandBuffer commandBuffer;
+			uint32_t scope;
+		};
+
+		void create(vks::VulkanDevice* device, uint32_t frameCount, uint32_t maxScopes = 32);
+		void destroy();
+		bool isCreated() const { return !frames.empty(); }
+		/** @brief Collects the results the given frame in flight recorded last time and selects its query pool, call after waiting for the frame's fence */
+		void beginFrame(uint32_t frameIndex);
+		/** @brief Resets the current frame's queries, has to be recorded outside of a render pass before the first scope */
+		void resetQueries(VkCommandBuffer commandBuffer);
+		uint32_t beginScope(VkCommandBuffer commandBuffer, const std::string& name);
+		void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+		/** @brief Results of the most recent frame that has finished on the GPU, in recording order */
+		const std::vector<ScopeResult>& getResults() const { return results; }
+		/** @brief True if beginFrame() collected new results, e.g. to pass them on to the benchmark */
+		bool hasNewResults() const { return newResults; }
+	private:
+		struct FrameQueries {
+			VkQueryPool queryPool = VK_NULL_HANDLE;
+			std::vector<std::string> scopeNames;
+		};
+		VkDevice device = VK_NULL_HANDLE;
+		std::vector<FrameQueries> frames;
+		std::vector<ScopeResult> results;
+		// Timestamps and their availability values read back by beginFrame, sized for all queries of a pool
+		std::vector<uint64_t> queryData;
+		uint32_t currentFrame = 0;
+		uint32_t maxScopes = 0;
+		double timestampPeriod = 1.0;
+		uint64_t timestampMask = ~0ULL;
+		bool supported = false;
+		bool newResults = false;
+	};
+}
@@ -0,0 +1,607 @@
+/*
+* Vulkan render graph
+*
+* Derives barriers, culls unused passes and aliases transient images from the accesses passes declare
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include "VulkanRenderGraph.h"
+#include "VulkanInitializers.hpp"
+#include "VulkanTools.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace vks
+{
+	namespace
+	{
+		bool isDepthFormat(VkFormat format)
+		{
+			switch (format) {
+			case VK_FORMAT_D16_UNORM:
+			case VK_FORMAT_X8_D24_UNORM_PACK32:
+			case VK_FORMAT_D32_SFLOAT:
+			case VK_FORMAT_D16_UNORM_S8_UINT:
+			case VK_FORMAT_D24_UNORM_S8_UINT:
+			case VK_FORMAT_D32_SFLOAT_S8_UINT:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		bool isAttachment(RenderGraph::Access access)
+		{
+			return (access == RenderGraph::Access::ColorAttachment) || (access == RenderGraph::Access::DepthStencilAttachment);
+		}
+	}
+
+	bool RenderGraph::AttachmentKey::operator<(const AttachmentKey& other) const
+	{
+		return std::tie(format, storeOp, depth) < std::tie(other.format, other.storeOp, other.depth);
+	}
+
+	void RenderGraph::create(vks::VulkanDevice* device, bool aliasing)
+	{
+		this->device = device;
+		this->aliasing = aliasing;
+	}
+
+	void RenderGraph::destroy()
+	{
+		if (!device) {
+			return;
+		}
+		reset();
+		for (auto& renderPass : renderPasses) {
+			vkDestroyRenderPass(device->logicalDevice, renderPass.second, nullptr);
+		}
+		renderPasses.clear();
+		device = nullptr;
+	}
+
+	void RenderGraph::reset()
+	{
+		for (Pass& pass : passes) {
+			if (pass.framebuffer != VK_NULL_HANDLE) {
+				vkDestroyFramebuffer(device->logicalDevice, pass.framebuffer, nullptr);
+			}
+		}
+		for (Resource& resource : resources) {
+			for (VkImageView levelView : resource.levelViews) {
+				vkDestroyImageView(device->logicalDevice, levelView, nullptr);
+			}
+			if (resource.view != VK_NULL_HANDLE) {
+				vkDestroyImageView(device->logicalDevice, resource.view, nullptr);
+			}
+			if (resource.image != VK_NULL_HANDLE) {
+				vkDestroyImage(device->logicalDevice, resource.image, nullptr);
+			}
+			device->memoryAllocator.free(resource.allocation);
+		}
+		device->memoryAllocator.free(aliasedAllocation);
+		aliasedAllocation = vks::Allocation();
+		passes.clear();
+		resources.clear();
+		memoryStatistics = MemoryStatistics();
+	}
+
+	RenderGraph::ResourceHandle RenderGraph::createImage(const std::string& name, const ImageDesc& desc)
+	{
+		Resource resource;
+		resource.name = name;
+		resource.desc = desc;
+		if (isDepthFormat(desc.format)) {
+			resource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | (vks::tools::formatHasStencil(desc.format) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+		} else {
+			resource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+		resources.push_back(resource);
+		return static_cast<ResourceHandle>(resources.size() - 1);
+	}
+
+	void RenderGraph::markOutput(ResourceHandle resource)
+	{
+		resources[resource].output = true;
+	}
+
+	RenderGraph::PassHandle RenderGraph::addPass(const std::string& name, PassType type, std::function<void(VkCommandBuffer)> record)
+	{
+		Pass pass;
+		pass.name = name;
+		pass.type = type;
+		pass.record = record;
+		passes.push_back(pass);
+		return static_cast<PassHandle>(passes.size() - 1);
+	}
+
+	void RenderGraph::read(PassHandle pass, ResourceHandle resource, Access access)
+	{
+		assert((resource != None) && !getAccessInfo(passes[pass].type, access, resources[resource].aspectMask).write);
+		passes[pass].accesses.push_back({ resource, access, {} });
+	}
+
+	void RenderGraph::write(PassHandle pass, ResourceHandle resource, Access access, VkClearValue clearValue)
+	{
+		// Only attachment slots can be left unused
+		assert(((resource != None) || (access == Access::ColorAttachment)) && getAccessInfo(passes[pass].type, access, VK_IMAGE_ASPECT_COLOR_BIT).write);
+		assert(!isAttachment(access) || (passes[pass].type == PassType::Graphics));
+		passes[pass].accesses.push_back({ resource, access, clearValue });
+	}
+
+	void RenderGraph::setSideEffects(PassHandle pass)
+	{
+		passes[pass].sideEffects = true;
+	}
+
+	RenderGraph::AccessInfo RenderGraph::getAccessInfo(PassType type, Access access, VkImageAspectFlags aspectMask)
+	{
+		const VkPipelineStageFlags shaderStage = (type == PassType::Compute) ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		switch (access) {
+		case Access::ColorAttachment:
+			return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true };
+		case Access::DepthStencilAttachment:
+			return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true };
+		case Access::Sampled: {
+			const VkImageLayout layout = (aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			return { shaderStage, VK_ACCESS_SHADER_READ_BIT, layout, VK_IMAGE_USAGE_SAMPLED_BIT, false };
+		}
+		case Access::StorageWrite:
+			return { shaderStage, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true };
+		case Access::TransferSrc:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false };
+		case Access::TransferDst:
+		default:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true };
+		}
+	}
+
+	void RenderGraph::compile()
+	{
+		cullPasses();
+		createImages();
+		allocateMemory();
+		createFramebuffers();
+	}
+
+	// Walks the passes backwards from the outputs and the passes with side effects, a pass is only needed if a needed pass reads one of its writes
+	void RenderGraph::cullPasses()
+	{
+		std::vector<bool> required(resources.size());
+		for (size_t i = 0; i < resources.size(); i++) {
+			required[i] = resources[i].output;
+		}
+		for (size_t i = passes.size(); i-- > 0;) {
+			Pass& pass = passes[i];
+			bool needed = pass.sideEffects;
+			for (const PassAccess& access : pass.accesses) {
+				if ((access.resource != None) && getAccessInfo(pass.type, access.access, resources[access.resource].aspectMask).write) {
+					needed = needed || required[access.resource];
+				}
+			}
+			pass.culled = !needed;
+			if (!needed) {
+				continue;
+			}
+			for (const PassAccess& access : pass.accesses) {
+				if ((access.resource != None) && !getAccessInfo(pass.type, access.access, resources[access.resource].aspectMask).write) {
+					required[access.resource] = true;
+				}
+			}
+		}
+
+		memoryStatistics.passCount = static_cast<uint32_t>(passes.size());
+		memoryStatistics.culledPassCount = static_cast<uint32_t>(std::count_if(passes.begin(), passes.end(), [](const Pass& pass) { return pass.culled; }));
+	}
+
+	void RenderGraph::createImages()
+	{
+		const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		for (size_t i = 0; i < resources.size(); i++) {
+			Resource& resource = resources[i];
+			const ResourceHandle handle = static_cast<ResourceHandle>(i);
+			resource.usage = resource.desc.usage;
+			resource.firstPass = ~0u;
+			resource.lastPass = 0;
+			// Usage covers the accesses of culled passes too, as descriptors for them may still be written
+			std::vector<uint32_t> accessingPasses;
+			for (uint32_t p = 0; p < static_cast<uint32_t>(passes.size()); p++) {
+				for (const PassAccess& access : passes[p].accesses) {
+					if (access.resource != handle) {
+						continue;
+					}
+					resource.usage |= getAccessInfo(passes[p].type, access.access, resource.aspectMask).usage;
+					if (accessingPasses.empty() || (accessingPasses.back() != p)) {
+						accessingPasses.push_back(p);
+					}
+					if (!passes[p].culled) {
+						resource.firstPass = std::min(resource.firstPass, p);
+						resource.lastPass = std::max(resource.lastPass, p);
+					}
+				}
+			}
+			// An image that is only an attachment of a single pass never needs to be stored, on tile based GPUs it may never leave tile memory
+			// Images of culled passes are aliased instead, so they don't take up memory
+			const bool live = resource.firstPass <= resource.lastPass;
+			resource.transient = aliasing && live && !resource.output && (accessingPasses.size() == 1) && ((resource.usage & ~attachmentUsage) == 0);
+			// Images can be sampled unless they are transient, so descriptors don't depend on which passes are part of the graph
+			resource.usage |= resource.transient ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : VK_IMAGE_USAGE_SAMPLED_BIT;
+
+			VkImageCreateInfo imageCreateInfo = vks::initializers::imageCreateInfo();
+			imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageCreateInfo.format = resource.desc.format;
+			imageCreateInfo.extent = { resource.desc.width, resource.desc.height, 1 };
+			imageCreateInfo.mipLevels = resource.desc.levels;
+			imageCreateInfo.arrayLayers = resource.desc.layers;
+			imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageCreateInfo.usage = resource.usage;
+			VK_CHECK_RESULT(vkCreateImage(device->logicalDevice, &imageCreateInfo, nullptr, &resource.image));
+			vkGetImageMemoryRequirements(device->logicalDevice, resource.image, &resource.memReqs);
+			resource.state = ImageState();
+		}
+	}
+
+	// Places every image that isn't an output or transient at the lowest offset of one shared allocation where it doesn't overlap an image that is live at the same time
+	// Images that no pass accesses are never live and end up at offset 0, so their views can still be created for descriptors without taking up memory
+	void RenderGraph::allocateMemory()
+	{
+		std::vector<ResourceHandle> aliased;
+		for (size_t i = 0; i < resources.size(); i++) {
+			Resource& resource = resources[i];
+			memoryStatistics.unaliased += resource.memReqs.size;
+			if (aliasing && !resource.output && !resource.transient) {
+				aliased.push_back(static_cast<ResourceHandle>(i));
+				continue;
+			}
+			// Transient attachments are placed in lazily allocated memory if available
+			VkBool32 lazilyAllocated = VK_FALSE;
+			uint32_t memoryTypeIndex = 0;
+			if (resource.transient) {
+				memoryTypeIndex = device->getMemoryType(resource.memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &lazilyAllocated);
+			}
+			if (!lazilyAllocated) {
+				memoryTypeIndex = device->getMemoryType(resource.memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			}
+			VK_CHECK_RESULT(device->memoryAllocator.allocate(resource.memReqs, memoryTypeIndex, vks::MemoryAllocator::ResourceKind::OptimalImage, vks::MemoryAllocator::Strategy::FreeList, &resource.allocation));
+			VK_CHECK_RESULT(vkBindImageMemory(device->logicalDevice, resource.image, resource.allocation.memory, resource.allocation.offset));
+			if (lazilyAllocated) {
+				memoryStatistics.lazilyAllocated += resource.allocation.size;
+			} else {
+				memoryStatistics.resident += resource.allocation.size;
+			}
+		}
+
+		if (!aliased.empty()) {
+			auto live = [this](ResourceHandle a, ResourceHandle b) {
+				const Resource& ra = resources[a];
+				const Resource& rb = resources[b];
+				return (ra.firstPass <= ra.lastPass) && (rb.firstPass <= rb.lastPass) && (ra.firstPass <= rb.lastPass) && (rb.firstPass <= ra.lastPass);
+			};
+			auto overlap = [this](ResourceHandle a, ResourceHandle b) {
+				const Resource& ra = resources[a];
+				const Resource& rb = resources[b];
+				return (ra.aliasOffset < rb.aliasOffset + rb.memReqs.size) && (rb.aliasOffset < ra.aliasOffset + ra.memReqs.size);
+			};
+			// Placing the largest images first leaves the smaller ones to fill the gaps
+			std::stable_sort(aliased.begin(), aliased.end(), [this](ResourceHandle a, ResourceHandle b) { return resources[a].memReqs.size > resources[b].memReqs.size; });
+			VkMemoryRequirements memReqs{ 0, 1, ~0u };
+			for (size_t i = 0; i < aliased.size(); i++) {
+				Resource& resource = resources[aliased[i]];
+				resource.aliasOffset = 0;
+				bool collision = true;
+				while (collision) {
+					collision = false;
+					resource.aliasOffset = (resource.aliasOffset + resource.memReqs.alignment - 1) / resource.memReqs.alignment * resource.memReqs.alignment;
+					for (size_t j = 0; j < i; j++) {
+						if (live(aliased[i], aliased[j]) && overlap(aliased[i], aliased[j])) {
+							resource.aliasOffset = resources[aliased[j]].aliasOffset + resources[aliased[j]].memReqs.size;
+							collision = true;
+						}
+					}
+				}
+				memReqs.size = std::max(memReqs.size, resource.aliasOffset + resource.memReqs.size);
+				// Alignments are powers of two, so an allocation aligned to the largest one satisfies all offsets
+				memReqs.alignment = std::max(memReqs.alignment, resource.memReqs.alignment);
+				memReqs.memoryTypeBits &= resource.memReqs.memoryTypeBits;
+			}
+			assert(memReqs.memoryTypeBits != 0);
+			VK_CHECK_RESULT(device->memoryAllocator.allocate(memReqs, device->getMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), vks::MemoryAllocator::ResourceKind::OptimalImage, vks::MemoryAllocator::Strategy::FreeList, &aliasedAllocation));
+			memoryStatistics.resident += aliasedAllocation.size;
+			for (ResourceHandle handle : aliased) {
+				Resource& resource = resources[handle];
+				resource.aliased = true;
+				VK_CHECK_RESULT(vkBindImageMemory(device->logicalDevice, resource.image, aliasedAllocation.memory, aliasedAllocation.offset + resource.aliasOffset));
+				// Only images that are live at some point in the frame ever hand over memory
+				for (ResourceHandle other : aliased) {
+					if ((other != handle) && (resource.firstPass <= resource.lastPass) && (resources[other].firstPass <= resources[other].lastPass) && overlap(handle, other)) {
+						resource.overlapping.push_back(other);
+					}
+				}
+			}
+		}
+
+		for (Resource& resource : resources) {
+			createViews(resource);
+		}
+	}
+
+	void RenderGraph::createViews(Resource& resource)
+	{
+		VkImageViewCreateInfo imageViewCreateInfo = vks::initializers::imageViewCreateInfo();
+		imageViewCreateInfo.viewType = (resource.desc.layers > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+		imageViewCreateInfo.format = resource.desc.format;
+		imageViewCreateInfo.image = resource.image;
+		imageViewCreateInfo.subresourceRange = { resource.aspectMask, 0, resource.desc.levels, 0, resource.desc.layers };
+		VK_CHECK_RESULT(vkCreateImageView(device->logicalDevice, &imageViewCreateInfo, nullptr, &resource.view));
+		if (resource.desc.levels > 1) {
+			resource.levelViews.resize(resource.desc.levels);
+			for (uint32_t i = 0; i < resource.desc.levels; i++) {
+				imageViewCreateInfo.subresourceRange = { resource.aspectMask, i, 1, 0, resource.desc.layers };
+				VK_CHECK_RESULT(vkCreateImageView(device->logicalDevice, &imageViewCreateInfo, nullptr, &resource.levelViews[i]));
+			}
+		}
+	}
+
+	void RenderGraph::createFramebuffers()
+	{
+		for (Pass& pass : passes) {
+			if (pass.culled || (pass.type != PassType::Graphics)) {
+				continue;
+			}
+			std::vector<AttachmentKey> attachments;
+			std::vector<VkImageView> views;
+			for (const PassAccess& access : pass.accesses) {
+				if (!isAttachment(access.access)) {
+					continue;
+				}
+				if (access.resource == None) {
+					attachments.push_back({ VK_FORMAT_UNDEFINED, VK_ATTACHMENT_STORE_OP_DONT_CARE, false });
+					continue;
+				}
+				const Resource& resource = resources[access.resource];
+				attachments.push_back({ resource.desc.format, resource.transient ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE, access.access == Access::DepthStencilAttachment });
+				views.push_back(resource.view);
+				pass.clearValues.push_back(access.clearValue);
+				pass.extent = { resource.desc.width, resource.desc.height };
+			}
+			if (views.empty()) {
+				continue;
+			}
+			pass.renderPass = findRenderPass(attachments);
+			VkFramebufferCreateInfo framebufferCreateInfo = vks::initializers::framebufferCreateInfo();
+			framebufferCreateInfo.renderPass = pass.renderPass;
+			framebufferCreateInfo.attachmentCount = static_cast<uint32_t>(views.size());
+			framebufferCreateInfo.pAttachments = views.data();
+			framebufferCreateInfo.width = pass.extent.width;
+			framebufferCreateInfo.height = pass.extent.height;
+			framebufferCreateInfo.layers = 1;
+			VK_CHECK_RESULT(vkCreateFramebuffer(device->logicalDevice, &framebufferCreateInfo, nullptr, &pass.framebuffer));
+		}
+	}
+
+	VkRenderPass RenderGraph::getRenderPass(const std::vector<VkFormat>& colorFormats, VkFormat depthFormat)
+	{
+		std::vector<AttachmentKey> attachments;
+		for (VkFormat format : colorFormats) {
+			attachments.push_back({ format, (format != VK_FORMAT_UNDEFINED) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE, false });
+		}
+		if (depthFormat != VK_FORMAT_UNDEFINED) {
+			attachments.push_back({ depthFormat, VK_ATTACHMENT_STORE_OP_STORE, true });
+		}
+		return findRenderPass(attachments);
+	}
+
+	// Render passes only differ in formats and store ops, pipelines created for one of them are compatible with all passes writing the same formats
+	// The graph transitions the attachments before the render pass begins and leaves them in their attachment layout, so the render passes don't need external dependencies
+	VkRenderPass RenderGraph::findRenderPass(const std::vector<AttachmentKey>& attachments)
+	{
+		auto it = renderPasses.find(attachments);
+		if (it != renderPasses.end()) {
+			return it->second;
+		}
+
+		std::vector<VkAttachmentDescription> attachmentDescriptions;
+		std::vector<VkAttachmentReference> colorReferences;
+		VkAttachmentReference depthReference{ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED };
+		for (const AttachmentKey& attachment : attachments) {
+			if (attachment.format == VK_FORMAT_UNDEFINED) {
+				colorReferences.push_back({ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+				continue;
+			}
+			const VkImageLayout layout = attachment.depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			VkAttachmentDescription attachmentDescription{};
+			attachmentDescription.format = attachment.format;
+			attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
+			attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			attachmentDescription.storeOp = attachment.storeOp;
+			attachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachmentDescription.initialLayout = layout;
+			attachmentDescription.finalLayout = layout;
+			const VkAttachmentReference reference = { static_cast<uint32_t>(attachmentDescriptions.size()), layout };
+			if (attachment.depth) {
+				depthReference = reference;
+			} else {
+				colorReferences.push_back(reference);
+			}
+			attachmentDescriptions.push_back(attachmentDescription);
+		}
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+		subpass.pColorAttachments = colorReferences.data();
+		subpass.pDepthStencilAttachment = (depthReference.attachment != VK_ATTACHMENT_UNUSED) ? &depthReference : nullptr;
+
+		VkRenderPassCreateInfo renderPassCreateInfo = vks::initializers::renderPassCreateInfo();
+		renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachmentDescriptions.size());
+		renderPassCreateInfo.pAttachments = attachmentDescriptions.data();
+		renderPassCreateInfo.subpassCount = 1;
+		renderPassCreateInfo.pSubpasses = &subpass;
+		VkRenderPass renderPass;
+		VK_CHECK_RESULT(vkCreateRenderPass(device->logicalDevice, &renderPassCreateInfo, nullptr, &renderPass));
+		renderPasses[attachments] = renderPass;
+		return renderPass;
+	}
+
+	// Each pass gets one pipeline barrier that waits for exactly the stages that last accessed its images
+	// The state of an image is carried over to the next frame, so the first barrier of a frame also covers the accesses of the previous one
+	void RenderGraph::execute(VkCommandBuffer commandBuffer)
+	{
+		for (Resource& resource : resources) {
+			resource.acquired = false;
+		}
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		for (Pass& pass : passes) {
+			if (pass.culled) {
+				continue;
+			}
+			imageBarriers.clear();
+			VkPipelineStageFlags srcStages = 0;
+			VkPipelineStageFlags dstStages = 0;
+			// Waits for the accesses to other images that were placed in the same memory
+			VkMemoryBarrier aliasingBarrier = vks::initializers::memoryBarrier();
+			bool aliasingBarrierRequired = false;
+
+			for (const PassAccess& access : pass.accesses) {
+				if (access.resource == None) {
+					continue;
+				}
+				Resource& resource = resources[access.resource];
+				ImageState& state = resource.state;
+				const AccessInfo info = getAccessInfo(pass.type, access.access, resource.aspectMask);
+
+				bool discard = false;
+				if (!resource.acquired && !resource.overlapping.empty()) {
+					// The first access of a frame to an aliased image has to write it, its memory has been used by other images since
+					assert(info.write);
+					for (ResourceHandle other : resource.overlapping) {
+						const ImageState& otherState = resources[other].state;
+						if ((otherState.writeStages | otherState.readStages) != 0) {
+							srcStages |= otherState.writeStages | otherState.readStages;
+							aliasingBarrier.srcAccessMask |= otherState.writeAccess;
+							aliasingBarrierRequired = true;
+						}
+					}
+					if (aliasingBarrierRequired) {
+						aliasingBarrier.dstAccessMask |= info.access;
+						dstStages |= info.stages;
+					}
+					discard = true;
+				}
+				resource.acquired = true;
+
+				// Layout transitions wait for all previous accesses, writes replace the contents so the old layout is discarded
+				const bool transition = discard || (state.layout != info.layout);
+				VkPipelineStageFlags waitStages = 0;
+				bool barrierRequired = false;
+				if (transition) {
+					waitStages = state.writeStages | state.readStages;
+					barrierRequired = true;
+					discard = discard || info.write;
+				} else if (info.write) {
+					// Write after write and write after read
+					waitStages = state.writeStages | state.readStages;
+					barrierRequired = waitStages != 0;
+				} else {
+					// Read after write, unless the write has already been made visible to this stage and access
+					waitStages = state.writeStages;
+					barrierRequired = (waitStages != 0) && (((info.stages & ~state.visibleStages) != 0) || ((info.access & ~state.visibleAccess) != 0));
+				}
+
+				if (barrierRequired) {
+					VkImageMemoryBarrier imageBarrier = vks::initializers::imageMemoryBarrier();
+					imageBarrier.srcAccessMask = state.writeAccess;
+					imageBarrier.dstAccessMask = info.access;
+					imageBarrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+					imageBarrier.newLayout = info.layout;
+					imageBarrier.image = resource.image;
+					imageBarrier.subresourceRange = { resource.aspectMask, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+					imageBarriers.push_back(imageBarrier);
+					srcStages |= waitStages;
+					dstStages |= info.stages;
+				}
+
+				if (info.write) {
+					state.layout = info.layout;
+					state.writeStages = info.stages;
+					state.writeAccess = info.access;
+					state.readStages = 0;
+					state.visibleStages = 0;
+					state.visibleAccess = 0;
+				} else if (transition) {
+					// The transition has made the last write available, later readers only have to wait for the transition
+					state.layout = info.layout;
+					state.writeStages = info.stages;
+					state.writeAccess = 0;
+					state.readStages = info.stages;
+					state.visibleStages = info.stages;
+					state.visibleAccess = info.access;
+				} else {
+					state.readStages |= info.stages;
+					if (barrierRequired) {
+						state.visibleStages |= info.stages;
+						state.visibleAccess |= info.access;
+					}
+				}
+			}
+
+			if (!imageBarriers.empty() || aliasingBarrierRequired) {
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					(srcStages != 0) ? srcStages : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+					dstStages,
+					0,
+					aliasingBarrierRequired ? 1 : 0, &aliasingBarrier,
+					0, nullptr,
+					static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+			}
+
+			if (pass.framebuffer != VK_NULL_HANDLE) {
+				VkRenderPassBeginInfo renderPassBeginInfo = vks::initializers::renderPassBeginInfo();
+				renderPassBeginInfo.renderPass = pass.renderPass;
+				renderPassBeginInfo.framebuffer = pass.framebuffer;
+				renderPassBeginInfo.renderArea.extent = pass.extent;
+				renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+				renderPassBeginInfo.pClearValues = pass.clearValues.data();
+				vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+				VkViewport viewport = vks::initializers::viewport(static_cast<float>(pass.extent.width), static_cast<float>(pass.extent.height), 0.0f, 1.0f);
+				vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+				VkRect2D scissor = vks::initializers::rect2D(pass.extent.width, pass.extent.height, 0, 0);
+				vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+				pass.record(commandBuffer);
+				vkCmdEndRenderPass(commandBuffer);
+			} else {
+				pass.record(commandBuffer);
+			}
+		}
+	}
+
+	VkImage RenderGraph::getImage(ResourceHandle resource) const
+	{
+		return resources[resource].image;
+	}
+
+	VkImageView RenderGraph::getImageView(ResourceHandle resource) const
+	{
+		return resources[resource].view;
+	}
+
+	VkImageView RenderGraph::getLevelView(ResourceHandle resource, uint32_t level) const
+	{
+		return resources[resource].levelViews.empty() ? resources[resource].view : resources[resource].levelViews[level];
+	}
+
+	VkImageLayout RenderGraph::getLayout(ResourceHandle resource, Access access) const
+	{
+		return getAccessInfo(PassType::Graphics, access, resources[resource].aspectMask).layout;
+	}
+
+	bool RenderGraph::isCulled(PassHandle pass) const
+	{
+		return passes[pass].culled;
+	}
+}
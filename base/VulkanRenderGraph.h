@@ -0,0 +1,183 @@
+/*
+* Vulkan render graph
+*
+* Derives barriers, culls unused passes and aliases transient images from the accesses passes declare
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+
+#include "vulkan/vulkan.h"
+#include "VulkanDevice.h"
+#include "VulkanMemoryAllocator.h"
+
+namespace vks
+{
+	/**
+	* @brief Minimal frame graph of graphics, compute and transfer passes that read and write images owned by the graph
+	* @note The graph is declared and compiled once per configuration and then executed every frame, images, views and framebuffers stay valid until reset()
+	* @note Passes are executed in declaration order, the graph only decides which of them run and how they are synchronized
+	*/
+	class RenderGraph
+	{
+	public:
+		typedef uint32_t ResourceHandle;
+		typedef uint32_t PassHandle;
+		/** @brief Refers to no resource, as a color attachment it leaves the attachment location unused */
+		static const ResourceHandle None = ~0u;
+
+		/** @brief Decides the pipeline stage of sampled and storage image accesses, graphics passes access images in fragment shaders */
+		enum class PassType { Graphics, Compute, Transfer };
+		/** @brief How a pass accesses an image, write accesses replace the contents of the whole image */
+		enum class Access { ColorAttachment, DepthStencilAttachment, Sampled, StorageWrite, TransferSrc, TransferDst };
+
+		struct ImageDesc {
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			uint32_t width = 1;
+			uint32_t height = 1;
+			/** @brief Images with more than one layer are viewed as 2D arrays */
+			uint32_t layers = 1;
+			/** @brief Images with more than one level also get a view per level */
+			uint32_t levels = 1;
+			/** @brief Usage in addition to the usage of the declared accesses, e.g. for descriptors that are written for passes that are not part of the graph */
+			VkImageUsageFlags usage = 0;
+		};
+
+		struct MemoryStatistics {
+			/** @brief Memory the images would take up with one allocation each */
+			VkDeviceSize unaliased = 0;
+			VkDeviceSize resident = 0;
+			VkDeviceSize lazilyAllocated = 0;
+			uint32_t passCount = 0;
+			uint32_t culledPassCount = 0;
+		};
+
+		/** @param aliasing If false, every image gets its own memory and attachments are never transient, e.g. to compare memory use */
+		void create(vks::VulkanDevice* device, bool aliasing = true);
+		/** @brief Destroys all resources including the cached render passes */
+		void destroy();
+		/** @brief Destroys the images and framebuffers and clears the declaration, render passes are kept as pipelines may have been created for them */
+		void reset();
+
+		ResourceHandle createImage(const std::string& name, const ImageDesc& desc);
+		/** @brief The contents of outputs survive the frame, e.g. for history read by the next frame, outputs are never culled or aliased */
+		void markOutput(ResourceHandle resource);
+
+		PassHandle addPass(const std::string& name, PassType type, std::function<void(VkCommandBuffer)> record);
+		void read(PassHandle pass, ResourceHandle resource, Access access = Access::Sampled);
+		/**
+		* @brief Declare a write of a pass
+		* @note Attachments are cleared to the clear value and are bound in the order they are declared, the graph begins the render pass before recording the pass and sets a viewport and scissor covering the attachments
+		*/
+		void write(PassHandle pass, ResourceHandle resource, Access access, VkClearValue clearValue = {});
+		/** @brief Passes with side effects, e.g. writes to the swapchain or to host visible buffers, are never culled */
+		void setSideEffects(PassHandle pass);
+
+		/** @brief Culls passes that don't contribute to an output or a pass with side effects, then creates the images, their memory and the framebuffers */
+		void compile();
+		/** @brief Records all passes that haven't been culled with the barriers between them */
+		void execute(VkCommandBuffer commandBuffer);
+
+		VkImage getImage(ResourceHandle resource) const;
+		VkImageView getImageView(ResourceHandle resource) const;
+		VkImageView getLevelView(ResourceHandle resource, uint32_t level) const;
+		/** @brief Layout of the image while a pass accesses it with the given access */
+		VkImageLayout getLayout(ResourceHandle resource, Access access) const;
+		bool isCulled(PassHandle pass) const;
+		/** @brief Render pass compatible with the graphics passes writing attachments of these formats, for pipeline creation, VK_FORMAT_UNDEFINED is an unused color attachment */
+		VkRenderPass getRenderPass(const std::vector<VkFormat>& colorFormats, VkFormat depthFormat = VK_FORMAT_UNDEFINED);
+		MemoryStatistics getMemoryStatistics() const { return memoryStatistics; }
+	private:
+		// Synchronization state of an image, carried over between frames
+		struct ImageState {
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			// Last write (or layout transition), made available with the write access
+			VkPipelineStageFlags writeStages = 0;
+			VkAccessFlags writeAccess = 0;
+			// Reads since the last write, later writes have to wait for them
+			VkPipelineStageFlags readStages = 0;
+			// Stages and accesses the last write has been made visible to
+			VkPipelineStageFlags visibleStages = 0;
+			VkAccessFlags visibleAccess = 0;
+		};
+		struct Resource {
+			std::string name;
+			ImageDesc desc;
+			VkImageAspectFlags aspectMask = 0;
+			VkImageUsageFlags usage = 0;
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			std::vector<VkImageView> levelViews;
+			VkMemoryRequirements memReqs{};
+			// Set for images with their own memory, aliased images are bound to the shared allocation at aliasOffset
+			vks::Allocation allocation;
+			bool aliased = false;
+			VkDeviceSize aliasOffset = 0;
+			// Aliased images whose memory overlaps with this one
+			std::vector<ResourceHandle> overlapping;
+			bool output = false;
+			// Only used as an attachment within a single pass that isn't culled, its contents are never stored
+			bool transient = false;
+			// First and last pass accessing the image, firstPass > lastPass if no pass that runs accesses it
+			uint32_t firstPass = 0;
+			uint32_t lastPass = 0;
+			ImageState state;
+			// Set by the first access of a frame, aliased images discard their contents then
+			bool acquired = false;
+		};
+		struct PassAccess {
+			ResourceHandle resource;
+			Access access;
+			VkClearValue clearValue;
+		};
+		struct Pass {
+			std::string name;
+			PassType type;
+			std::function<void(VkCommandBuffer)> record;
+			std::vector<PassAccess> accesses;
+			bool sideEffects = false;
+			bool culled = false;
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			VkFramebuffer framebuffer = VK_NULL_HANDLE;
+			VkExtent2D extent{};
+			std::vector<VkClearValue> clearValues;
+		};
+		struct AccessInfo {
+			VkPipelineStageFlags stages;
+			VkAccessFlags access;
+			VkImageLayout layout;
+			VkImageUsageFlags usage;
+			bool write;
+		};
+		// One attachment of a render pass, format, store op and depth flag, an unused color attachment has an undefined format
+		struct AttachmentKey {
+			VkFormat format;
+			VkAttachmentStoreOp storeOp;
+			bool depth;
+			bool operator<(const AttachmentKey& other) const;
+		};
+
+		vks::VulkanDevice* device = nullptr;
+		bool aliasing = true;
+		std::vector<Resource> resources;
+		std::vector<Pass> passes;
+		// Memory shared by all aliased images
+		vks::Allocation aliasedAllocation;
+		std::map<std::vector<AttachmentKey>, VkRenderPass> renderPasses;
+		MemoryStatistics memoryStatistics;
+
+		static AccessInfo getAccessInfo(PassType type, Access access, VkImageAspectFlags aspectMask);
+		void cullPasses();
+		void createImages();
+		void allocateMemory();
+		void createViews(Resource& resource);
+		void createFramebuffers();
+		VkRenderPass findRenderPass(const std::vector<AttachmentKey>& attachments);
+	};
+}
@@ -192,6 +192,92 @@ void VulkanSwapChain::initSurface(screen_context_t screen_context, screen_window
 	colorSpace = selectedFormat.colorSpace;
 }
 
+/**
+* Use an image ring owned by the swap chain class instead of a surface and a swap chain, e.g. to render without a window system
+*
+* @param queue Queue used to signal and wait on the semaphores passed to acquireNextImage and queuePresent
+* @param queueFamilyIndex Family of the queue, used by the examples for their command pools
+* @param format Color format of the images, must support color attachment and transfer source usage
+*
+* @note The images are transitioned to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR by the render passes like swap chain images, so VK_KHR_swapchain still needs to be enabled on the device
+*/
+void VulkanSwapChain::initHeadless(VkQueue queue, uint32_t queueFamilyIndex, VkFormat format)
+{
+	headless = true;
+	headlessQueue = queue;
+	queueNodeIndex = queueFamilyIndex;
+	colorFormat = format;
+	colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+}
+
+void VulkanSwapChain::createHeadlessImages(uint32_t width, uint32_t height)
+{
+	// Same number of images as a typical swap chain, so examples with per image resources behave the same
+	imageCount = 3;
+	images.resize(imageCount);
+	buffers.resize(imageCount);
+	headlessMemory.resize(imageCount);
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+	for (uint32_t i = 0; i < imageCount; i++)
+	{
+		VkImageCreateInfo imageCI = {};
+		imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageCI.imageType = VK_IMAGE_TYPE_2D;
+		imageCI.format = colorFormat;
+		imageCI.extent = { width, height, 1 };
+		imageCI.mipLevels = 1;
+		imageCI.arrayLayers = 1;
+		imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageCI.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		imageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VK_CHECK_RESULT(vkCreateImage(device, &imageCI, nullptr, &images[i]));
+
+		VkMemoryRequirements memReqs;
+		vkGetImageMemoryRequirements(device, images[i], &memReqs);
+		VkMemoryAllocateInfo memAlloc = {};
+		memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		memAlloc.allocationSize = memReqs.size;
+		memAlloc.memoryTypeIndex = UINT32_MAX;
+		for (uint32_t j = 0; j < memoryProperties.memoryTypeCount; j++) {
+			if ((memReqs.memoryTypeBits & (1 << j)) && (memoryProperties.memoryTypes[j].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+				memAlloc.memoryTypeIndex = j;
+				break;
+			}
+		}
+		if (memAlloc.memoryTypeIndex == UINT32_MAX) {
+			vks::tools::exitFatal("Could not find a memory type for the headless images!", -1);
+		}
+		VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &headlessMemory[i]));
+		VK_CHECK_RESULT(vkBindImageMemory(device, images[i], headlessMemory[i], 0));
+
+		VkImageViewCreateInfo colorAttachmentView = {};
+		colorAttachmentView.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		colorAttachmentView.format = colorFormat;
+		colorAttachmentView.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		colorAttachmentView.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		colorAttachmentView.image = images[i];
+		buffers[i].image = images[i];
+		VK_CHECK_RESULT(vkCreateImageView(device, &colorAttachmentView, nullptr, &buffers[i].view));
+	}
+	headlessImageIndex = imageCount - 1;
+}
+
+void VulkanSwapChain::destroyHeadlessImages()
+{
+	for (uint32_t i = 0; i < images.size(); i++)
+	{
+		vkDestroyImageView(device, buffers[i].view, nullptr);
+		vkDestroyImage(device, images[i], nullptr);
+		vkFreeMemory(device, headlessMemory[i], nullptr);
+	}
+	images.clear();
+	buffers.clear();
+	headlessMemory.clear();
+}
+
 /**
 * Set instance, physical and logical device to use for the swapchain and get all required function pointers
 * 
@@ -216,6 +302,14 @@ void VulkanSwapChain::connect(VkInstance instance, VkPhysicalDevice physicalDevi
 */
 void VulkanSwapChain::create(uint32_t *width, uint32_t *height, bool vsync, bool fullscreen)
 {
+	if (headless)
+	{
+		// Without a surface the requested size is always used
+		destroyHeadlessImages();
+		createHeadlessImages(*width, *height);
+		return;
+	}
+
 	// Store the current swap chain handle so we can use it later on to ease up recreation
 	VkSwapchainKHR oldSwapchain = swapChain;
 
@@ -408,6 +502,22 @@ void VulkanSwapChain::create(uint32_t *width, uint32_t *height, bool vsync, bool
 */
 VkResult VulkanSwapChain::acquireNextImage(VkSemaphore presentCompleteSemaphore, uint32_t *imageIndex)
 {
+	if (headless)
+	{
+		// The images of the ring are reused in order, the caller's fences guarantee that the GPU is done with an image before it comes around again
+		headlessImageIndex = (headlessImageIndex + 1) % imageCount;
+		*imageIndex = headlessImageIndex;
+		if (presentCompleteSemaphore == VK_NULL_HANDLE)
+		{
+			return VK_SUCCESS;
+		}
+		// Signal the semaphore like the presentation engine would, so submissions waiting on it work unchanged
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &presentCompleteSemaphore;
+		return vkQueueSubmit(headlessQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	}
 	// By setting timeout to UINT64_MAX we will always wait until the next image has been acquired or an actual error is thrown
 	// With that we don't have to handle VK_NOT_READY
 	return vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, presentCompleteSemaphore, (VkFence)nullptr, imageIndex);
@@ -424,6 +534,21 @@ VkResult VulkanSwapChain::acquireNextImage(VkSemaphore presentCompleteSemaphore,
 */
 VkResult VulkanSwapChain::queuePresent(VkQueue queue, uint32_t imageIndex, VkSemaphore waitSemaphore)
 {
+	if (headless)
+	{
+		if (waitSemaphore == VK_NULL_HANDLE)
+		{
+			return VK_SUCCESS;
+		}
+		// Nothing is presented, but the semaphore has to be waited on (unsignaled) before it can be signaled again
+		const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &waitSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStage;
+		return vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+	}
 	VkPresentInfoKHR presentInfo = {};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	presentInfo.pNext = NULL;
@@ -445,6 +570,11 @@ VkResult VulkanSwapChain::queuePresent(VkQueue queue, uint32_t imageIndex, VkSem
 */
 void VulkanSwapChain::cleanup()
 {
+	if (headless)
+	{
+		destroyHeadlessImages();
+		return;
+	}
 	if (swapChain != VK_NULL_HANDLE)
 	{
 		for (uint32_t i = 0; i < imageCount; i++)
@@ -38,7 +38,14 @@ private:
 	VkInstance instance;
 	VkDevice device;
 	VkPhysicalDevice physicalDevice;
-	VkSurfaceKHR surface;
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	// Headless mode renders into an image ring owned by this class instead of presentable images
+	bool headless = false;
+	VkQueue headlessQueue = VK_NULL_HANDLE;
+	std::vector<VkDeviceMemory> headlessMemory;
+	uint32_t headlessImageIndex = 0;
+	void createHeadlessImages(uint32_t width, uint32_t height);
+	void destroyHeadlessImages();
 public:
 	VkFormat colorFormat;
 	VkColorSpaceKHR colorSpace;
@@ -68,6 +75,8 @@ public:
 #elif defined(VK_USE_PLATFORM_SCREEN_QNX)
 	void initSurface(screen_context_t screen_context, screen_window_t screen_window);
 #endif
+	void initHeadless(VkQueue queue, uint32_t queueFamilyIndex, VkFormat format);
+	bool isHeadless() const { return headless; }
 	void connect(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device);
 	void create(uint32_t* width, uint32_t* height, bool vsync = false, bool fullscreen = false);
 	VkResult acquireNextImage(VkSemaphore presentCompleteSemaphore, uint32_t* imageIndex);
@@ -35,6 +35,8 @@ class Texture
 	VkImage               image;
 	VkImageLayout         imageLayout;
 	VkDeviceMemory        deviceMemory;
+	/** @brief Sub-allocated image memory, deviceMemory is left for textures that allocate their own memory */
+	vks::Allocation       allocation;
 	VkImageView           view;
 	uint32_t              width, height;
 	uint32_t              mipLevels;
@@ -0,0 +1,179 @@
+/*
+* CPU trace markers
+*
+* Records scoped CPU events per thread and writes them in the Chrome trace event format (chrome://tracing, ui.perfetto.dev)
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include "VulkanTrace.h"
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vks
+{
+	namespace trace
+	{
+		namespace detail
+		{
+			std::atomic<bool> enabled{ false };
+		}
+
+		namespace
+		{
+			struct Event {
+				const char* name;
+				uint64_t start;
+				uint64_t duration;
+				std::string detail;
+			};
+
+			// Events are only ever appended by the owning thread and published with the release store of count,
+			// so recording never takes a lock and save() can read all published events at any time
+			struct Chunk {
+				static const size_t capacity = 1024;
+				std::array<Event, capacity> events;
+				std::atomic<size_t> count{ 0 };
+				std::atomic<Chunk*> next{ nullptr };
+			};
+
+			struct ThreadBuffer {
+				uint32_t threadId;
+				// Guarded by Registry::mutex
+				std::string name;
+				Chunk head;
+				// Only accessed by the owning thread
+				Chunk* tail = &head;
+
+				explicit ThreadBuffer(uint32_t threadId) : threadId(threadId), name("thread " + std::to_string(threadId)) {}
+				~ThreadBuffer() {
+					Chunk* chunk = head.next.load();
+					while (chunk) {
+						Chunk* next = chunk->next.load();
+						delete chunk;
+						chunk = next;
+					}
+				}
+
+				void add(Event&& event) {
+					size_t index = tail->count.load(std::memory_order_relaxed);
+					if (index == Chunk::capacity) {
+						Chunk* chunk = new Chunk();
+						tail->next.store(chunk, std::memory_order_release);
+						tail = chunk;
+						index = 0;
+					}
+					tail->events[index] = std::move(event);
+					tail->count.store(index + 1, std::memory_order_release);
+				}
+			};
+
+			// Thread buffers are registered once per thread and live until the end of the process, so events of finished threads are kept
+			struct Registry {
+				std::mutex mutex;
+				std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+			};
+
+			Registry& getRegistry()
+			{
+				static Registry registry;
+				return registry;
+			}
+
+			const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+			ThreadBuffer& getThreadBuffer()
+			{
+				thread_local ThreadBuffer* buffer = nullptr;
+				if (!buffer) {
+					Registry& registry = getRegistry();
+					std::lock_guard<std::mutex> lock(registry.mutex);
+					registry.buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer(static_cast<uint32_t>(registry.buffers.size()))));
+					buffer = registry.buffers.back().get();
+				}
+				return *buffer;
+			}
+
+			std::string escape(const std::string& value)
+			{
+				std::string escaped;
+				for (const char c : value) {
+					switch (c) {
+					case '"': escaped += "\\\""; break;
+					case '\\': escaped += "\\\\"; break;
+					case '\n': escaped += "\\n"; break;
+					case '\t': escaped += "\\t"; break;
+					default:
+						if (static_cast<unsigned char>(c) >= 0x20) {
+							escaped += c;
+						}
+					}
+				}
+				return escaped;
+			}
+		}
+
+		void enable()
+		{
+			detail::enabled.store(true);
+		}
+
+		void setThreadName(const std::string& name)
+		{
+			if (!isEnabled()) {
+				return;
+			}
+			ThreadBuffer& buffer = getThreadBuffer();
+			std::lock_guard<std::mutex> lock(getRegistry().mutex);
+			buffer.name = name;
+		}
+
+		uint64_t Scope::now()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+		}
+
+		void Scope::end()
+		{
+			const uint64_t duration = now() - start;
+			getThreadBuffer().add({ name, start, duration, std::move(detail) });
+		}
+
+		bool save(const std::string& filename, const std::string& processName)
+		{
+			std::ofstream file(filename, std::ios::out);
+			if (!file.is_open()) {
+				return false;
+			}
+			// Timestamps are in microseconds
+			file << std::fixed << std::setprecision(3);
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"" << escape(processName) << "\"}}";
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			for (const auto& buffer : registry.buffers) {
+				file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":\"" << escape(buffer->name) << "\"}}";
+				for (const Chunk* chunk = &buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+					const size_t count = chunk->count.load(std::memory_order_acquire);
+					for (size_t i = 0; i < count; i++) {
+						const Event& event = chunk->events[i];
+						file << ",\n{\"name\":\"" << escape(event.name) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId;
+						file << ",\"ts\":" << static_cast<double>(event.start) / 1000.0 << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0;
+						if (!event.detail.empty()) {
+							file << ",\"args\":{\"detail\":\"" << escape(event.detail) << "\"}";
+						}
+						file << "}";
+					}
+				}
+			}
+			file << "\n]}\n";
+			return true;
+		}
+	}
+}
@@ -0,0 +1,68 @@
+/*
+* CPU trace markers
+*
+* Records scoped CPU events per thread and writes them in the Chrome trace event format (chrome://tracing, ui.perfetto.dev)
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+namespace vks
+{
+	namespace trace
+	{
+		namespace detail
+		{
+			extern std::atomic<bool> enabled;
+		}
+
+		/** @brief Starts recording events, nothing is recorded (or allocated) before this is called */
+		void enable();
+		inline bool isEnabled() { return detail::enabled.load(std::memory_order_relaxed); }
+		/** @brief Names the calling thread in the trace, threads without a name show up as "thread <id>" */
+		void setThreadName(const std::string& name);
+		/** @brief Writes all events recorded so far as Chrome trace event JSON, can be called while other threads are still recording */
+		bool save(const std::string& filename, const std::string& processName);
+
+		/**
+		* @brief Records a complete event from construction to destruction on the calling thread
+		* @note The name has to be a string literal (or otherwise outlive the trace), per call information goes into setDetail()
+		*/
+		class Scope
+		{
+		public:
+			explicit Scope(const char* name) : name(isEnabled() ? name : nullptr) {
+				if (this->name) {
+					start = now();
+				}
+			}
+			~Scope() {
+				if (name) {
+					end();
+				}
+			}
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+			bool active() const { return name != nullptr; }
+			/** @brief Shown in the event's arguments, e.g. a file name */
+			void setDetail(const std::string& detail) { this->detail = detail; }
+		private:
+			const char* name;
+			uint64_t start = 0;
+			std::string detail;
+			static uint64_t now();
+			void end();
+		};
+	}
+}
+
+#define VKS_TRACE_CONCAT_INNER(a, b) a##b
+#define VKS_TRACE_CONCAT(a, b) VKS_TRACE_CONCAT_INNER(a, b)
+// Traces the rest of the enclosing block
+#define VKS_TRACE_SCOPE(name) vks::trace::Scope VKS_TRACE_CONCAT(traceScope, __LINE__)(name)
+// Same as VKS_TRACE_SCOPE, the detail expression is only evaluated if tracing is enabled
+#define VKS_TRACE_SCOPE_DETAIL(name, detail) vks::trace::Scope VKS_TRACE_CONCAT(traceScope, __LINE__)(name); if (VKS_TRACE_CONCAT(traceScope, __LINE__).active()) VKS_TRACE_CONCAT(traceScope, __LINE__).setDetail(detail)
@@ -39,10 +39,16 @@ namespace vks
 		VkSampleCountFlagBits rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 		uint32_t subpass = 0;
 
-		vks::Buffer vertexBuffer;
-		vks::Buffer indexBuffer;
-		int32_t vertexCount = 0;
-		int32_t indexCount = 0;
+		// Geometry buffers are kept per frame in flight, so the overlay of a frame that is still executing on the GPU is not overwritten
+		struct GeometryBuffers {
+			vks::Buffer vertexBuffer;
+			vks::Buffer indexBuffer;
+			int32_t vertexCount = 0;
+			int32_t indexCount = 0;
+		};
+		std::vector<GeometryBuffers> geometryBuffers{ 1 };
+		// Index of the geometry buffers used by update() and draw()
+		uint32_t frameIndex = 0;
 
 		std::vector<VkPipelineShaderStageCreateInfo> shaders;
 
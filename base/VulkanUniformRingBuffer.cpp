@@ -0,0 +1,73 @@
+/*
+* Vulkan uniform ring buffer class
+*
+* Persistently mapped host visible buffer partitioned into one region per frame in flight
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include "VulkanUniformRingBuffer.h"
+
+namespace vks
+{
+	/**
+	* Create the buffer and map it for the lifetime of the ring buffer
+	*
+	* @param device Device used to create the buffer
+	* @param frameSize Number of bytes that can be allocated per frame, including the padding for offset alignment
+	* @param frameCount Number of frames in flight
+	*/
+	void UniformRingBuffer::create(vks::VulkanDevice* device, VkDeviceSize frameSize, uint32_t frameCount)
+	{
+		alignment = std::max<VkDeviceSize>(device->properties.limits.minUniformBufferOffsetAlignment, 1);
+		this->frameSize = vks::tools::alignedVkSize(frameSize, alignment);
+		VK_CHECK_RESULT(device->createBuffer(
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			&buffer,
+			this->frameSize * frameCount));
+		VK_CHECK_RESULT(buffer.map());
+		frameOffset = 0;
+		head = 0;
+	}
+
+	/**
+	* Release the buffer, the device must not use any allocation anymore
+	*/
+	void UniformRingBuffer::destroy()
+	{
+		buffer.unmap();
+		buffer.destroy();
+		buffer = {};
+	}
+
+	void UniformRingBuffer::beginFrame(uint32_t frameIndex)
+	{
+		frameOffset = frameSize * frameIndex;
+		head = 0;
+	}
+
+	/**
+	* Allocate an aligned range from the current frame's region
+	*
+	* @param size Size of the allocation in bytes
+	*
+	* @return Allocation with a host pointer and the offset to use as dynamic offset
+	*/
+	UniformAllocation UniformRingBuffer::allocate(VkDeviceSize size)
+	{
+		const VkDeviceSize alignedSize = vks::tools::alignedVkSize(size, alignment);
+		assert(head + alignedSize <= frameSize);
+		UniformAllocation allocation;
+		allocation.offset = static_cast<uint32_t>(frameOffset + head);
+		allocation.mapped = static_cast<uint8_t*>(buffer.mapped) + allocation.offset;
+		allocation.size = size;
+		head += alignedSize;
+		return allocation;
+	}
+
+	VkDescriptorBufferInfo UniformRingBuffer::getDescriptor(VkDeviceSize range) const
+	{
+		return { buffer.buffer, 0, range };
+	}
+}
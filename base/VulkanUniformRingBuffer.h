@@ -0,0 +1,61 @@
+/*
+* Vulkan uniform ring buffer class
+*
+* Persistently mapped host visible buffer partitioned into one region per frame in flight
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <assert.h>
+#include <string.h>
+
+#include "vulkan/vulkan.h"
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+
+namespace vks
+{
+	/** @brief Sub-allocation from a uniform ring buffer that is valid for the frame it has been allocated in */
+	struct UniformAllocation
+	{
+		/** @brief Host pointer to the start of the allocation */
+		void* mapped = nullptr;
+		/** @brief Offset into the ring buffer, to be passed as the dynamic offset when binding a descriptor set */
+		uint32_t offset = 0;
+		VkDeviceSize size = 0;
+	};
+
+	/**
+	* @brief Uniform buffer for data that changes every frame
+	* @note Each frame in flight gets its own region, so writing the current frame's data never overwrites data the GPU may still read
+	*/
+	class UniformRingBuffer
+	{
+	public:
+		vks::Buffer buffer;
+
+		void create(vks::VulkanDevice* device, VkDeviceSize frameSize, uint32_t frameCount);
+		void destroy();
+		/** @brief Starts allocating from the region of the given frame in flight, previous allocations from that region become invalid */
+		void beginFrame(uint32_t frameIndex);
+		UniformAllocation allocate(VkDeviceSize size);
+		/** @brief Allocates space for the given data and copies it into the buffer */
+		template<typename T>
+		UniformAllocation push(const T& data)
+		{
+			UniformAllocation allocation = allocate(sizeof(T));
+			memcpy(allocation.mapped, &data, sizeof(T));
+			return allocation;
+		}
+		/** @brief Descriptor for a UNIFORM_BUFFER_DYNAMIC binding, the actual location is selected with the dynamic offset of an allocation */
+		VkDescriptorBufferInfo getDescriptor(VkDeviceSize range) const;
+		bool isCreated() const { return buffer.buffer != VK_NULL_HANDLE; }
+	private:
+		VkDeviceSize alignment = 1;
+		VkDeviceSize frameSize = 0;
+		VkDeviceSize frameOffset = 0;
+		VkDeviceSize head = 0;
+	};
+}
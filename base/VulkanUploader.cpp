@@ -0,0 +1,347 @@
+/*
+* Vulkan upload manager
+*
+* Batches buffer and image uploads from a persistently mapped staging ring into submissions on the transfer queue
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#include <string.h>
+
+#include "VulkanUploader.h"
+#include "VulkanDevice.h"
+
+namespace vks
+{
+	/**
+	* Create the staging ring, the timeline semaphore and the command pools
+	*
+	* @param device Device with the VK_KHR_timeline_semaphore extension and timelineSemaphore feature enabled
+	* @param graphicsQueue Queue of the graphics queue family that consumes the uploads
+	* @param stagingSize Size of the staging ring in bytes
+	*/
+	void Uploader::create(vks::VulkanDevice* device, VkQueue graphicsQueue, VkDeviceSize stagingSize)
+	{
+		this->device = device;
+		this->graphicsQueue = graphicsQueue;
+		graphicsFamily = device->queueFamilyIndices.graphics;
+		transferFamily = device->queueFamilyIndices.transfer;
+		ownershipTransfer = transferFamily != graphicsFamily;
+		vkGetDeviceQueue(device->logicalDevice, transferFamily, 0, &transferQueue);
+
+		transferCommandPool = device->createCommandPool(transferFamily);
+		if (ownershipTransfer) {
+			graphicsCommandPool = device->createCommandPool(graphicsFamily);
+		}
+
+		vkWaitSemaphoresKHR = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(device->logicalDevice, "vkWaitSemaphoresKHR"));
+		vkGetSemaphoreCounterValueKHR = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(device->logicalDevice, "vkGetSemaphoreCounterValueKHR"));
+		VkSemaphoreTypeCreateInfoKHR semaphoreTypeCI{};
+		semaphoreTypeCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+		semaphoreTypeCI.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+		semaphoreTypeCI.initialValue = 0;
+		VkSemaphoreCreateInfo semaphoreCI = vks::initializers::semaphoreCreateInfo();
+		semaphoreCI.pNext = &semaphoreTypeCI;
+		VK_CHECK_RESULT(vkCreateSemaphore(device->logicalDevice, &semaphoreCI, nullptr, &semaphore));
+		timelineValue = 0;
+
+		// Copy offsets have to be a multiple of 4 and of the texel block size, which is at most 16 bytes
+		stagingAlignment = std::max<VkDeviceSize>(device->properties.limits.optimalBufferCopyOffsetAlignment, 16);
+		this->stagingSize = vks::tools::alignedVkSize(stagingSize, stagingAlignment);
+		VK_CHECK_RESULT(device->createBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, this->stagingSize, &stagingBuffer, &stagingAllocation, nullptr, vks::MemoryAllocator::Strategy::Linear));
+		// Host visible memory of the allocator stays mapped
+		stagingMapped = static_cast<uint8_t*>(stagingAllocation.mapped);
+		head = 0;
+		tail = 0;
+		batchDepth = 0;
+	}
+
+	void Uploader::destroy()
+	{
+		wait(submit());
+		vkDestroyBuffer(device->logicalDevice, stagingBuffer, nullptr);
+		device->memoryAllocator.free(stagingAllocation);
+		stagingBuffer = VK_NULL_HANDLE;
+		stagingMapped = nullptr;
+		vkDestroySemaphore(device->logicalDevice, semaphore, nullptr);
+		semaphore = VK_NULL_HANDLE;
+		vkDestroyCommandPool(device->logicalDevice, transferCommandPool, nullptr);
+		if (graphicsCommandPool != VK_NULL_HANDLE) {
+			vkDestroyCommandPool(device->logicalDevice, graphicsCommandPool, nullptr);
+			graphicsCommandPool = VK_NULL_HANDLE;
+		}
+		transferCommandPool = VK_NULL_HANDLE;
+	}
+
+	void Uploader::beginBatch()
+	{
+		batchDepth++;
+	}
+
+	uint64_t Uploader::endBatch()
+	{
+		assert(batchDepth > 0);
+		if (--batchDepth > 0) {
+			return 0;
+		}
+		return submit();
+	}
+
+	void Uploader::uploadBuffer(VkBuffer buffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset, VkAccessFlags dstAccess)
+	{
+		// Staging may have to submit the pending uploads to free ring space, so it has to happen before recording
+		VkBuffer srcBuffer;
+		VkDeviceSize srcOffset;
+		stage(data, size, &srcBuffer, &srcOffset);
+
+		VkCommandBuffer commandBuffer = getTransferCommandBuffer();
+		VkBufferCopy copyRegion{ srcOffset, dstOffset, size };
+		vkCmdCopyBuffer(commandBuffer, srcBuffer, buffer, 1, &copyRegion);
+
+		VkBufferMemoryBarrier barrier = vks::initializers::bufferMemoryBarrier();
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = dstAccess;
+		barrier.buffer = buffer;
+		barrier.offset = dstOffset;
+		barrier.size = size;
+		addBarriers(barrier);
+	}
+
+	void Uploader::uploadImage(VkImage image, const void* data, VkDeviceSize size, const std::vector<VkBufferImageCopy>& regions, const VkImageSubresourceRange& subresourceRange, VkImageLayout finalLayout, VkAccessFlags dstAccess)
+	{
+		VkBuffer srcBuffer;
+		VkDeviceSize srcOffset;
+		stage(data, size, &srcBuffer, &srcOffset);
+
+		VkCommandBuffer commandBuffer = getTransferCommandBuffer();
+		VkImageMemoryBarrier barrier = vks::initializers::imageMemoryBarrier();
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.image = image;
+		barrier.subresourceRange = subresourceRange;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		std::vector<VkBufferImageCopy> stagingRegions = regions;
+		for (VkBufferImageCopy& region : stagingRegions) {
+			region.bufferOffset += srcOffset;
+		}
+		vkCmdCopyBufferToImage(commandBuffer, srcBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(stagingRegions.size()), stagingRegions.data());
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = finalLayout;
+		addBarriers(barrier);
+	}
+
+	/**
+	* Submit the pending uploads to the transfer queue, followed by the ownership acquire on the graphics queue
+	*
+	* @return Timeline value signalled once the uploads are visible on the graphics queue, the value of the last submission if nothing is pending
+	*/
+	uint64_t Uploader::submit()
+	{
+		if (pending.transferCommandBuffer == VK_NULL_HANDLE) {
+			return timelineValue;
+		}
+
+		// The same family: the barriers make the copies visible to all later commands, otherwise they release ownership
+		const VkPipelineStageFlags releaseDstStage = ownershipTransfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		vkCmdPipelineBarrier(pending.transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, releaseDstStage, 0, 0, nullptr,
+			static_cast<uint32_t>(releaseBufferBarriers.size()), releaseBufferBarriers.data(),
+			static_cast<uint32_t>(releaseImageBarriers.size()), releaseImageBarriers.data());
+		VK_CHECK_RESULT(vkEndCommandBuffer(pending.transferCommandBuffer));
+		pending.stagingEnd = head;
+
+		const uint64_t transferValue = ++timelineValue;
+		VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo{};
+		timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineSubmitInfo.signalSemaphoreValueCount = 1;
+		timelineSubmitInfo.pSignalSemaphoreValues = &transferValue;
+		VkSubmitInfo submitInfo = vks::initializers::submitInfo();
+		submitInfo.pNext = &timelineSubmitInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &pending.transferCommandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &semaphore;
+		VK_CHECK_RESULT(vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+		if (ownershipTransfer) {
+			VkCommandBufferAllocateInfo allocateInfo = vks::initializers::commandBufferAllocateInfo(graphicsCommandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(device->logicalDevice, &allocateInfo, &pending.acquireCommandBuffer));
+			VkCommandBufferBeginInfo beginInfo = vks::initializers::commandBufferBeginInfo();
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(pending.acquireCommandBuffer, &beginInfo));
+			vkCmdPipelineBarrier(pending.acquireCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+				static_cast<uint32_t>(acquireBufferBarriers.size()), acquireBufferBarriers.data(),
+				static_cast<uint32_t>(acquireImageBarriers.size()), acquireImageBarriers.data());
+			VK_CHECK_RESULT(vkEndCommandBuffer(pending.acquireCommandBuffer));
+
+			const uint64_t acquireValue = ++timelineValue;
+			VkTimelineSemaphoreSubmitInfoKHR acquireTimelineInfo{};
+			acquireTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+			acquireTimelineInfo.waitSemaphoreValueCount = 1;
+			acquireTimelineInfo.pWaitSemaphoreValues = &transferValue;
+			acquireTimelineInfo.signalSemaphoreValueCount = 1;
+			acquireTimelineInfo.pSignalSemaphoreValues = &acquireValue;
+			const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			VkSubmitInfo acquireSubmitInfo = vks::initializers::submitInfo();
+			acquireSubmitInfo.pNext = &acquireTimelineInfo;
+			acquireSubmitInfo.waitSemaphoreCount = 1;
+			acquireSubmitInfo.pWaitSemaphores = &semaphore;
+			acquireSubmitInfo.pWaitDstStageMask = &waitStage;
+			acquireSubmitInfo.commandBufferCount = 1;
+			acquireSubmitInfo.pCommandBuffers = &pending.acquireCommandBuffer;
+			acquireSubmitInfo.signalSemaphoreCount = 1;
+			acquireSubmitInfo.pSignalSemaphores = &semaphore;
+			VK_CHECK_RESULT(vkQueueSubmit(graphicsQueue, 1, &acquireSubmitInfo, VK_NULL_HANDLE));
+		}
+
+		pending.value = timelineValue;
+		inFlight.push_back(std::move(pending));
+		pending = Batch();
+		releaseBufferBarriers.clear();
+		releaseImageBarriers.clear();
+		acquireBufferBarriers.clear();
+		acquireImageBarriers.clear();
+		collect();
+		return timelineValue;
+	}
+
+	void Uploader::wait(uint64_t value)
+	{
+		if (value == 0) {
+			return;
+		}
+		// Waiting for uploads that haven't been submitted would never return
+		assert(value <= timelineValue);
+		VkSemaphoreWaitInfoKHR waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &semaphore;
+		waitInfo.pValues = &value;
+		VK_CHECK_RESULT(vkWaitSemaphoresKHR(device->logicalDevice, &waitInfo, UINT64_MAX));
+		collect();
+	}
+
+	bool Uploader::isComplete(uint64_t value)
+	{
+		uint64_t completedValue = 0;
+		VK_CHECK_RESULT(vkGetSemaphoreCounterValueKHR(device->logicalDevice, semaphore, &completedValue));
+		return completedValue >= value;
+	}
+
+	/**
+	* Copy data into staging memory, from the ring or, if it doesn't fit into the ring, from a staging buffer that is freed with the batch
+	*
+	* @note Waits for the oldest submission if the ring is full, submitting the pending uploads first if only they occupy the ring
+	*/
+	void Uploader::stage(const void* data, VkDeviceSize size, VkBuffer* buffer, VkDeviceSize* offset)
+	{
+		if (size > stagingSize) {
+			std::pair<VkBuffer, vks::Allocation> dedicated;
+			VK_CHECK_RESULT(device->createBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, size, &dedicated.first, &dedicated.second, const_cast<void*>(data), vks::MemoryAllocator::Strategy::Linear));
+			pending.dedicatedStaging.push_back(dedicated);
+			*buffer = dedicated.first;
+			*offset = 0;
+			return;
+		}
+
+		for (;;) {
+			// An empty ring starts over at its beginning
+			if (head == tail) {
+				head = tail = (head + stagingSize - 1) / stagingSize * stagingSize;
+			}
+			VkDeviceSize start = vks::tools::alignedVkSize(head, stagingAlignment);
+			// Data is never split at the end of the ring, the rest of the ring is skipped instead
+			if (start % stagingSize + size > stagingSize) {
+				start = (start + stagingSize - 1) / stagingSize * stagingSize;
+			}
+			if (start + size - tail <= stagingSize) {
+				head = start + size;
+				*buffer = stagingBuffer;
+				*offset = start % stagingSize;
+				memcpy(stagingMapped + *offset, data, size);
+				return;
+			}
+			if (inFlight.empty()) {
+				submit();
+			}
+			wait(inFlight.front().value);
+		}
+	}
+
+	VkCommandBuffer Uploader::getTransferCommandBuffer()
+	{
+		if (pending.transferCommandBuffer == VK_NULL_HANDLE) {
+			VkCommandBufferAllocateInfo allocateInfo = vks::initializers::commandBufferAllocateInfo(transferCommandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+			VK_CHECK_RESULT(vkAllocateCommandBuffers(device->logicalDevice, &allocateInfo, &pending.transferCommandBuffer));
+			VkCommandBufferBeginInfo beginInfo = vks::initializers::commandBufferBeginInfo();
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			VK_CHECK_RESULT(vkBeginCommandBuffer(pending.transferCommandBuffer, &beginInfo));
+		}
+		return pending.transferCommandBuffer;
+	}
+
+	/**
+	* Add the barriers that finish an upload, either a barrier making the copy visible or the release and acquire pair of a queue family ownership transfer
+	*
+	* @param bufferBarrier Barrier from the copy to the consuming accesses
+	*/
+	void Uploader::addBarriers(VkBufferMemoryBarrier bufferBarrier)
+	{
+		if (!ownershipTransfer) {
+			releaseBufferBarriers.push_back(bufferBarrier);
+			return;
+		}
+		bufferBarrier.srcQueueFamilyIndex = transferFamily;
+		bufferBarrier.dstQueueFamilyIndex = graphicsFamily;
+		// Access masks of the other queue family are ignored
+		VkBufferMemoryBarrier acquireBarrier = bufferBarrier;
+		bufferBarrier.dstAccessMask = 0;
+		acquireBarrier.srcAccessMask = 0;
+		releaseBufferBarriers.push_back(bufferBarrier);
+		acquireBufferBarriers.push_back(acquireBarrier);
+	}
+
+	void Uploader::addBarriers(VkImageMemoryBarrier imageBarrier)
+	{
+		if (!ownershipTransfer) {
+			releaseImageBarriers.push_back(imageBarrier);
+			return;
+		}
+		// The layout transition is part of the ownership transfer, both barriers have to specify it
+		imageBarrier.srcQueueFamilyIndex = transferFamily;
+		imageBarrier.dstQueueFamilyIndex = graphicsFamily;
+		VkImageMemoryBarrier acquireBarrier = imageBarrier;
+		imageBarrier.dstAccessMask = 0;
+		acquireBarrier.srcAccessMask = 0;
+		releaseImageBarriers.push_back(imageBarrier);
+		acquireImageBarriers.push_back(acquireBarrier);
+	}
+
+	// Free the command buffers and staging memory of completed submissions
+	void Uploader::collect()
+	{
+		if (inFlight.empty()) {
+			return;
+		}
+		uint64_t completedValue = 0;
+		VK_CHECK_RESULT(vkGetSemaphoreCounterValueKHR(device->logicalDevice, semaphore, &completedValue));
+		while (!inFlight.empty() && inFlight.front().value <= completedValue) {
+			Batch& batch = inFlight.front();
+			vkFreeCommandBuffers(device->logicalDevice, transferCommandPool, 1, &batch.transferCommandBuffer);
+			if (batch.acquireCommandBuffer != VK_NULL_HANDLE) {
+				vkFreeCommandBuffers(device->logicalDevice, graphicsCommandPool, 1, &batch.acquireCommandBuffer);
+			}
+			for (auto& dedicated : batch.dedicatedStaging) {
+				vkDestroyBuffer(device->logicalDevice, dedicated.first, nullptr);
+				device->memoryAllocator.free(dedicated.second);
+			}
+			tail = batch.stagingEnd;
+			inFlight.pop_front();
+		}
+	}
+}
@@ -0,0 +1,113 @@
+/*
+* Vulkan upload manager
+*
+* Batches buffer and image uploads from a persistently mapped staging ring into submissions on the transfer queue
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+#include "VulkanMemoryAllocator.h"
+
+namespace vks
+{
+	struct VulkanDevice;
+
+	/**
+	* @brief Uploads buffer and image data on the transfer queue and signals completion with a timeline semaphore
+	* @note If the transfer queue belongs to another queue family than the graphics queue, ownership is released on the transfer queue and acquired on the graphics queue by the uploader
+	* @note Requires VK_KHR_timeline_semaphore, not thread safe
+	*/
+	class Uploader
+	{
+	public:
+		/** @param stagingSize Size of the staging ring, uploads that don't fit into it get a staging buffer of their own */
+		void create(vks::VulkanDevice* device, VkQueue graphicsQueue, VkDeviceSize stagingSize = 64 * 1024 * 1024);
+		/** @brief Waits for all uploads and releases the uploader's resources */
+		void destroy();
+		bool isCreated() const { return semaphore != VK_NULL_HANDLE; }
+
+		/** @brief Uploads until the matching endBatch() are submitted together, batches can be nested and only the outermost one submits */
+		void beginBatch();
+		/** @return Timeline value signalled once the batch's uploads are visible on the graphics queue, 0 if an enclosing batch is still open */
+		uint64_t endBatch();
+		/** @brief Loaders only record into a batch opened by their caller, who waits for it once all uploads have been recorded */
+		bool isBatchOpen() const { return batchDepth > 0; }
+
+		/**
+		* @brief Copy data into a buffer
+		* @param dstAccess Accesses of the graphics queue the data is made visible to
+		*/
+		void uploadBuffer(VkBuffer buffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset, VkAccessFlags dstAccess);
+		/**
+		* @brief Copy data into an image and transition it from an undefined layout to the final layout
+		* @param regions Copy regions with buffer offsets relative to data
+		* @param subresourceRange Subresources written by the regions, their previous contents are discarded
+		*/
+		void uploadImage(VkImage image, const void* data, VkDeviceSize size, const std::vector<VkBufferImageCopy>& regions, const VkImageSubresourceRange& subresourceRange, VkImageLayout finalLayout, VkAccessFlags dstAccess);
+
+		/** @brief Submit the pending uploads even if a batch is open, e.g. if the graphics queue has to consume them right away */
+		uint64_t submit();
+		/** @brief Host wait for the uploads of a submission, waiting for 0 returns immediately */
+		void wait(uint64_t value);
+		bool isComplete(uint64_t value);
+		/** @brief Timeline semaphore to wait on in graphics queue submissions instead of waiting on the host */
+		VkSemaphore getSemaphore() const { return semaphore; }
+	private:
+		// Uploads recorded into one submission
+		struct Batch {
+			uint64_t value = 0;
+			// End of the batch's data in the staging ring, the ring space up to it is free once the batch has completed
+			VkDeviceSize stagingEnd = 0;
+			VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;
+			VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+			// Staging buffers of uploads that are larger than the ring
+			std::vector<std::pair<VkBuffer, vks::Allocation>> dedicatedStaging;
+		};
+
+		vks::VulkanDevice* device = nullptr;
+		VkQueue transferQueue = VK_NULL_HANDLE;
+		VkQueue graphicsQueue = VK_NULL_HANDLE;
+		uint32_t transferFamily = 0;
+		uint32_t graphicsFamily = 0;
+		bool ownershipTransfer = false;
+		VkCommandPool transferCommandPool = VK_NULL_HANDLE;
+		VkCommandPool graphicsCommandPool = VK_NULL_HANDLE;
+
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		uint64_t timelineValue = 0;
+		PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR = nullptr;
+		PFN_vkGetSemaphoreCounterValueKHR vkGetSemaphoreCounterValueKHR = nullptr;
+
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		vks::Allocation stagingAllocation;
+		uint8_t* stagingMapped = nullptr;
+		VkDeviceSize stagingSize = 0;
+		VkDeviceSize stagingAlignment = 16;
+		// Monotonic positions in the ring, the ring offset is the position modulo the ring size
+		VkDeviceSize head = 0;
+		VkDeviceSize tail = 0;
+
+		uint32_t batchDepth = 0;
+		Batch pending;
+		std::deque<Batch> inFlight;
+		// Barriers recorded at the end of the pending batch, making the copies visible or releasing ownership
+		std::vector<VkBufferMemoryBarrier> releaseBufferBarriers;
+		std::vector<VkImageMemoryBarrier> releaseImageBarriers;
+		// Barriers acquiring ownership on the graphics queue
+		std::vector<VkBufferMemoryBarrier> acquireBufferBarriers;
+		std::vector<VkImageMemoryBarrier> acquireImageBarriers;
+
+		void stage(const void* data, VkDeviceSize size, VkBuffer* buffer, VkDeviceSize* offset);
+		VkCommandBuffer getTransferCommandBuffer();
+		void addBarriers(VkBufferMemoryBarrier bufferBarrier);
+		void addBarriers(VkImageMemoryBarrier imageBarrier);
+		void collect();
+	};
+}
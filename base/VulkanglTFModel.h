@@ -64,6 +64,7 @@ namespace vkglTF
 		VkImage image;
 		VkImageLayout imageLayout;
 		VkDeviceMemory deviceMemory;
+		vks::Allocation allocation;
 		VkImageView view;
 		uint32_t width, height;
 		uint32_t mipLevels;
@@ -136,6 +137,7 @@ namespace vkglTF
 		struct UniformBuffer {
 			VkBuffer buffer;
 			VkDeviceMemory memory;
+			vks::Allocation allocation;
 			VkDescriptorBufferInfo descriptor;
 			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
 			void* mapped;
@@ -267,11 +269,13 @@ namespace vkglTF
 			int count;
 			VkBuffer buffer;
 			VkDeviceMemory memory;
+			vks::Allocation allocation;
 		} vertices;
 		struct Indices {
 			int count;
 			VkBuffer buffer;
 			VkDeviceMemory memory;
+			vks::Allocation allocation;
 		} indices;
 
 		std::vector<Node*> nodes;
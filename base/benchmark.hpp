@@ -13,6 +13,9 @@
 #include <functional>
 #include <chrono>
 #include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <utility>
 
 namespace vks
 {
@@ -20,14 +23,359 @@ namespace vks
 	private:
 		FILE *stream;
 		VkPhysicalDeviceProperties deviceProps;
+
+		// Upper bound for the frame rate used to size the frame time buffers from the duration
+		static const uint32_t maxExpectedFps = 2000;
+		// Number of histogram bins between the fastest and the slowest frame
+		static const uint32_t histogramBins = 20;
+
+		struct Statistics {
+			size_t samples = 0;
+			double min = 0.0;
+			double max = 0.0;
+			double avg = 0.0;
+			double stddev = 0.0;
+			double p50 = 0.0;
+			double p90 = 0.0;
+			double p99 = 0.0;
+			double p999 = 0.0;
+			std::vector<uint32_t> histogram;
+		};
+
+		// Nearest rank percentile of sorted values
+		static double percentile(const std::vector<double>& sorted, double p) {
+			const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * (double)sorted.size()));
+			return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+		}
+
+		static Statistics getStatistics(const std::vector<double>& values) {
+			Statistics stats;
+			stats.samples = values.size();
+			stats.histogram.resize(histogramBins, 0);
+			if (values.empty()) {
+				return stats;
+			}
+			std::vector<double> sorted(values);
+			std::sort(sorted.begin(), sorted.end());
+			stats.min = sorted.front();
+			stats.max = sorted.back();
+			stats.avg = std::accumulate(sorted.begin(), sorted.end(), 0.0) / (double)sorted.size();
+			double variance = 0.0;
+			for (double value : sorted) {
+				variance += (value - stats.avg) * (value - stats.avg);
+			}
+			stats.stddev = std::sqrt(variance / (double)sorted.size());
+			stats.p50 = percentile(sorted, 50.0);
+			stats.p90 = percentile(sorted, 90.0);
+			stats.p99 = percentile(sorted, 99.0);
+			stats.p999 = percentile(sorted, 99.9);
+			const double binWidth = getHistogramBinWidth(stats);
+			for (double value : sorted) {
+				const uint32_t bin = (binWidth > 0.0) ? static_cast<uint32_t>((value - stats.min) / binWidth) : 0;
+				stats.histogram[std::min(bin, histogramBins - 1)]++;
+			}
+			return stats;
+		}
+
+		static double getHistogramBinWidth(const Statistics& stats) {
+			return (stats.max - stats.min) / (double)histogramBins;
+		}
+
+		// Pass times of one frame with profiler results, indexed like passNames
+		const double* getPassRow(size_t row) const {
+			return &passTimes[row * maxPasses];
+		}
+
+		// Total GPU time of each frame with profiler results
+		std::vector<double> getGpuFrameTimes() const {
+			std::vector<double> gpuTimes;
+			gpuTimes.reserve(passRowCount);
+			for (size_t i = 0; i < passRowCount; i++) {
+				gpuTimes.push_back(std::accumulate(getPassRow(i), getPassRow(i) + passNames.size(), 0.0));
+			}
+			return gpuTimes;
+		}
+
+		static void printStatistics(const std::string& name, const Statistics& stats) {
+			std::cout << name << " p50: " << stats.p50 << " ms, p90: " << stats.p90 << " ms, p99: " << stats.p99 << " ms, p99.9: " << stats.p999 << " ms, stddev: " << stats.stddev << " ms" << "\n";
+		}
+
+		static void writeStatisticsCSV(std::ostream& out, const std::string& name, const Statistics& stats) {
+			out << name << "," << stats.samples << "," << stats.min << "," << stats.max << "," << stats.avg << "," << stats.stddev << "," << stats.p50 << "," << stats.p90 << "," << stats.p99 << "," << stats.p999 << "\n";
+		}
+
+		static std::string escapeJSON(const std::string& value) {
+			std::string escaped;
+			for (char c : value) {
+				if ((c == '"') || (c == '\\')) {
+					escaped += '\\';
+				}
+				if (static_cast<unsigned char>(c) >= 0x20) {
+					escaped += c;
+				}
+			}
+			return escaped;
+		}
+
+		static void writeStatisticsJSON(std::ostream& out, const Statistics& stats) {
+			out << "{ \"samples\": " << stats.samples << ", \"min\": " << stats.min << ", \"max\": " << stats.max << ", \"avg\": " << stats.avg << ", \"stddev\": " << stats.stddev;
+			out << ", \"p50\": " << stats.p50 << ", \"p90\": " << stats.p90 << ", \"p99\": " << stats.p99 << ", \"p99_9\": " << stats.p999;
+			out << ", \"histogram\": { \"min\": " << stats.min << ", \"binWidth\": " << getHistogramBinWidth(stats) << ", \"counts\": [";
+			for (size_t i = 0; i < stats.histogram.size(); i++) {
+				out << (i > 0 ? ", " : "") << stats.histogram[i];
+			}
+			out << "] } }";
+		}
+
+		static void writeValuesJSON(std::ostream& out, const std::vector<double>& values) {
+			out << "[";
+			for (size_t i = 0; i < values.size(); i++) {
+				out << (i > 0 ? ", " : "") << values[i];
+			}
+			out << "]";
+		}
+
+		// Average GPU time of each pass over all frames with profiler results
+		std::vector<double> getPassAverages() const {
+			std::vector<double> passAverages(passNames.size(), 0.0);
+			for (size_t i = 0; i < passRowCount; i++) {
+				const double* row = getPassRow(i);
+				for (size_t j = 0; j < passNames.size(); j++) {
+					passAverages[j] += row[j] / (double)passRowCount;
+				}
+			}
+			return passAverages;
+		}
+
+		// Summary of one configuration of a parameter sweep
+		struct SweepResult {
+			std::vector<std::pair<std::string, std::string>> parameters;
+			uint32_t width;
+			uint32_t height;
+			double runtime;
+			uint32_t frameCount;
+			Statistics frameStats;
+			Statistics cpuStats;
+			Statistics gpuStats;
+			// Indexed like passNames, passes that first appeared in a later configuration are missing at the end
+			std::vector<double> passAverages;
+		};
+		std::vector<SweepResult> sweepResults;
+
+		// Union of the parameter names of all sweep configurations in order of appearance
+		std::vector<std::string> getSweepParameterNames() const {
+			std::vector<std::string> names;
+			for (const auto& sweepResult : sweepResults) {
+				for (const auto& parameter : sweepResult.parameters) {
+					if (std::find(names.begin(), names.end(), parameter.first) == names.end()) {
+						names.push_back(parameter.first);
+					}
+				}
+			}
+			return names;
+		}
+
+		static std::string getSweepParameter(const SweepResult& sweepResult, const std::string& name) {
+			for (const auto& parameter : sweepResult.parameters) {
+				if (parameter.first == name) {
+					return parameter.second;
+				}
+			}
+			return "";
+		}
+
+		void saveSweepResultsCSV(std::ostream& result) {
+			const std::vector<std::string> parameterNames = getSweepParameterNames();
+			result << "device,driverversion";
+			for (const auto& name : parameterNames) {
+				result << "," << name;
+			}
+			result << ",width,height,duration (ms),frames,fps,frame avg (ms),frame p50 (ms),frame p90 (ms),frame p99 (ms),frame p99.9 (ms),cpu avg (ms),gpu avg (ms)";
+			for (const auto& name : passNames) {
+				result << "," << name << " (ms)";
+			}
+			result << "\n";
+			for (const auto& sweepResult : sweepResults) {
+				result << deviceProps.deviceName << "," << deviceProps.driverVersion;
+				for (const auto& name : parameterNames) {
+					result << "," << getSweepParameter(sweepResult, name);
+				}
+				result << "," << sweepResult.width << "," << sweepResult.height << "," << sweepResult.runtime << "," << sweepResult.frameCount << "," << sweepResult.frameCount / (sweepResult.runtime / 1000.0);
+				const Statistics& frameStats = sweepResult.frameStats;
+				result << "," << frameStats.avg << "," << frameStats.p50 << "," << frameStats.p90 << "," << frameStats.p99 << "," << frameStats.p999;
+				result << "," << sweepResult.cpuStats.avg << "," << sweepResult.gpuStats.avg;
+				for (size_t i = 0; i < passNames.size(); i++) {
+					result << "," << (i < sweepResult.passAverages.size() ? sweepResult.passAverages[i] : 0.0);
+				}
+				result << "\n";
+			}
+		}
+
+		void saveSweepResultsJSON(std::ostream& result) {
+			result << "{\n";
+			result << "  \"device\": { \"name\": \"" << escapeJSON(deviceProps.deviceName) << "\", \"vendorID\": " << deviceProps.vendorID << ", \"deviceID\": " << deviceProps.deviceID << ", \"driverVersion\": " << deviceProps.driverVersion << " },\n";
+			result << "  \"configurations\": [";
+			for (size_t i = 0; i < sweepResults.size(); i++) {
+				const SweepResult& sweepResult = sweepResults[i];
+				result << (i > 0 ? "," : "") << "\n    {\n";
+				result << "      \"parameters\": {";
+				for (size_t j = 0; j < sweepResult.parameters.size(); j++) {
+					result << (j > 0 ? ", " : " ") << "\"" << escapeJSON(sweepResult.parameters[j].first) << "\": \"" << escapeJSON(sweepResult.parameters[j].second) << "\"";
+				}
+				result << " },\n";
+				result << "      \"width\": " << sweepResult.width << ", \"height\": " << sweepResult.height << ",\n";
+				result << "      \"duration\": " << sweepResult.runtime << ", \"frames\": " << sweepResult.frameCount << ", \"fps\": " << sweepResult.frameCount / (sweepResult.runtime / 1000.0) << ",\n";
+				result << "      \"frameTime\": "; writeStatisticsJSON(result, sweepResult.frameStats); result << ",\n";
+				result << "      \"cpuTime\": "; writeStatisticsJSON(result, sweepResult.cpuStats); result << ",\n";
+				result << "      \"gpuTime\": "; writeStatisticsJSON(result, sweepResult.gpuStats); result << ",\n";
+				result << "      \"passes\": {";
+				for (size_t j = 0; j < std::min(passNames.size(), sweepResult.passAverages.size()); j++) {
+					result << (j > 0 ? ", " : " ") << "\"" << escapeJSON(passNames[j]) << "\": " << sweepResult.passAverages[j];
+				}
+				result << " }\n";
+				result << "    }";
+			}
+			result << "\n  ]\n}\n";
+		}
+
+		bool isJSONFile() const {
+			return (filename.size() >= 5) && (filename.compare(filename.size() - 5, 5, ".json") == 0);
+		}
+
+		// Frame times of each camera path segment
+		std::vector<Statistics> getSegmentStatistics() const {
+			std::vector<std::vector<double>> segmentTimes(segmentNames.size());
+			for (size_t i = 0; i < std::min(frameTimes.size(), frameSegments.size()); i++) {
+				segmentTimes[frameSegments[i]].push_back(frameTimes[i]);
+			}
+			std::vector<Statistics> segmentStats;
+			for (const auto& times : segmentTimes) {
+				segmentStats.push_back(getStatistics(times));
+			}
+			return segmentStats;
+		}
+
+		void saveResultsCSV(std::ostream& result, const Statistics& frameStats, const Statistics& cpuStats, const Statistics& gpuStats, const std::vector<double>& passAverages) {
+			result << "device,driverversion,duration (ms),frames,fps";
+			for (const auto& name : passNames) {
+				result << "," << name << " (ms)";
+			}
+			result << "\n";
+			result << deviceProps.deviceName << "," << deviceProps.driverVersion << "," << runtime << "," << frameCount << "," << frameCount / (runtime / 1000.0);
+			for (double average : passAverages) {
+				result << "," << average;
+			}
+			result << "\n";
+
+			result << "\n" << "timing,samples,min (ms),max (ms),avg (ms),stddev (ms),p50 (ms),p90 (ms),p99 (ms),p99.9 (ms)" << "\n";
+			writeStatisticsCSV(result, "frame", frameStats);
+			writeStatisticsCSV(result, "cpu", cpuStats);
+			writeStatisticsCSV(result, "gpu", gpuStats);
+
+			if (!segmentNames.empty()) {
+				const std::vector<Statistics> segmentStats = getSegmentStatistics();
+				result << "\n" << "segment,samples,min (ms),max (ms),avg (ms),stddev (ms),p50 (ms),p90 (ms),p99 (ms),p99.9 (ms)" << "\n";
+				for (size_t i = 0; i < segmentNames.size(); i++) {
+					writeStatisticsCSV(result, segmentNames[i], segmentStats[i]);
+				}
+			}
+
+			result << "\n" << "histogram bin start (ms),frames" << "\n";
+			for (uint32_t i = 0; i < histogramBins; i++) {
+				result << frameStats.min + getHistogramBinWidth(frameStats) * i << "," << frameStats.histogram[i] << "\n";
+			}
+
+			if (outputFrameTimes) {
+				result << "\n" << "frame,ms,cpu ms" << "\n";
+				for (size_t i = 0; i < frameTimes.size(); i++) {
+					result << i << "," << frameTimes[i] << "," << (i < cpuTimes.size() ? cpuTimes[i] : 0.0) << "\n";
+				}
+				// GPU results arrive a few frames after their CPU frame, so they are listed separately
+				if (passRowCount > 0) {
+					result << "\n" << "gpu frame";
+					for (const auto& name : passNames) {
+						result << "," << name << " (ms)";
+					}
+					result << "\n";
+					for (size_t i = 0; i < passRowCount; i++) {
+						const double* row = getPassRow(i);
+						result << i;
+						for (size_t j = 0; j < passNames.size(); j++) {
+							result << "," << row[j];
+						}
+						result << "\n";
+					}
+				}
+			}
+		}
+
+		void saveResultsJSON(std::ostream& result, const Statistics& frameStats, const Statistics& cpuStats, const Statistics& gpuStats, const std::vector<double>& passAverages) {
+			result << "{\n";
+			result << "  \"device\": {\n";
+			result << "    \"name\": \"" << escapeJSON(deviceProps.deviceName) << "\",\n";
+			result << "    \"vendorID\": " << deviceProps.vendorID << ",\n";
+			result << "    \"deviceID\": " << deviceProps.deviceID << ",\n";
+			result << "    \"deviceType\": \"" << vks::tools::physicalDeviceTypeString(deviceProps.deviceType) << "\",\n";
+			result << "    \"driverVersion\": " << deviceProps.driverVersion << ",\n";
+			result << "    \"apiVersion\": \"" << VK_API_VERSION_MAJOR(deviceProps.apiVersion) << "." << VK_API_VERSION_MINOR(deviceProps.apiVersion) << "." << VK_API_VERSION_PATCH(deviceProps.apiVersion) << "\",\n";
+			result << "    \"timestampPeriod\": " << deviceProps.limits.timestampPeriod << "\n";
+			result << "  },\n";
+			result << "  \"duration\": " << runtime << ",\n";
+			result << "  \"frames\": " << frameCount << ",\n";
+			result << "  \"fps\": " << frameCount / (runtime / 1000.0) << ",\n";
+			result << "  \"frameTime\": "; writeStatisticsJSON(result, frameStats); result << ",\n";
+			result << "  \"cpuTime\": "; writeStatisticsJSON(result, cpuStats); result << ",\n";
+			result << "  \"gpuTime\": "; writeStatisticsJSON(result, gpuStats); result << ",\n";
+			result << "  \"passes\": {";
+			for (size_t i = 0; i < passNames.size(); i++) {
+				result << (i > 0 ? ", " : " ") << "\"" << escapeJSON(passNames[i]) << "\": " << passAverages[i];
+			}
+			result << " }";
+			if (!segmentNames.empty()) {
+				const std::vector<Statistics> segmentStats = getSegmentStatistics();
+				result << ",\n  \"segments\": [";
+				for (size_t i = 0; i < segmentNames.size(); i++) {
+					result << (i > 0 ? "," : "") << "\n    { \"name\": \"" << escapeJSON(segmentNames[i]) << "\", \"frameTime\": ";
+					writeStatisticsJSON(result, segmentStats[i]);
+					result << " }";
+				}
+				result << "\n  ]";
+			}
+			if (outputFrameTimes) {
+				result << ",\n  \"frameTimes\": "; writeValuesJSON(result, frameTimes);
+				result << ",\n  \"cpuTimes\": "; writeValuesJSON(result, cpuTimes);
+				result << ",\n  \"gpuTimes\": "; writeValuesJSON(result, getGpuFrameTimes());
+			}
+			result << "\n}\n";
+		}
 	public:
 		bool active = false;
 		bool outputFrameTimes = false;
 		int outputFrames = -1; // -1 means no frames limit
 		uint32_t warmup = 1;   // Default to 1 sec of warm-up
 		uint32_t duration = 10;
+		// Wall time of each benchmark frame, preallocated from the duration (or the frame limit) so measuring does not allocate
 		std::vector<double> frameTimes;
+		// CPU time spent recording and submitting each frame, without waiting for the GPU (reported by the example base)
+		std::vector<double> cpuTimes;
+		// Results are written as JSON if the file name ends with .json, otherwise as CSV
 		std::string filename = "";
+		// GPU time per pass in ms (see vks::GpuProfiler), one row of maxPasses columns per frame with profiler results
+		// The rows are stored in a flat array preallocated by run(), columns are indexed like passNames
+		std::vector<std::string> passNames;
+		std::vector<double> passTimes;
+		size_t passRowCount = 0;
+		size_t passRowCapacity = 0;
+		bool passRowOpen = false;
+		// Upper bound for the number of distinct passes, matches the default scope limit of vks::GpuProfiler
+		uint32_t maxPasses = 32;
+		// Measured frames that did not fit into the preallocated buffers and are missing from the statistics
+		uint32_t droppedFrames = 0;
+		// Camera path segments, the segment of the next frame is set before rendering it (see vks::CameraPath)
+		std::vector<std::string> segmentNames;
+		std::vector<uint32_t> frameSegments;
+		uint32_t currentSegment = 0;
+		bool measuring = false;
 
 		double runtime = 0.0;
 		uint32_t frameCount = 0;
@@ -42,6 +390,15 @@ namespace vks
 #endif
 			std::cout << std::fixed << std::setprecision(3);
 
+			// Frames beyond the preallocated capacity are still counted, but not added to the statistics
+			const size_t capacity = (outputFrames != -1) ? static_cast<size_t>(outputFrames) : static_cast<size_t>(duration) * maxExpectedFps;
+			frameTimes.reserve(capacity);
+			cpuTimes.reserve(capacity);
+			passTimes.assign(capacity * maxPasses, 0.0);
+			passRowCapacity = capacity;
+			passNames.reserve(maxPasses);
+			frameSegments.reserve(segmentNames.empty() ? 0 : capacity);
+
 			// Warm up phase to get more stable frame rates
 			{
 				double tMeasured = 0.0;
@@ -55,20 +412,108 @@ namespace vks
 
 			// Benchmark phase
 			{
+				measuring = true;
 				while (runtime < (duration * 1000.0)) {
 					auto tStart = std::chrono::high_resolution_clock::now();
 					renderFunc();
 					auto tDiff = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - tStart).count();
 					runtime += tDiff;
-					frameTimes.push_back(tDiff);
+					if (frameTimes.size() < frameTimes.capacity()) {
+						frameTimes.push_back(tDiff);
+						if (!segmentNames.empty()) {
+							frameSegments.push_back(currentSegment);
+						}
+					} else {
+						droppedFrames++;
+					}
 					frameCount++;
 					if (outputFrames != -1 && outputFrames == frameCount) break;
 				};
+				measuring = false;
 				std::cout << "Benchmark finished" << "\n";
 				std::cout << "device : " << deviceProps.deviceName << " (driver version: " << deviceProps.driverVersion << ")" << "\n";
 				std::cout << "runtime: " << (runtime / 1000.0) << "\n";
 				std::cout << "frames : " << frameCount << "\n";
 				std::cout << "fps    : " << frameCount / (runtime / 1000.0) << "\n";
+				if (droppedFrames > 0) {
+					std::cout << "dropped: " << droppedFrames << " frames exceeded the preallocated capacity and are not included in the statistics" << "\n";
+				}
+				printStatistics("frame  :", getStatistics(frameTimes));
+				if (!cpuTimes.empty()) {
+					printStatistics("cpu    :", getStatistics(cpuTimes));
+				}
+				if (passRowCount > 0) {
+					printStatistics("gpu    :", getStatistics(getGpuFrameTimes()));
+				}
+				if (!segmentNames.empty()) {
+					const std::vector<Statistics> segmentStats = getSegmentStatistics();
+					for (size_t i = 0; i < segmentNames.size(); i++) {
+						printStatistics(segmentNames[i] + ":", segmentStats[i]);
+					}
+				}
+			}
+		}
+
+		/** @brief Adds the CPU time of one frame that was spent recording and submitting work */
+		void addCpuTime(double time) {
+			if (measuring && (cpuTimes.size() < cpuTimes.capacity())) {
+				cpuTimes.push_back(time);
+			}
+		}
+
+		/** @brief Starts the GPU pass times of one frame, followed by an addPassTime() call for each of its passes */
+		void beginPassTimes() {
+			passRowOpen = measuring && (passRowCount < passRowCapacity);
+			if (passRowOpen) {
+				passRowCount++;
+			}
+		}
+
+		/** @brief Adds the GPU time of one pass to the current frame, passes are matched by name so the set of passes may change between frames */
+		void addPassTime(const std::string& name, double time) {
+			if (!passRowOpen) {
+				return;
+			}
+			const size_t index = std::find(passNames.begin(), passNames.end(), name) - passNames.begin();
+			if (index == passNames.size()) {
+				if (passNames.size() == maxPasses) {
+					return;
+				}
+				passNames.push_back(name);
+			}
+			passTimes[(passRowCount - 1) * maxPasses + index] += time;
+		}
+
+		/** @brief Clears the results of the last run so the benchmark can be run again, e.g. for the next configuration of a sweep */
+		void reset() {
+			frameTimes.clear();
+			cpuTimes.clear();
+			passRowCount = 0;
+			passRowOpen = false;
+			frameSegments.clear();
+			currentSegment = 0;
+			runtime = 0.0;
+			frameCount = 0;
+			droppedFrames = 0;
+		}
+
+		/** @brief Stores the summary of the last run as one row of the combined sweep results */
+		void addSweepResult(const std::vector<std::pair<std::string, std::string>>& parameters, uint32_t width, uint32_t height) {
+			SweepResult sweepResult{ parameters, width, height, runtime, frameCount, getStatistics(frameTimes), getStatistics(cpuTimes), getStatistics(getGpuFrameTimes()), getPassAverages() };
+			sweepResults.push_back(sweepResult);
+		}
+
+		/** @brief Writes one table with a row per sweep configuration, as JSON if the file name ends with .json, otherwise as CSV */
+		void saveSweepResults() {
+			std::ofstream result(filename, std::ios::out);
+			if (result.is_open()) {
+				result << std::fixed << std::setprecision(4);
+				if (isJSONFile()) {
+					saveSweepResultsJSON(result);
+				} else {
+					saveSweepResultsCSV(result);
+				}
+				result.flush();
 			}
 		}
 
@@ -77,20 +522,22 @@ namespace vks
 			if (result.is_open()) {
 				result << std::fixed << std::setprecision(4);
 
-				result << "device,driverversion,duration (ms),frames,fps" << "\n";
-				result << deviceProps.deviceName << "," << deviceProps.driverVersion << "," << runtime << "," << frameCount << "," << frameCount / (runtime / 1000.0) << "\n";
+				const Statistics frameStats = getStatistics(frameTimes);
+				const Statistics cpuStats = getStatistics(cpuTimes);
+				const Statistics gpuStats = getStatistics(getGpuFrameTimes());
 
-				if (outputFrameTimes) {
-					result << "\n" << "frame,ms" << "\n";
-					for (size_t i = 0; i < frameTimes.size(); i++) {
-						result << i << "," << frameTimes[i] << "\n";
-					}
-					double tMin = *std::min_element(frameTimes.begin(), frameTimes.end());
-					double tMax = *std::max_element(frameTimes.begin(), frameTimes.end());
-					double tAvg = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) / (double)frameTimes.size();
-					std::cout << "best   : " << (1000.0 / tMin) << " fps (" << tMin << " ms)" << "\n";
-					std::cout << "worst  : " << (1000.0 / tMax) << " fps (" << tMax << " ms)" << "\n";
-					std::cout << "avg    : " << (1000.0 / tAvg) << " fps (" << tAvg << " ms)" << "\n";
+				const std::vector<double> passAverages = getPassAverages();
+
+				if (isJSONFile()) {
+					saveResultsJSON(result, frameStats, cpuStats, gpuStats, passAverages);
+				} else {
+					saveResultsCSV(result, frameStats, cpuStats, gpuStats, passAverages);
+				}
+
+				if (outputFrameTimes && !frameTimes.empty()) {
+					std::cout << "best   : " << (1000.0 / frameStats.min) << " fps (" << frameStats.min << " ms)" << "\n";
+					std::cout << "worst  : " << (1000.0 / frameStats.max) << " fps (" << frameStats.max << " ms)" << "\n";
+					std::cout << "avg    : " << (1000.0 / frameStats.avg) << " fps (" << frameStats.avg << " ms)" << "\n";
 					std::cout << "\n";
 				}
 
@@ -101,4 +548,4 @@ namespace vks
 			}
 		}
 	};
-}
\ No newline at end of file
+}
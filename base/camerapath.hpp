@@ -0,0 +1,148 @@
+/*
+* Camera path class
+*
+* Records camera keyframes to a file and plays them back by frame index, so every run renders the same views
+*
+* This code is licensed under the MIT license (MIT) (http://opensource.org/licenses/MIT)
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+
+namespace vks
+{
+	class CameraPath {
+	private:
+		// Centripetal weighting is not needed for the short, evenly spaced segments of a recorded path
+		static glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t) {
+			const float t2 = t * t;
+			const float t3 = t2 * t;
+			return 0.5f * ((2.0f * p1) + (-p0 + p2) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+		}
+		// Euler angles are stored as recorded, e.g. 350 followed by 10, so each angle is moved to the shortest delta from the previous one before interpolating
+		static glm::vec3 unwrapRotation(const glm::vec3& rotation, const glm::vec3& previous) {
+			glm::vec3 unwrapped;
+			for (int i = 0; i < 3; i++) {
+				unwrapped[i] = previous[i] + std::remainder(rotation[i] - previous[i], 360.0f);
+			}
+			return unwrapped;
+		}
+	public:
+		struct Keyframe {
+			// Frame index at which the camera reaches this keyframe
+			uint32_t frame;
+			glm::vec3 position;
+			glm::vec3 rotation;
+			// Name of the segment starting at this keyframe, used for the per-segment benchmark results
+			std::string segment;
+		};
+		std::vector<Keyframe> keyframes;
+		// Number of frames between keyframes while recording
+		uint32_t recordInterval = 30;
+
+		bool empty() const { return keyframes.size() < 2; }
+
+		/** @brief Number of frames from the first to the last keyframe */
+		uint32_t getFrameCount() const {
+			return empty() ? 0 : keyframes.back().frame - keyframes.front().frame + 1;
+		}
+
+		uint32_t getSegmentCount() const {
+			return empty() ? 0 : static_cast<uint32_t>(keyframes.size() - 1);
+		}
+
+		std::string getSegmentName(uint32_t segment) const {
+			return keyframes[segment].segment.empty() ? "segment " + std::to_string(segment) : keyframes[segment].segment;
+		}
+
+		/** @brief Index of the segment the given frame falls into, frames past the end wrap around */
+		uint32_t getSegment(uint32_t frame) const {
+			const uint32_t pathFrame = keyframes.front().frame + frame % getFrameCount();
+			uint32_t segment = 0;
+			while ((segment + 2 < keyframes.size()) && (keyframes[segment + 1].frame <= pathFrame)) {
+				segment++;
+			}
+			return segment;
+		}
+
+		/** @brief Moves the camera to its position at the given frame, frames past the end wrap around */
+		void apply(Camera& camera, uint32_t frame) const {
+			if (empty()) {
+				return;
+			}
+			const uint32_t segment = getSegment(frame);
+			const uint32_t pathFrame = keyframes.front().frame + frame % getFrameCount();
+			const Keyframe& k1 = keyframes[segment];
+			const Keyframe& k2 = keyframes[segment + 1];
+			const Keyframe& k0 = keyframes[segment > 0 ? segment - 1 : segment];
+			const Keyframe& k3 = keyframes[std::min<size_t>(segment + 2, keyframes.size() - 1)];
+			const float t = std::min(static_cast<float>(pathFrame - k1.frame) / static_cast<float>(std::max(k2.frame - k1.frame, 1u)), 1.0f);
+			camera.setPosition(catmullRom(k0.position, k1.position, k2.position, k3.position, t));
+			const glm::vec3 r0 = unwrapRotation(k0.rotation, k1.rotation);
+			const glm::vec3 r2 = unwrapRotation(k2.rotation, k1.rotation);
+			const glm::vec3 r3 = unwrapRotation(k3.rotation, r2);
+			camera.setRotation(catmullRom(r0, k1.rotation, r2, r3, t));
+		}
+
+		void addKeyframe(uint32_t frame, const Camera& camera) {
+			keyframes.push_back({ frame, camera.position, camera.rotation, "" });
+		}
+
+		/**
+		* Load a camera path
+		*
+		* @note One keyframe per line: frame, position (x y z), rotation in degrees (x y z) and an optional segment name, lines starting with # are ignored
+		*
+		* @return True if the file contained at least two keyframes in increasing frame order
+		*/
+		bool load(const std::string& filename) {
+			std::ifstream file(filename);
+			if (!file.is_open()) {
+				return false;
+			}
+			keyframes.clear();
+			std::string line;
+			while (std::getline(file, line)) {
+				if (line.empty() || (line[0] == '#')) {
+					continue;
+				}
+				std::istringstream stream(line);
+				Keyframe keyframe;
+				if (!(stream >> keyframe.frame >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.rotation.x >> keyframe.rotation.y >> keyframe.rotation.z)) {
+					continue;
+				}
+				std::getline(stream >> std::ws, keyframe.segment);
+				if (!keyframes.empty() && (keyframe.frame <= keyframes.back().frame)) {
+					keyframes.clear();
+					return false;
+				}
+				keyframes.push_back(keyframe);
+			}
+			return !empty();
+		}
+
+		bool save(const std::string& filename) const {
+			std::ofstream file(filename, std::ios::out);
+			if (!file.is_open()) {
+				return false;
+			}
+			file << std::fixed << std::setprecision(6);
+			file << "# frame position.x position.y position.z rotation.x rotation.y rotation.z [segment name]" << "\n";
+			for (const Keyframe& keyframe : keyframes) {
+				file << keyframe.frame << " " << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " " << keyframe.rotation.x << " " << keyframe.rotation.y << " " << keyframe.rotation.z;
+				if (!keyframe.segment.empty()) {
+					file << " " << keyframe.segment;
+				}
+				file << "\n";
+			}
+			return true;
+		}
+	};
+}
@@ -79,6 +79,14 @@ VkResult VulkanExampleBase::createInstance(bool enableValidation)
 	}
 #endif
 
+	// Enable VK_KHR_get_physical_device_properties2 if available, it's required to check for timeline semaphore support of the upload manager
+	if (enableUploadManager &&
+		(std::find(supportedInstanceExtensions.begin(), supportedInstanceExtensions.end(), VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) != supportedInstanceExtensions.end()) &&
+		(std::find(enabledInstanceExtensions.begin(), enabledInstanceExtensions.end(), VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == enabledInstanceExtensions.end()))
+	{
+		enabledInstanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	}
+
 	// Enabled requested instance extensions
 	if (enabledInstanceExtensions.size() > 0)
 	{
@@ -204,26 +212,136 @@ std::string VulkanExampleBase::getShadersPath() const
 	return getShaderBasePath() + shaderDir + "/";
 }
 
+// Written in front of the data returned by vkGetPipelineCacheData, the implementation's own header does not include the driver version
+struct PipelineCacheFileHeader {
+	uint32_t magic;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint64_t dataSize;
+};
+static const uint32_t pipelineCacheFileMagic = 0x43504B56; // "VKPC"
+
+// One file per example and device, so switching between GPUs does not discard the cache of the other one
+std::string VulkanExampleBase::getPipelineCacheFileName() const
+{
+	char fileName[256];
+	snprintf(fileName, sizeof(fileName), "%s_%04x_%04x.pipelinecache", name.c_str(), deviceProperties.vendorID, deviceProperties.deviceID);
+	return fileName;
+}
+
 void VulkanExampleBase::createPipelineCache()
 {
+	// Data from a different device or driver version is never passed to the implementation
+	std::vector<char> cacheData;
+	if (persistentPipelineCache) {
+		std::ifstream file(getPipelineCacheFileName(), std::ios::binary | std::ios::ate);
+		const std::streamoff fileSize = file.is_open() ? static_cast<std::streamoff>(file.tellg()) : 0;
+		file.seekg(0);
+		PipelineCacheFileHeader header{};
+		if (file.is_open() && file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+			const bool valid = (header.magic == pipelineCacheFileMagic) &&
+				(header.dataSize == static_cast<uint64_t>(fileSize) - sizeof(header)) &&
+				(header.vendorID == deviceProperties.vendorID) &&
+				(header.deviceID == deviceProperties.deviceID) &&
+				(header.driverVersion == deviceProperties.driverVersion) &&
+				(memcmp(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+			if (valid) {
+				cacheData.resize(static_cast<size_t>(header.dataSize));
+				if (!file.read(cacheData.data(), cacheData.size())) {
+					cacheData.clear();
+				}
+			}
+			if (cacheData.empty()) {
+				std::cout << "Ignoring pipeline cache \"" << getPipelineCacheFileName() << "\" (created by a different device or driver, or incomplete)" << "\n";
+			}
+		}
+	}
+	loadedPipelineCacheSize = cacheData.size();
+
 	VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
 	pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	pipelineCacheCreateInfo.initialDataSize = cacheData.size();
+	pipelineCacheCreateInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
 	VK_CHECK_RESULT(vkCreatePipelineCache(device, &pipelineCacheCreateInfo, nullptr, &pipelineCache));
 }
 
+void VulkanExampleBase::savePipelineCache()
+{
+	size_t dataSize = 0;
+	VK_CHECK_RESULT(vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr));
+	std::vector<char> cacheData(dataSize);
+	VK_CHECK_RESULT(vkGetPipelineCacheData(device, pipelineCache, &dataSize, cacheData.data()));
+	if (dataSize == 0) {
+		return;
+	}
+
+	PipelineCacheFileHeader header{};
+	header.magic = pipelineCacheFileMagic;
+	header.vendorID = deviceProperties.vendorID;
+	header.deviceID = deviceProperties.deviceID;
+	header.driverVersion = deviceProperties.driverVersion;
+	memcpy(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+	header.dataSize = dataSize;
+
+	// Written to a temporary file that replaces the cache in one step, so an interrupted write never leaves a truncated cache behind
+	const std::string fileName = getPipelineCacheFileName();
+	const std::string tempFileName = fileName + ".tmp";
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "Could not write pipeline cache \"" << tempFileName << "\"" << "\n";
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(cacheData.data(), dataSize);
+		file.flush();
+		if (!file) {
+			std::cerr << "Could not write pipeline cache \"" << tempFileName << "\"" << "\n";
+			file.close();
+			std::remove(tempFileName.c_str());
+			return;
+		}
+	}
+#if defined(_WIN32)
+	const bool replaced = MoveFileExA(tempFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	const bool replaced = std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+#endif
+	if (!replaced) {
+		std::cerr << "Could not replace pipeline cache \"" << fileName << "\"" << "\n";
+		std::remove(tempFileName.c_str());
+	}
+}
+
 void VulkanExampleBase::prepare()
 {
+	VKS_TRACE_SCOPE("VulkanExampleBase::prepare");
 	initSwapchain();
 	createCommandPool();
 	setupSwapChain();
 	createCommandBuffers();
 	createSynchronizationPrimitives();
+	if (useFramesInFlight) {
+		createFramesInFlight();
+	}
 	setupDepthStencil();
 	setupRenderPass();
-	createPipelineCache();
+	{
+		VKS_TRACE_SCOPE("createPipelineCache");
+		createPipelineCache();
+	}
+	pipelineQueue.create(device, pipelineCache, std::max(1u, std::min(std::thread::hardware_concurrency(), 8u)));
 	setupFrameBuffer();
+	if (settings.headless && !headlessReadbackPrefix.empty()) {
+		// Encoding is cheap compared to writing, a few threads are enough to keep up with the disk
+		const uint32_t workerCount = std::max(1u, std::min(std::thread::hardware_concurrency() / 2, 4u));
+		frameReadback.create(vulkanDevice, queue, headlessReadbackLatency, workerCount, headlessReadbackPrefix, headlessReadbackEncoding);
+	}
 	settings.overlay = settings.overlay && (!benchmark.active);
 	if (settings.overlay) {
+		VKS_TRACE_SCOPE("UIOverlay::prepare");
 		UIOverlay.device = vulkanDevice;
 		UIOverlay.queue = queue;
 		UIOverlay.shaders = {
@@ -253,13 +371,18 @@ VkPipelineShaderStageCreateInfo VulkanExampleBase::loadShader(std::string fileNa
 
 void VulkanExampleBase::nextFrame()
 {
+	VKS_TRACE_SCOPE("frame");
 	auto tStart = std::chrono::high_resolution_clock::now();
 	if (viewUpdated)
 	{
 		viewUpdated = false;
 	}
 
-	render();
+	updateCameraPath();
+	{
+		VKS_TRACE_SCOPE("render");
+		render();
+	}
 	frameCounter++;
 	auto tEnd = std::chrono::high_resolution_clock::now();
 #if (defined(VK_USE_PLATFORM_IOS_MVK) || (defined(VK_USE_PLATFORM_MACOS_MVK) && !defined(VK_EXAMPLE_XCODE_GENERATED)))
@@ -299,26 +422,51 @@ void VulkanExampleBase::nextFrame()
 	tPrevEnd = tEnd;
 
 	// TODO: Cap UI overlay update rates
+	VKS_TRACE_SCOPE("updateOverlay");
 	updateOverlay();
 }
 
+void VulkanExampleBase::reportPipelineCreationTime()
+{
+	const double creationTime = pipelineQueue.getBuildTime() + pipelineCreationTime;
+	if (loadedPipelineCacheSize > 0) {
+		std::cout << "Pipeline creation took " << creationTime << " ms with a warm pipeline cache (" << loadedPipelineCacheSize << " bytes)" << "\n";
+	} else {
+		std::cout << "Pipeline creation took " << creationTime << " ms with a cold pipeline cache" << "\n";
+	}
+}
+
 void VulkanExampleBase::renderLoop()
 {
+	// All pipelines created in prepare() exist at this point, unless the example is still creating some in the background
+	if (!deferPipelineCreationReport) {
+		reportPipelineCreationTime();
+	}
+	// Allocation counts and wasted bytes of everything the example has created up front, only reported with the benchmark results
+	if (benchmark.active) {
+		vulkanDevice->memoryAllocator.printStatistics(std::cout);
+	}
 // SRS - for non-apple plaforms, handle benchmarking here within VulkanExampleBase::renderLoop()
 //     - for macOS, handle benchmarking within NSApp rendering loop via displayLinkOutputCb()
 #if !(defined(VK_USE_PLATFORM_IOS_MVK) || defined(VK_USE_PLATFORM_MACOS_MVK))
 	if (benchmark.active) {
 #if defined(VK_USE_PLATFORM_WAYLAND_KHR)
-		while (!configured)
+		while (!configured && !settings.headless)
 			wl_display_dispatch(display);
-		while (wl_display_prepare_read(display) != 0)
+		while (!settings.headless && (wl_display_prepare_read(display) != 0))
 			wl_display_dispatch_pending(display);
-		wl_display_flush(display);
-		wl_display_read_events(display);
-		wl_display_dispatch_pending(display);
+		if (!settings.headless) {
+			wl_display_flush(display);
+			wl_display_read_events(display);
+			wl_display_dispatch_pending(display);
+		}
 #endif
 
-		benchmark.run([=] { render(); }, vulkanDevice->properties);
+		if (!benchmarkSweep.empty()) {
+			runBenchmarkSweep();
+			return;
+		}
+		benchmark.run([=] { VKS_TRACE_SCOPE("frame"); updateCameraPath(); render(); }, vulkanDevice->properties);
 		vkDeviceWaitIdle(device);
 		if (benchmark.filename != "") {
 			benchmark.saveResults();
@@ -331,6 +479,14 @@ void VulkanExampleBase::renderLoop()
 	destHeight = height;
 	lastTimestamp = std::chrono::high_resolution_clock::now();
 	tPrevEnd = lastTimestamp;
+	if (settings.headless) {
+		// There are no window events to process, so a fixed number of frames is rendered
+		for (uint32_t i = 0; i < headlessFrameCount; i++) {
+			nextFrame();
+		}
+		vkDeviceWaitIdle(device);
+		return;
+	}
 #if defined(_WIN32)
 	MSG msg;
 	bool quitMessageReceived = false;
@@ -676,6 +832,22 @@ void VulkanExampleBase::renderLoop()
 	}
 }
 
+void VulkanExampleBase::updateCameraPath()
+{
+	if (!cameraPathRecordFile.empty()) {
+		if ((cameraPathFrame % cameraPath.recordInterval) == 0) {
+			cameraPath.addKeyframe(cameraPathFrame, camera);
+		}
+	}
+	else if (!cameraPath.empty()) {
+		// Benchmark runs start the path with the first measured frame, warmup frames render its first view
+		const uint32_t frame = benchmark.active ? (benchmark.measuring ? benchmark.frameCount : 0) : cameraPathFrame;
+		cameraPath.apply(camera, frame);
+		benchmark.currentSegment = cameraPath.getSegment(frame);
+	}
+	cameraPathFrame++;
+}
+
 void VulkanExampleBase::updateOverlay()
 {
 	if (!settings.overlay)
@@ -700,6 +872,9 @@ void VulkanExampleBase::updateOverlay()
 	ImGui::TextUnformatted(title.c_str());
 	ImGui::TextUnformatted(deviceProperties.deviceName);
 	ImGui::Text("%.2f ms/frame (%.1d fps)", (1000.0f / lastFPS), lastFPS);
+	for (const auto& scope : profiler.getResults()) {
+		ImGui::Text("%s: %.3f ms", scope.name.c_str(), scope.averageTime);
+	}
 
 #if defined(VK_USE_PLATFORM_ANDROID_KHR)
 	ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0.0f, 5.0f * UIOverlay.scale));
@@ -715,7 +890,12 @@ void VulkanExampleBase::updateOverlay()
 	ImGui::PopStyleVar();
 	ImGui::Render();
 
-	if (UIOverlay.update() || UIOverlay.updated) {
+	// With frames in flight the overlay geometry is uploaded in beginFrame() once the frame's buffers are no longer in use,
+	// and command buffers are recorded every frame anyway
+	if (useFramesInFlight) {
+		UIOverlay.updated = false;
+	}
+	else if (UIOverlay.update() || UIOverlay.updated) {
 		buildCommandBuffers();
 		UIOverlay.updated = false;
 	}
@@ -758,6 +938,9 @@ void VulkanExampleBase::prepareFrame()
 
 void VulkanExampleBase::submitFrame()
 {
+	if (frameReadback.isCreated()) {
+		frameReadback.capture(swapChain.images[currentBuffer], swapChain.colorFormat, width, height, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}
 	VkResult result = swapChain.queuePresent(queue, currentBuffer, semaphores.renderComplete);
 	// Recreate the swapchain if it's no longer compatible with the surface (OUT_OF_DATE) or no longer optimal for presentation (SUBOPTIMAL)
 	if ((result == VK_ERROR_OUT_OF_DATE_KHR) || (result == VK_SUBOPTIMAL_KHR)) {
@@ -769,9 +952,80 @@ void VulkanExampleBase::submitFrame()
 	else {
 		VK_CHECK_RESULT(result);
 	}
+	// Examples not using frames in flight share their uniform buffers between frames, so the host has to wait for the GPU here
+	VKS_TRACE_SCOPE("vkQueueWaitIdle");
 	VK_CHECK_RESULT(vkQueueWaitIdle(queue));
 }
 
+bool VulkanExampleBase::beginFrame()
+{
+	FrameInFlight& frame = framesInFlight[currentFrame];
+	// Wait until the GPU has finished the last submission that used this frame's resources
+	{
+		VKS_TRACE_SCOPE("wait for frame fence");
+		VK_CHECK_RESULT(vkWaitForFences(device, 1, &frame.fence, VK_TRUE, UINT64_MAX));
+	}
+	frameCpuStart = std::chrono::high_resolution_clock::now();
+	VkResult result = swapChain.acquireNextImage(frame.presentComplete, &currentBuffer);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+		windowResize();
+		return false;
+	}
+	else if (result != VK_SUBOPTIMAL_KHR) {
+		VK_CHECK_RESULT(result);
+	}
+	// Only reset the fence once work is guaranteed to be submitted for this frame
+	VK_CHECK_RESULT(vkResetFences(device, 1, &frame.fence));
+	VK_CHECK_RESULT(vkResetCommandBuffer(frame.commandBuffer, 0));
+	if (uniformRing.isCreated()) {
+		uniformRing.beginFrame(currentFrame);
+	}
+	if (profiler.isCreated()) {
+		profiler.beginFrame(currentFrame);
+		if (benchmark.active && profiler.hasNewResults()) {
+			benchmark.beginPassTimes();
+			for (const auto& scope : profiler.getResults()) {
+				benchmark.addPassTime(scope.name, scope.time);
+			}
+		}
+	}
+	if (settings.overlay) {
+		UIOverlay.frameIndex = currentFrame;
+		UIOverlay.update();
+	}
+	return true;
+}
+
+void VulkanExampleBase::endFrame()
+{
+	VKS_TRACE_SCOPE("submit and present");
+	FrameInFlight& frame = framesInFlight[currentFrame];
+	VkSubmitInfo frameSubmitInfo = vks::initializers::submitInfo();
+	frameSubmitInfo.pWaitDstStageMask = &submitPipelineStages;
+	frameSubmitInfo.waitSemaphoreCount = 1;
+	frameSubmitInfo.pWaitSemaphores = &frame.presentComplete;
+	frameSubmitInfo.signalSemaphoreCount = 1;
+	frameSubmitInfo.pSignalSemaphores = &renderCompleteSemaphores[currentBuffer];
+	frameSubmitInfo.commandBufferCount = 1;
+	frameSubmitInfo.pCommandBuffers = &frame.commandBuffer;
+	VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &frameSubmitInfo, frame.fence));
+
+	if (frameReadback.isCreated()) {
+		frameReadback.capture(swapChain.images[currentBuffer], swapChain.colorFormat, width, height, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	}
+	VkResult result = swapChain.queuePresent(queue, currentBuffer, renderCompleteSemaphores[currentBuffer]);
+	currentFrame = (currentFrame + 1) % maxFramesInFlight;
+	if (benchmark.active) {
+		benchmark.addCpuTime(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameCpuStart).count());
+	}
+	if ((result == VK_ERROR_OUT_OF_DATE_KHR) || (result == VK_SUBOPTIMAL_KHR)) {
+		windowResize();
+	}
+	else {
+		VK_CHECK_RESULT(result);
+	}
+}
+
 VulkanExampleBase::VulkanExampleBase()
 {
 #if !defined(VK_USE_PLATFORM_ANDROID_KHR)
@@ -807,9 +1061,20 @@ VulkanExampleBase::VulkanExampleBase()
 	commandLineParser.add("benchmark", { "-b", "--benchmark" }, 0, "Run example in benchmark mode");
 	commandLineParser.add("benchmarkwarmup", { "-bw", "--benchwarmup" }, 1, "Set warmup time for benchmark mode in seconds");
 	commandLineParser.add("benchmarkruntime", { "-br", "--benchruntime" }, 1, "Set duration time for benchmark mode in seconds");
-	commandLineParser.add("benchmarkresultfile", { "-bf", "--benchfilename" }, 1, "Set file name for benchmark results");
+	commandLineParser.add("benchmarkresultfile", { "-bf", "--benchfilename" }, 1, "Set file name for benchmark results (written as JSON if it ends with .json)");
 	commandLineParser.add("benchmarkresultframes", { "-bt", "--benchframetimes" }, 0, "Save frame times to benchmark results file");
 	commandLineParser.add("benchmarkframes", { "-bfs", "--benchmarkframes" }, 1, "Only render the given number of frames");
+	commandLineParser.add("benchmarksweep", { "-bsw", "--benchsweep" }, 1, "Benchmark all parameter configurations listed in the given file and save them as one table");
+	commandLineParser.add("camerapath", { "-cp", "--camerapath" }, 1, "Play back a camera path file by frame index, benchmark runs cover the path once");
+	commandLineParser.add("camerapathrecord", { "-cpr", "--camerapathrecord" }, 1, "Record the camera path to the given file");
+	commandLineParser.add("nopipelinecache", { "-npc", "--nopipelinecache" }, 0, "Do not load the pipeline cache at startup and do not save it at shutdown");
+	commandLineParser.add("headless", { "-hl", "--headless" }, 0, "Render into internal images without a window, surface or swap chain");
+	commandLineParser.add("headlessframes", { "-hlf", "--headlessframes" }, 1, "Number of frames rendered in headless mode outside of benchmark runs");
+	commandLineParser.add("headlessreadback", { "-hlr", "--headlessreadback" }, 1, "Write each headless frame to <prefix>_<frame>.png (or .raw)");
+	commandLineParser.add("headlessreadbackformat", { "-hlrf", "--headlessreadbackformat" }, 1, "File format of the headless frames (png or raw)");
+	commandLineParser.add("headlessreadbacklatency", { "-hlrl", "--headlessreadbacklatency" }, 1, "Number of frames a headless frame may stay in flight before it has to be written (1..16)");
+	commandLineParser.add("trace", { "-tr", "--trace" }, 1, "Record CPU trace markers and write them to the given file in Chrome trace event format");
+	commandLineParser.add("framesinflight", { "-fif", "--framesinflight" }, 1, "Set the number of frames in flight for examples supporting it (1..4)");
 
 	commandLineParser.parse(args);
 	if (commandLineParser.isSet("help")) {
@@ -863,17 +1128,79 @@ VulkanExampleBase::VulkanExampleBase()
 	if (commandLineParser.isSet("benchmarkframes")) {
 		benchmark.outputFrames = commandLineParser.getValueAsInt("benchmarkframes", benchmark.outputFrames);
 	}
+	if (commandLineParser.isSet("benchmarksweep")) {
+		const std::string sweepFile = commandLineParser.getValueAsString("benchmarksweep", "");
+		if (!loadBenchmarkSweep(sweepFile)) {
+			std::cerr << "Could not load benchmark sweep \"" << sweepFile << "\"" << "\n";
+		}
+	}
+	if (commandLineParser.isSet("camerapath")) {
+		const std::string cameraPathFile = commandLineParser.getValueAsString("camerapath", "");
+		if (cameraPath.load(cameraPathFile)) {
+			// Unless a frame count has been given, the benchmark ends after the last keyframe
+			if (benchmark.outputFrames == -1) {
+				benchmark.outputFrames = static_cast<int>(cameraPath.getFrameCount());
+				benchmark.duration = std::numeric_limits<uint32_t>::max();
+			}
+			for (uint32_t i = 0; i < cameraPath.getSegmentCount(); i++) {
+				benchmark.segmentNames.push_back(cameraPath.getSegmentName(i));
+			}
+		}
+		else {
+			std::cerr << "Could not load camera path \"" << cameraPathFile << "\"" << "\n";
+		}
+	}
+	if (commandLineParser.isSet("camerapathrecord")) {
+		cameraPathRecordFile = commandLineParser.getValueAsString("camerapathrecord", "");
+		cameraPath.keyframes.clear();
+	}
+	if (commandLineParser.isSet("nopipelinecache")) {
+		persistentPipelineCache = false;
+	}
+	if (commandLineParser.isSet("headless")) {
+		settings.headless = true;
+	}
+	if (commandLineParser.isSet("headlessframes")) {
+		headlessFrameCount = static_cast<uint32_t>(std::max(commandLineParser.getValueAsInt("headlessframes", headlessFrameCount), 1));
+	}
+	if (commandLineParser.isSet("headlessreadback")) {
+		headlessReadbackPrefix = commandLineParser.getValueAsString("headlessreadback", "");
+	}
+	if (commandLineParser.isSet("headlessreadbackformat")) {
+		const std::string format = commandLineParser.getValueAsString("headlessreadbackformat", "png");
+		if ((format != "png") && (format != "raw")) {
+			std::cerr << "Headless readback format must be one of 'png' or 'raw'\n";
+		}
+		headlessReadbackEncoding = (format == "raw") ? vks::FrameReadback::Encoding::Raw : vks::FrameReadback::Encoding::PNG;
+	}
+	if (commandLineParser.isSet("headlessreadbacklatency")) {
+		headlessReadbackLatency = static_cast<uint32_t>(std::max(1, std::min(commandLineParser.getValueAsInt("headlessreadbacklatency", headlessReadbackLatency), 16)));
+	}
+	if (commandLineParser.isSet("framesinflight")) {
+		maxFramesInFlight = static_cast<uint32_t>(std::max(1, std::min(commandLineParser.getValueAsInt("framesinflight", maxFramesInFlight), 4)));
+	}
+	if (commandLineParser.isSet("trace")) {
+		traceFileName = commandLineParser.getValueAsString("trace", "trace.json");
+		vks::trace::enable();
+		vks::trace::setThreadName("main");
+	}
 
 #if defined(VK_USE_PLATFORM_ANDROID_KHR)
 	// Vulkan library is loaded dynamically on Android
 	bool libLoaded = vks::android::loadVulkanLibrary();
 	assert(libLoaded);
+	// The working directory is not writable on Android
+	persistentPipelineCache = false;
 #elif defined(_DIRECT2DISPLAY)
 
 #elif defined(VK_USE_PLATFORM_WAYLAND_KHR)
-	initWaylandConnection();
+	if (!settings.headless) {
+		initWaylandConnection();
+	}
 #elif defined(VK_USE_PLATFORM_XCB_KHR)
-	initxcbConnection();
+	if (!settings.headless) {
+		initxcbConnection();
+	}
 #endif
 
 #if defined(_WIN32)
@@ -888,6 +1215,8 @@ VulkanExampleBase::VulkanExampleBase()
 
 VulkanExampleBase::~VulkanExampleBase()
 {
+	// Pending frames are written before any of the images they were copied from are destroyed
+	frameReadback.destroy();
 	// Clean up Vulkan resources
 	swapChain.cleanup();
 	if (descriptorPool != VK_NULL_HANDLE)
@@ -912,6 +1241,10 @@ VulkanExampleBase::~VulkanExampleBase()
 	vkDestroyImage(device, depthStencil.image, nullptr);
 	vkFreeMemory(device, depthStencil.memory, nullptr);
 
+	pipelineQueue.destroy();
+	if (persistentPipelineCache) {
+		savePipelineCache();
+	}
 	vkDestroyPipelineCache(device, pipelineCache, nullptr);
 
 	vkDestroyCommandPool(device, cmdPool, nullptr);
@@ -921,6 +1254,16 @@ VulkanExampleBase::~VulkanExampleBase()
 	for (auto& fence : waitFences) {
 		vkDestroyFence(device, fence, nullptr);
 	}
+	destroyFramesInFlight();
+	if (uniformRing.isCreated()) {
+		uniformRing.destroy();
+	}
+	if (profiler.isCreated()) {
+		profiler.destroy();
+	}
+	if (!cameraPathRecordFile.empty() && !cameraPath.save(cameraPathRecordFile)) {
+		std::cerr << "Could not save camera path \"" << cameraPathRecordFile << "\"" << "\n";
+	}
 
 	if (settings.overlay) {
 		UIOverlay.freeResources();
@@ -935,6 +1278,15 @@ VulkanExampleBase::~VulkanExampleBase()
 
 	vkDestroyInstance(instance, nullptr);
 
+	if (!traceFileName.empty() && !vks::trace::save(traceFileName, title)) {
+		std::cerr << "Could not save trace \"" << traceFileName << "\"" << "\n";
+	}
+
+	// Headless runs never connect to the window system
+	if (settings.headless) {
+		return;
+	}
+
 #if defined(_DIRECT2DISPLAY)
 
 #elif defined(VK_USE_PLATFORM_DIRECTFB_EXT)
@@ -976,6 +1328,7 @@ VulkanExampleBase::~VulkanExampleBase()
 
 bool VulkanExampleBase::initVulkan()
 {
+	VKS_TRACE_SCOPE("VulkanExampleBase::initVulkan");
 	VkResult err;
 
 	// Vulkan instance
@@ -1057,7 +1410,33 @@ bool VulkanExampleBase::initVulkan()
 	// Derived examples can enable extensions based on the list of supported extensions read from the physical device
 	getEnabledExtensions();
 
-	VkResult res = vulkanDevice->createLogicalDevice(enabledFeatures, enabledDeviceExtensions, deviceCreatepNextChain);
+	// If requested by the example, buffers and images are uploaded in batches on the transfer queue if the device supports timeline semaphores to signal their completion
+	// Otherwise the loaders use the graphics queue and fences
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures{};
+	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+	bool timelineSemaphoreSupported = false;
+	const bool properties2Enabled = std::find_if(enabledInstanceExtensions.begin(), enabledInstanceExtensions.end(), [](const char* extension) { return strcmp(extension, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0; }) != enabledInstanceExtensions.end();
+	if (enableUploadManager && properties2Enabled && vulkanDevice->extensionSupported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+		PFN_vkGetPhysicalDeviceFeatures2KHR getPhysicalDeviceFeatures2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
+		VkPhysicalDeviceFeatures2KHR deviceFeatures2{};
+		deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+		deviceFeatures2.pNext = &timelineSemaphoreFeatures;
+		getPhysicalDeviceFeatures2KHR(physicalDevice, &deviceFeatures2);
+		timelineSemaphoreSupported = timelineSemaphoreFeatures.timelineSemaphore == VK_TRUE;
+	}
+	void* pNextChain = deviceCreatepNextChain;
+	VkQueueFlags requestedQueueTypes = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+	if (timelineSemaphoreSupported) {
+		if (std::find_if(enabledDeviceExtensions.begin(), enabledDeviceExtensions.end(), [](const char* extension) { return strcmp(extension, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0; }) == enabledDeviceExtensions.end()) {
+			enabledDeviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		}
+		timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+		timelineSemaphoreFeatures.pNext = deviceCreatepNextChain;
+		pNextChain = &timelineSemaphoreFeatures;
+		requestedQueueTypes |= VK_QUEUE_TRANSFER_BIT;
+	}
+
+	VkResult res = vulkanDevice->createLogicalDevice(enabledFeatures, enabledDeviceExtensions, pNextChain, true, requestedQueueTypes);
 	if (res != VK_SUCCESS) {
 		vks::tools::exitFatal("Could not create Vulkan device: \n" + vks::tools::errorString(res), res);
 		return false;
@@ -1067,6 +1446,10 @@ bool VulkanExampleBase::initVulkan()
 	// Get a graphics queue from the device
 	vkGetDeviceQueue(device, vulkanDevice->queueFamilyIndices.graphics, 0, &queue);
 
+	if (timelineSemaphoreSupported) {
+		vulkanDevice->uploader.create(vulkanDevice, queue);
+	}
+
 	// Find a suitable depth and/or stencil format
 	VkBool32 validFormat{ false };
 	// Samples that make use of stencil will require a depth + stencil format, so we select from a different list
@@ -1142,6 +1525,10 @@ void VulkanExampleBase::setupDPIAwareness()
 HWND VulkanExampleBase::setupWindow(HINSTANCE hinstance, WNDPROC wndproc)
 {
 	this->windowInstance = hinstance;
+	if (settings.headless) {
+		window = nullptr;
+		return window;
+	}
 
 	WNDCLASSEX wndClass;
 
@@ -1909,7 +2296,7 @@ void VulkanExampleBase::displayLinkOutputCb()
 {
 #if defined(VK_EXAMPLE_XCODE_GENERATED)
 	if (benchmark.active) {
-		benchmark.run([=] { render(); }, vulkanDevice->properties);
+		benchmark.run([=] { VKS_TRACE_SCOPE("frame"); updateCameraPath(); render(); }, vulkanDevice->properties);
 		if (benchmark.filename != "") {
 			benchmark.saveResults();
 		}
@@ -2450,6 +2837,9 @@ static const struct xdg_toplevel_listener xdg_toplevel_listener = {
 
 struct xdg_surface *VulkanExampleBase::setupWindow()
 {
+	if (settings.headless) {
+		return nullptr;
+	}
 	surface = wl_compositor_create_surface(compositor);
 	xdg_surface = xdg_wm_base_get_xdg_surface(shell, surface);
 
@@ -2476,6 +2866,11 @@ xcb_window_t VulkanExampleBase::setupWindow()
 {
 	uint32_t value_mask, value_list[32];
 
+	if (settings.headless) {
+		window = 0;
+		return window;
+	}
+
 	window = xcb_generate_id(connection);
 
 	value_mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
@@ -2984,6 +3379,49 @@ void VulkanExampleBase::createSynchronizationPrimitives()
 	}
 }
 
+void VulkanExampleBase::createFramesInFlight()
+{
+	framesInFlight.resize(maxFramesInFlight);
+	VkCommandBufferAllocateInfo cmdBufAllocateInfo = vks::initializers::commandBufferAllocateInfo(cmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1);
+	VkSemaphoreCreateInfo semaphoreCreateInfo = vks::initializers::semaphoreCreateInfo();
+	// Fences are created signaled so the first wait on each frame returns immediately
+	VkFenceCreateInfo fenceCreateInfo = vks::initializers::fenceCreateInfo(VK_FENCE_CREATE_SIGNALED_BIT);
+	for (auto& frame : framesInFlight) {
+		VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &cmdBufAllocateInfo, &frame.commandBuffer));
+		VK_CHECK_RESULT(vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &frame.presentComplete));
+		VK_CHECK_RESULT(vkCreateFence(device, &fenceCreateInfo, nullptr, &frame.fence));
+	}
+	createRenderCompleteSemaphores();
+	// The overlay keeps one set of geometry buffers per frame in flight
+	UIOverlay.geometryBuffers.resize(maxFramesInFlight);
+}
+
+void VulkanExampleBase::destroyFramesInFlight()
+{
+	// Command buffers are freed together with the command pool
+	for (auto& frame : framesInFlight) {
+		vkDestroySemaphore(device, frame.presentComplete, nullptr);
+		vkDestroyFence(device, frame.fence, nullptr);
+	}
+	framesInFlight.clear();
+	for (auto& semaphore : renderCompleteSemaphores) {
+		vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	renderCompleteSemaphores.clear();
+}
+
+void VulkanExampleBase::createRenderCompleteSemaphores()
+{
+	for (auto& semaphore : renderCompleteSemaphores) {
+		vkDestroySemaphore(device, semaphore, nullptr);
+	}
+	renderCompleteSemaphores.resize(swapChain.imageCount);
+	VkSemaphoreCreateInfo semaphoreCreateInfo = vks::initializers::semaphoreCreateInfo();
+	for (auto& semaphore : renderCompleteSemaphores) {
+		VK_CHECK_RESULT(vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore));
+	}
+}
+
 void VulkanExampleBase::createCommandPool()
 {
 	VkCommandPoolCreateInfo cmdPoolInfo = {};
@@ -3180,6 +3618,10 @@ void VulkanExampleBase::windowResize()
 		vkDestroyFence(device, fence, nullptr);
 	}
 	createSynchronizationPrimitives();
+	// The present wait semaphores are per swap chain image as well
+	if (useFramesInFlight) {
+		createRenderCompleteSemaphores();
+	}
 
 	vkDeviceWaitIdle(device);
 
@@ -3228,8 +3670,134 @@ void VulkanExampleBase::handleMouseMove(int32_t x, int32_t y)
 
 void VulkanExampleBase::windowResized() {}
 
+bool VulkanExampleBase::applySweepParameter(const std::string&, const std::string&)
+{
+	return false;
+}
+
+void VulkanExampleBase::resizeWindow(uint32_t newWidth, uint32_t newHeight)
+{
+	if ((newWidth == width) && (newHeight == height)) {
+		return;
+	}
+	// The swap chain takes its extent from the surface, so the window itself needs to be resized on platforms where the surface follows the window
+#if defined(_WIN32)
+	if (!settings.headless) {
+		RECT rect = { 0, 0, (LONG)newWidth, (LONG)newHeight };
+		AdjustWindowRectEx(&rect, GetWindowLong(window, GWL_STYLE), FALSE, GetWindowLong(window, GWL_EXSTYLE));
+		SetWindowPos(window, 0, 0, 0, rect.right - rect.left, rect.bottom - rect.top, SWP_NOZORDER | SWP_NOMOVE);
+	}
+#elif defined(VK_USE_PLATFORM_XCB_KHR)
+	if (!settings.headless) {
+		const uint32_t values[] = { newWidth, newHeight };
+		xcb_configure_window(connection, window, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+		// Round trip so the server has applied the new size before the swap chain is recreated
+		free(xcb_get_geometry_reply(connection, xcb_get_geometry(connection, window), nullptr));
+	}
+#endif
+	destWidth = newWidth;
+	destHeight = newHeight;
+	windowResize();
+}
+
+bool VulkanExampleBase::loadBenchmarkSweep(const std::string& filename)
+{
+	// One or more configurations per line as space separated name=value pairs, comma separated values are expanded to all their combinations
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		return false;
+	}
+	benchmarkSweep.clear();
+	std::string line;
+	while (std::getline(file, line)) {
+		line = line.substr(0, line.find('#'));
+		std::vector<std::vector<std::pair<std::string, std::string>>> configurations(1);
+		std::istringstream stream(line);
+		std::string token;
+		while (stream >> token) {
+			const size_t separator = token.find('=');
+			if ((separator == std::string::npos) || (separator == 0)) {
+				std::cerr << "Ignoring benchmark sweep parameter \"" << token << "\" without value" << "\n";
+				continue;
+			}
+			const std::string name = token.substr(0, separator);
+			std::vector<std::string> values;
+			std::istringstream valueStream(token.substr(separator + 1));
+			std::string value;
+			while (std::getline(valueStream, value, ',')) {
+				values.push_back(value);
+			}
+			std::vector<std::vector<std::pair<std::string, std::string>>> expanded;
+			for (const auto& configuration : configurations) {
+				for (const auto& v : values) {
+					expanded.push_back(configuration);
+					expanded.back().push_back({ name, v });
+				}
+			}
+			configurations = expanded;
+		}
+		if (!configurations[0].empty()) {
+			benchmarkSweep.insert(benchmarkSweep.end(), configurations.begin(), configurations.end());
+		}
+	}
+	return !benchmarkSweep.empty();
+}
+
+void VulkanExampleBase::runBenchmarkSweep()
+{
+	// The scene and all resources not affected by a parameter are kept between configurations
+	for (size_t i = 0; i < benchmarkSweep.size(); i++) {
+		const auto& configuration = benchmarkSweep[i];
+		std::cout << "Configuration " << (i + 1) << "/" << benchmarkSweep.size() << ":";
+		for (const auto& parameter : configuration) {
+			std::cout << " " << parameter.first << "=" << parameter.second;
+		}
+		std::cout << "\n";
+		for (const auto& parameter : configuration) {
+			if (parameter.first == "resolution") {
+				uint32_t newWidth = 0, newHeight = 0;
+				if ((sscanf(parameter.second.c_str(), "%ux%u", &newWidth, &newHeight) == 2) && (newWidth > 0) && (newHeight > 0)) {
+					resizeWindow(newWidth, newHeight);
+				} else {
+					std::cerr << "Invalid resolution \"" << parameter.second << "\", expected <width>x<height>" << "\n";
+				}
+			} else if (!applySweepParameter(parameter.first, parameter.second)) {
+				std::cerr << "Unknown benchmark sweep parameter \"" << parameter.first << "\"" << "\n";
+			}
+		}
+		vkDeviceWaitIdle(device);
+		benchmark.reset();
+		cameraPathFrame = 0;
+		benchmark.run([=] { VKS_TRACE_SCOPE("frame"); updateCameraPath(); render(); }, vulkanDevice->properties);
+		vkDeviceWaitIdle(device);
+		// The actual size may differ from the requested one if the window could not be resized
+		benchmark.addSweepResult(configuration, width, height);
+	}
+	if (benchmark.filename != "") {
+		benchmark.saveSweepResults();
+	}
+}
+
 void VulkanExampleBase::initSwapchain()
 {
+	if (settings.headless) {
+		// Prefer the formats a swap chain would typically use, so examples render the same way
+		VkFormat headlessFormat = VK_FORMAT_UNDEFINED;
+		for (VkFormat format : { VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM }) {
+			VkFormatProperties formatProperties;
+			vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+			const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT;
+			if ((formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures) {
+				headlessFormat = format;
+				break;
+			}
+		}
+		if (headlessFormat == VK_FORMAT_UNDEFINED) {
+			vks::tools::exitFatal("Could not find a color format for headless rendering!", -1);
+		}
+		swapChain.initHeadless(queue, vulkanDevice->queueFamilyIndices.graphics, headlessFormat);
+		return;
+	}
 #if defined(_WIN32)
 	swapChain.initSurface(windowInstance, window);
 #elif defined(VK_USE_PLATFORM_ANDROID_KHR)
@@ -68,9 +68,15 @@
 #include "VulkanBuffer.h"
 #include "VulkanDevice.h"
 #include "VulkanTexture.h"
+#include "VulkanUniformRingBuffer.h"
+#include "VulkanProfiler.h"
+#include "VulkanFrameReadback.h"
+#include "VulkanPipelineQueue.h"
+#include "VulkanTrace.h"
 
 #include "VulkanInitializers.hpp"
 #include "camera.hpp"
+#include "camerapath.hpp"
 #include "benchmark.hpp"
 
 class VulkanExampleBase
@@ -83,13 +89,22 @@ private:
 	void handleMouseMove(int32_t x, int32_t y);
 	void nextFrame();
 	void updateOverlay();
+	void updateCameraPath();
 	void createPipelineCache();
+	void savePipelineCache();
+	std::string getPipelineCacheFileName() const;
 	void createCommandPool();
 	void createSynchronizationPrimitives();
+	void createFramesInFlight();
+	void destroyFramesInFlight();
+	void createRenderCompleteSemaphores();
 	void initSwapchain();
 	void setupSwapChain();
 	void createCommandBuffers();
 	void destroyCommandBuffers();
+	void resizeWindow(uint32_t newWidth, uint32_t newHeight);
+	bool loadBenchmarkSweep(const std::string& filename);
+	void runBenchmarkSweep();
 	std::string shaderDir = "glsl";
 protected:
 	// Returns the path to the root of the glsl or hlsl shader directory.
@@ -97,6 +112,9 @@ protected:
 
 	// Frame counter to display fps
 	uint32_t frameCounter = 0;
+	// Frames since start for camera path playback and recording outside of benchmark runs
+	uint32_t cameraPathFrame = 0;
+	std::string cameraPathRecordFile;
 	uint32_t lastFPS = 0;
 	std::chrono::time_point<std::chrono::high_resolution_clock> lastTimestamp, tPrevEnd;
 	// Vulkan instance, stores all per-application states
@@ -143,6 +161,8 @@ protected:
 	std::vector<VkShaderModule> shaderModules;
 	// Pipeline cache object
 	VkPipelineCache pipelineCache{ VK_NULL_HANDLE };
+	/** @brief Pipelines added to this queue are created in parallel against the pipeline cache when build() is called */
+	vks::PipelineQueue pipelineQueue;
 	// Wraps the swap chain to present images (framebuffers) to the windowing system
 	VulkanSwapChain swapChain;
 	// Synchronization semaphores
@@ -153,7 +173,31 @@ protected:
 		VkSemaphore renderComplete;
 	} semaphores;
 	std::vector<VkFence> waitFences;
+	/** @brief Per-frame synchronization and command buffer used when rendering with multiple frames in flight */
+	struct FrameInFlight {
+		VkFence fence{ VK_NULL_HANDLE };
+		VkSemaphore presentComplete{ VK_NULL_HANDLE };
+		VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+	};
+	std::vector<FrameInFlight> framesInFlight;
+	// Signalled by the submission of a frame in flight and waited on by the presentation, indexed by swap chain image
+	// A semaphore is only signalled again once its image has been acquired again, i.e. after the previous presentation has waited on it
+	std::vector<VkSemaphore> renderCompleteSemaphores;
+	// Set by examples that record their command buffer every frame and keep per-frame copies of all host written resources
+	bool useFramesInFlight{ false };
+	// Number of frames the CPU may record ahead of the GPU (can be changed with --framesinflight)
+	uint32_t maxFramesInFlight{ 2 };
+	// Index into framesInFlight of the frame currently being recorded
+	uint32_t currentFrame{ 0 };
+	// Start of the CPU work of the current frame after its fence wait, used for the CPU time of benchmark frames
+	std::chrono::time_point<std::chrono::high_resolution_clock> frameCpuStart;
+	// Per-frame uniform data, created by the example with one region per frame in flight and advanced in beginFrame()
+	vks::UniformRingBuffer uniformRing;
+	// GPU pass timings, created by the example with one query pool per frame in flight, shown in the overlay and added to benchmark results
+	vks::GpuProfiler profiler;
 	bool requiresStencil{ false };
+	// Set by examples that want buffers and images uploaded in batches on the transfer queue, enables VK_KHR_timeline_semaphore and creates vks::Uploader if the device supports them
+	bool enableUploadManager{ false };
 public:
 	bool prepared = false;
 	bool resized = false;
@@ -182,6 +226,8 @@ public:
 		bool vsync = false;
 		/** @brief Enable UI overlay */
 		bool overlay = true;
+		/** @brief Render into images owned by the swap chain class without a window, surface or swap chain (e.g. on CI machines with a software implementation) */
+		bool headless = false;
 	} settings;
 
 	/** @brief State of gamepad input (only used on Android) */
@@ -212,6 +258,28 @@ public:
 	bool paused = false;
 
 	Camera camera;
+	/** @brief Camera keyframes played back by frame index (--camerapath) or recorded while running (--camerapathrecord) */
+	vks::CameraPath cameraPath;
+	/** @brief Configurations benchmarked one after another in the same process (--benchsweep), each one is a list of parameter name and value pairs */
+	std::vector<std::vector<std::pair<std::string, std::string>>> benchmarkSweep;
+	/** @brief Load the pipeline cache at startup and save it at shutdown, can be disabled with --nopipelinecache */
+	bool persistentPipelineCache = true;
+	/** @brief Size of the pipeline cache data loaded at startup, zero if the cache was cold */
+	size_t loadedPipelineCacheSize = 0;
+	/** @brief Time in milliseconds spent creating pipelines outside of pipelineQueue, added by examples that create pipelines themselves */
+	double pipelineCreationTime = 0.0;
+	/** @brief Set by examples that still create pipelines in the background once rendering starts, they call reportPipelineCreationTime() when done */
+	bool deferPipelineCreationReport = false;
+	/** @brief Frames rendered by headless runs outside of benchmark mode */
+	uint32_t headlessFrameCount = 1;
+	/** @brief If set, every headless frame is copied back to the host and written to <prefix>_<frame>.png (or .raw) by frameReadback */
+	std::string headlessReadbackPrefix;
+	vks::FrameReadback::Encoding headlessReadbackEncoding = vks::FrameReadback::Encoding::PNG;
+	uint32_t headlessReadbackLatency = 4;
+	/** @brief Streams the rendered frames to disk on worker threads, created in prepare() if requested */
+	vks::FrameReadback frameReadback;
+	/** @brief If set, CPU trace markers are recorded from startup on and written to this file (Chrome trace event JSON) at shutdown */
+	std::string traceFileName;
 
 	std::string title = "Vulkan Example";
 	std::string name = "vulkanExample";
@@ -369,6 +437,8 @@ public:
 	virtual void mouseMoved(double x, double y, bool &handled);
 	/** @brief (Virtual) Called when the window has been resized, can be used by the sample application to recreate resources */
 	virtual void windowResized();
+	/** @brief (Virtual) Called for each parameter of a benchmark sweep configuration not handled by the base class (e.g. resolution), returns false if the parameter is unknown */
+	virtual bool applySweepParameter(const std::string& name, const std::string& value);
 	/** @brief (Virtual) Called when resources have been recreated that require a rebuild of the command buffers (e.g. frame buffer), to be implemented by the sample application */
 	virtual void buildCommandBuffers();
 	/** @brief (Virtual) Setup default depth and stencil views */
@@ -392,6 +462,8 @@ public:
 
 	/** @brief Entry point for the main render loop */
 	void renderLoop();
+	/** @brief Prints the time spent creating pipelines together with the state of the pipeline cache */
+	void reportPipelineCreationTime();
 
 	/** @brief Adds the drawing commands for the ImGui overlay to the given command buffer */
 	void drawUI(const VkCommandBuffer commandBuffer);
@@ -400,6 +472,10 @@ public:
 	void prepareFrame();
 	/** @brief Presents the current image to the swap chain */
 	void submitFrame();
+	/** @brief Waits until the current frame in flight can be reused and acquires the next swap chain image, returns false if the frame has to be skipped */
+	bool beginFrame();
+	/** @brief Submits the command buffer of the current frame in flight, presents it and advances to the next frame in flight */
+	void endFrame();
 	/** @brief (Virtual) Default image acquire + submission and command buffer submission function */
 	virtual void renderFrame();
 
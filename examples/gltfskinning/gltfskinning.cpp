@@ -46,10 +46,7 @@ VulkanglTFModel::~VulkanglTFModel()
 	vkFreeMemory(vulkanDevice->logicalDevice, indices.memory, nullptr);
 	for (Image image : images)
 	{
-		vkDestroyImageView(vulkanDevice->logicalDevice, image.texture.view, nullptr);
-		vkDestroyImage(vulkanDevice->logicalDevice, image.texture.image, nullptr);
-		vkDestroySampler(vulkanDevice->logicalDevice, image.texture.sampler, nullptr);
-		vkFreeMemory(vulkanDevice->logicalDevice, image.texture.deviceMemory, nullptr);
+		image.texture.destroy();
 	}
 	for (Skin skin : skins)
 	{
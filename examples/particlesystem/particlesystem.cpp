@@ -105,6 +105,8 @@ public:
 	VulkanExample() : VulkanExampleBase()
 	{
 		title = "CPU based particle system";
+		// The textures and the model are uploaded in one batch on the transfer queue
+		enableUploadManager = true;
 		camera.type = Camera::CameraType::lookat;
 		camera.setPosition(glm::vec3(0.0f, 0.0f, -75.0f));
 		camera.setRotation(glm::vec3(-15.0f, 45.0f, 0.0f));
@@ -316,6 +318,13 @@ public:
 
 	void loadAssets()
 	{
+		// All uploads are recorded into one batch that is waited for once, instead of one fence wait per texture
+		// Without the upload manager each loader submits and waits for its own copy
+		const bool batchUploads = vulkanDevice->uploader.isCreated();
+		if (batchUploads) {
+			vulkanDevice->uploader.beginBatch();
+		}
+
 		// Particles
 		textures.particles.smoke.loadFromFile(getAssetPath() + "textures/particle_smoke.ktx", VK_FORMAT_R8G8B8A8_UNORM, vulkanDevice, queue);
 		textures.particles.fire.loadFromFile(getAssetPath() + "textures/particle_fire.ktx", VK_FORMAT_R8G8B8A8_UNORM, vulkanDevice, queue);
@@ -353,6 +362,10 @@ public:
 
 		const uint32_t glTFLoadingFlags = vkglTF::FileLoadingFlags::PreTransformVertices | vkglTF::FileLoadingFlags::PreMultiplyVertexColors | vkglTF::FileLoadingFlags::FlipY;
 		environment.loadFromFile(getAssetPath() + "models/fireplace.gltf", vulkanDevice, queue, glTFLoadingFlags);
+
+		if (batchUploads) {
+			vulkanDevice->uploader.wait(vulkanDevice->uploader.endBatch());
+		}
 	}
 
 	void setupDescriptors()
@@ -8,9 +8,21 @@
 
 #include "vulkanexamplebase.h"
 #include "VulkanglTFModel.h"
+#include "VulkanRenderGraph.h"
+#include "threadpool.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
 
+// Largest kernel size of the pipeline variants, the kernel UBO is allocated for this size
 #define SSAO_KERNEL_SIZE 64
 #define SSAO_RADIUS 0.3f
+// Must match the size of the level array in depthpyramid.comp
+#define DEPTH_PYRAMID_MAX_LEVELS 6
+// Deinterleaved SSAO uses one layer per pixel of a 4x4 block
+#define DEINTERLEAVE_LAYERS 16
+// Sample budget of the high sample GTAO reference used by the AO technique benchmark
+#define AO_REFERENCE_KERNEL_SIZE 1024
 
 // We use a smaller noise kernel size on Android due to lower computational power
 #if defined(__ANDROID__)
@@ -35,90 +47,403 @@ public:
 
 	struct UBOSSAOParams {
 		glm::mat4 projection;
+		glm::mat4 invProjection;
 		int32_t ssao = true;
 		int32_t ssaoOnly = false;
 		int32_t ssaoBlur = true;
+		// Temporal accumulation, the layout matches std140 (the matrix starts at a 16 byte boundary)
+		int32_t frameIndex = 0;
+		glm::mat4 reprojection;
+		int32_t samplesPerFrame = SSAO_KERNEL_SIZE;
+		int32_t resetHistory = true;
+		int32_t depthPyramidLevels = 0;
 	} uboSSAOParams;
 
+	// Ambient occlusion techniques, all of them read the SSAO descriptor set and write the single channel SSAO target
+	// The compute and deinterleaved paths are only implemented for the Crytek style hemisphere kernel
+	enum AOTechnique { AOTechniqueCrytek = 0, AOTechniqueHBAO = 1, AOTechniqueGTAO = 2, AOTechniqueCount = 3 };
+	const std::vector<std::string> aoTechniqueNames = { "Crytek", "HBAO", "GTAO" };
+	const std::array<std::string, AOTechniqueCount> aoTechniqueShaders = { "ssao.frag.spv", "hbao.frag.spv", "gtao.frag.spv" };
+	int32_t aoTechnique = AOTechniqueCrytek;
+
 	struct {
 		VkPipeline offscreen{ VK_NULL_HANDLE };
 		VkPipeline composition{ VK_NULL_HANDLE };
-		VkPipeline ssao{ VK_NULL_HANDLE };
+		// One fragment shader pipeline per AO technique, this and the compute, deinterleaved and temporal SSAO pipelines are those of the active variant
+		std::array<VkPipeline, AOTechniqueCount> ssao{};
+		// High sample GTAO, only created for the AO technique benchmark
+		VkPipeline ssaoReference{ VK_NULL_HANDLE };
 		VkPipeline ssaoBlur{ VK_NULL_HANDLE };
+		VkPipeline ssaoBlurFragment{ VK_NULL_HANDLE };
+		VkPipeline ssaoCompute{ VK_NULL_HANDLE };
+		VkPipeline depthDownsample{ VK_NULL_HANDLE };
+		VkPipeline upsample{ VK_NULL_HANDLE };
+		VkPipeline temporal{ VK_NULL_HANDLE };
+		VkPipeline depthPyramid{ VK_NULL_HANDLE };
+		VkPipeline deinterleave{ VK_NULL_HANDLE };
+		VkPipeline ssaoDeinterleaved{ VK_NULL_HANDLE };
+		VkPipeline reinterleave{ VK_NULL_HANDLE };
 	} pipelines;
 
 	struct {
 		VkPipelineLayout gBuffer{ VK_NULL_HANDLE };
 		VkPipelineLayout ssao{ VK_NULL_HANDLE };
 		VkPipelineLayout ssaoBlur{ VK_NULL_HANDLE };
+		VkPipelineLayout ssaoBlurFragment{ VK_NULL_HANDLE };
 		VkPipelineLayout composition{ VK_NULL_HANDLE };
+		VkPipelineLayout depthDownsample{ VK_NULL_HANDLE };
+		VkPipelineLayout upsample{ VK_NULL_HANDLE };
+		VkPipelineLayout temporal{ VK_NULL_HANDLE };
+		VkPipelineLayout depthPyramid{ VK_NULL_HANDLE };
+		VkPipelineLayout deinterleave{ VK_NULL_HANDLE };
+		VkPipelineLayout ssaoDeinterleaved{ VK_NULL_HANDLE };
+		VkPipelineLayout reinterleave{ VK_NULL_HANDLE };
 	} pipelineLayouts;
 
 	struct {
 		VkDescriptorSet gBuffer{ VK_NULL_HANDLE };
 		VkDescriptorSet ssao{ VK_NULL_HANDLE };
-		VkDescriptorSet ssaoBlur{ VK_NULL_HANDLE };
+		VkDescriptorSet ssaoBlurHorizontal{ VK_NULL_HANDLE };
+		VkDescriptorSet ssaoBlurVertical{ VK_NULL_HANDLE };
+		VkDescriptorSet ssaoBlurFragment{ VK_NULL_HANDLE };
 		VkDescriptorSet composition{ VK_NULL_HANDLE };
-		const uint32_t count = 4;
+		VkDescriptorSet depthDownsample{ VK_NULL_HANDLE };
+		VkDescriptorSet upsample{ VK_NULL_HANDLE };
+		VkDescriptorSet temporal{ VK_NULL_HANDLE };
+		VkDescriptorSet depthPyramid{ VK_NULL_HANDLE };
+		VkDescriptorSet deinterleave{ VK_NULL_HANDLE };
+		VkDescriptorSet ssaoDeinterleaved{ VK_NULL_HANDLE };
+		VkDescriptorSet reinterleave{ VK_NULL_HANDLE };
+		const uint32_t count = 13;
 	} descriptorSets;
 
 	struct {
 		VkDescriptorSetLayout gBuffer{ VK_NULL_HANDLE };
 		VkDescriptorSetLayout ssao{ VK_NULL_HANDLE };
 		VkDescriptorSetLayout ssaoBlur{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout ssaoBlurFragment{ VK_NULL_HANDLE };
 		VkDescriptorSetLayout composition{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout depthDownsample{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout upsample{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout temporal{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout depthPyramid{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout deinterleave{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout ssaoDeinterleaved{ VK_NULL_HANDLE };
+		VkDescriptorSetLayout reinterleave{ VK_NULL_HANDLE };
 	} descriptorSetLayouts;
 
+	// Uniform data is written to the base's ring buffer every frame, the descriptors are bound with the allocations' dynamic offsets
 	struct {
-		vks::Buffer sceneParams;
-		vks::Buffer ssaoKernel;
-		vks::Buffer ssaoParams;
-	} uniformBuffers;
-
-	// Framebuffer for offscreen rendering
-	struct FrameBufferAttachment {
-		VkImage image;
-		VkDeviceMemory mem;
-		VkImageView view;
-		VkFormat format;
-		void destroy(VkDevice device)
-		{
-			vkDestroyImage(device, image, nullptr);
-			vkDestroyImageView(device, view, nullptr);
-			vkFreeMemory(device, mem, nullptr);
-		}
-	};
-	struct FrameBuffer {
-		int32_t width, height;
-		VkFramebuffer frameBuffer;
-		VkRenderPass renderPass;
-		void setSize(int32_t w, int32_t h)
-		{
-			this->width = w;
-			this->height = h;
-		}
-		void destroy(VkDevice device)
-		{
-			vkDestroyFramebuffer(device, frameBuffer, nullptr);
-			vkDestroyRenderPass(device, renderPass, nullptr);
-		}
-	};
-
+		VkDescriptorBufferInfo sceneParams;
+		VkDescriptorBufferInfo ssaoKernel;
+		VkDescriptorBufferInfo ssaoParams;
+	} uniformDescriptors;
+	struct {
+		vks::UniformAllocation sceneParams;
+		vks::UniformAllocation ssaoKernel;
+		vks::UniformAllocation ssaoParams;
+	} uniformAllocations;
+
+	// Render targets and passes are declared in a render graph that derives the barriers between the passes
+	// Intermediate targets share memory, attachments that are only used within one pass are transient
+	vks::RenderGraph renderGraph;
+	struct {
+		vks::RenderGraph::ResourceHandle position, normal, albedo, depth;
+		vks::RenderGraph::ResourceHandle linearDepth, depthPyramid, ssao, temporal, history, blurIntermediate, blur, upsample;
+		vks::RenderGraph::ResourceHandle deinterleavedDepth, deinterleavedNormal, deinterleavedAO;
+	} renderTargets{};
+	// Render passes compatible with the graph's graphics passes, for pipeline creation
 	struct {
-		struct Offscreen : public FrameBuffer {
-			FrameBufferAttachment position, normal, albedo, depth;
-		} offscreen;
-		struct SSAO : public FrameBuffer {
-			FrameBufferAttachment color;
-		} ssao, ssaoBlur;
-	} frameBuffers{};
+		VkRenderPass gBuffer, linearDepth, ssao, temporal;
+	} renderPasses{};
+	// Size of all targets at SSAO resolution
+	VkExtent2D ssaoExtent{};
 
 	// One sampler for the frame buffer color attachments
 	VkSampler colorSampler;
 
+	// Min/max linear depth mip chain at SSAO resolution, built from the linear depth target with a single compute dispatch
+	uint32_t depthPyramidLevels = 0;
+	// Samples the pyramid levels without filtering between texels or levels
+	VkSampler depthPyramidSampler{ VK_NULL_HANDLE };
+
+	// Aliasing and transient attachments can be disabled to compare against every render target having its own memory
+	bool renderTargetAliasing = true;
+	vks::RenderGraph::MemoryStatistics renderTargetMemory;
+	// Settings the render graph has been built for
+	std::array<int32_t, 7> renderGraphConfiguration{};
+	// Profiler scopes spanning several passes of the graph
+	struct {
+		uint32_t ssao, blur;
+	} profilerScopes{};
+
+	// SSAO can either be generated with a fullscreen fragment shader pass or with a compute shader that caches depth tiles in shared memory
+	bool computeSSAO = false;
+	// The compute paths write to the SSAO targets as storage images, which is not supported for all formats on all devices
+	// This also decides between the separable compute blur and the fragment shader box blur fallback
+	bool computeSSAOSupported = false;
+	// View space positions can be reconstructed from the depth attachment instead of being stored in a wide position attachment
+	bool positionFromDepth = false;
+
+	// Encoding of the G-Buffer normals, values must match the constants in normalencoding.glsl
+	enum NormalEncoding { NormalEncodingRGBA8 = 0, NormalEncodingOct16 = 1, NormalEncodingOct8 = 2 };
+	NormalEncoding normalEncoding = NormalEncodingRGBA8;
+
+	// SSAO can be generated at full, half or quarter resolution and is then upsampled to full resolution
+	const std::vector<std::string> ssaoScaleNames = { "Full", "Half", "Quarter" };
+#if defined(__ANDROID__)
+	int32_t ssaoScaleIndex = 1;
+#else
+	int32_t ssaoScaleIndex = 0;
+#endif
+
+	// Radius in pixels (at SSAO resolution) of the separable blur, must not exceed MAX_RADIUS in blur.comp
+	int32_t blurRadius = 4;
+	// Push constants for the separable blur passes, must match the layout in blur.comp
+	struct BlurPushConstants {
+		glm::ivec2 direction;
+		int32_t radius;
+		float depthSharpness = 0.1f;
+	} blurPushConstants;
+
+	// Deinterleaved SSAO splits linear depth and normals into quarter resolution layers, one per 4x4 noise offset
+	// Each layer is processed with a constant rotation and the results are gathered back into the SSAO target before the blur
+	bool deinterleavedSSAO = false;
+	struct {
+		uint32_t width, height;
+	} deinterleavedLayers{};
+
+	// SSAO samples further away from the pixel read coarser levels of the depth pyramid
+	// Writing the two channel float format from a compute shader requires extended storage image formats
+	bool depthPyramidEnabled = true;
+	bool depthPyramidSupported = false;
+
+	// Pipelines that depend on the kernel size and radius specialization constants are built for all combinations of these values
+	// The variant selected at startup is built before the first frame, all other variants are built on a background thread
+	// A requested variant only becomes active once it is ready, so pipelines are never created on the render thread while rendering
+	const std::vector<uint32_t> ssaoKernelSizes = { 8, 16, 32, 64 };
+	// Sample radii in view space, larger radii become affordable with the depth pyramid
+	std::vector<float> ssaoRadii = { 0.15f, SSAO_RADIUS, 0.5f, 1.0f };
+	std::vector<std::string> ssaoKernelSizeNames;
+	std::vector<std::string> ssaoRadiusNames;
+	int32_t ssaoKernelSizeIndex = 3;
+	int32_t ssaoRadiusIndex = 1;
+	// Specialization constants shared by all SSAO pipelines, must match the constant ids in the SSAO shaders
+	struct SSAOSpecializationData {
+		uint32_t kernelSize;
+		float radius;
+		VkBool32 positionFromDepth;
+		int32_t normalEncoding;
+	};
+	const std::array<VkSpecializationMapEntry, 4> ssaoSpecializationMapEntries = {
+		vks::initializers::specializationMapEntry(0, offsetof(SSAOSpecializationData, kernelSize), sizeof(SSAOSpecializationData::kernelSize)),
+		vks::initializers::specializationMapEntry(1, offsetof(SSAOSpecializationData, radius), sizeof(SSAOSpecializationData::radius)),
+		vks::initializers::specializationMapEntry(2, offsetof(SSAOSpecializationData, positionFromDepth), sizeof(SSAOSpecializationData::positionFromDepth)),
+		vks::initializers::specializationMapEntry(3, offsetof(SSAOSpecializationData, normalEncoding), sizeof(SSAOSpecializationData::normalEncoding))
+	};
+	struct SSAOPipelineVariant {
+		uint32_t kernelSize = SSAO_KERNEL_SIZE;
+		float radius = SSAO_RADIUS;
+		std::array<VkPipeline, AOTechniqueCount> ssao{};
+		VkPipeline ssaoCompute{ VK_NULL_HANDLE };
+		VkPipeline ssaoDeinterleaved{ VK_NULL_HANDLE };
+		VkPipeline temporal{ VK_NULL_HANDLE };
+		// Set by the builder once all pipelines of the variant have been created
+		std::atomic<bool> ready{ false };
+	};
+	std::vector<SSAOPipelineVariant> ssaoPipelineVariants;
+	uint32_t activeSSAOVariant = 0;
+	// Shader stages of the variant pipelines, loaded on the main thread as the base class keeps track of all shader modules
+	struct {
+		VkPipelineShaderStageCreateInfo fullscreen;
+		std::array<VkPipelineShaderStageCreateInfo, AOTechniqueCount> ssao;
+		VkPipelineShaderStageCreateInfo ssaoCompute;
+		VkPipelineShaderStageCreateInfo ssaoDeinterleaved;
+		VkPipelineShaderStageCreateInfo temporal;
+	} ssaoVariantShaderStages{};
+	std::unique_ptr<vks::Thread> ssaoVariantBuilder;
+	std::atomic<bool> ssaoVariantBuilderCancelled{ false };
+	// Wall clock time the builder thread spent on the remaining variants, published to the render thread by ssaoVariantsBuilt
+	double ssaoVariantBuildTime = 0.0;
+	std::atomic<bool> ssaoVariantsBuilt{ false };
+	// One kernel per kernel size, the scale distribution of the samples depends on the size
+	std::vector<std::vector<glm::vec4>> ssaoKernels;
+
+	// Temporal SSAO only evaluates a subset of the kernel per frame and accumulates the results over several frames
+	bool temporalSSAO = false;
+	const std::vector<std::string> temporalSamplesNames = { "8", "16" };
+	int32_t temporalSamplesIndex = 1;
+	uint32_t temporalFrameIndex = 0;
+	// View-projection of the previous frame for reprojecting the history
+	glm::mat4 previousViewProjection = glm::mat4(1.0f);
+	bool historyResetPending = true;
+	// Accumulated AO, linear depth for disocclusion checks and number of accumulated frames
+	const VkFormat temporalFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+	// The AO technique benchmark plays back a camera path through the scene, each frame of the path is rendered with a high sample reference and then with every technique
+	// GPU times per pass are measured with timestamp queries and the raw AO of each technique is read back and compared to the reference
+	// Every frame in flight has its own query pool and readback buffer, which are read once beginFrame() has waited for the frame's fence
+	enum BenchmarkPass { BenchmarkPassGBuffer = 0, BenchmarkPassLinearDepth, BenchmarkPassAO, BenchmarkPassTemporal, BenchmarkPassBlur, BenchmarkPassUpsample, BenchmarkPassComposition, BenchmarkPassCount };
+	const std::array<std::string, BenchmarkPassCount> benchmarkPassNames = { "G-Buffer", "Linear depth", "AO", "Temporal", "Blur", "Upsample", "Composition" };
+	struct AOBenchmark {
+		bool active = false;
+		// The path passed with --camerapath or a default path through the scene
+		vks::CameraPath cameraPath;
+		uint32_t pathFrames = 0;
+		std::string filename = "aobenchmark.csv";
+		// Path frame and technique of the next submission, the technique is -1 while the reference is rendered
+		uint32_t frame = 0;
+		int32_t technique = -1;
+		uint32_t submitted = 0;
+		struct Submission {
+			// One timestamp before the first pass and one after each pass
+			VkQueryPool queryPool{ VK_NULL_HANDLE };
+			vks::Buffer readback;
+			uint32_t frame = 0;
+			int32_t technique = -1;
+			bool pending = false;
+		};
+		std::vector<Submission> submissions;
+		std::vector<uint8_t> reference;
+		struct Result {
+			std::array<double, BenchmarkPassCount> passTimes{};
+			double squaredError = 0.0;
+			uint64_t pixelCount = 0;
+		};
+		std::array<Result, AOTechniqueCount> results{};
+		bool renderingReference() const { return active && technique < 0; }
+		uint32_t getSubmissionCount() const { return pathFrames * (AOTechniqueCount + 1); }
+		bool running() const { return active && (submitted < getSubmissionCount()); }
+	} aoBenchmark;
+
+	// Per pixel memory and bandwidth cost of the G-Buffer for one of the position modes
+	struct GBufferFootprint {
+		uint32_t memory;
+		uint32_t gBufferWrite;
+		uint32_t ssaoRead;
+		uint32_t compositionRead;
+	} gBufferFootprints[2];
+	// Angular error in degrees of each normal encoding, shown in the overlay
+	struct NormalEncodingError {
+		double mean;
+		double max;
+	} normalEncodingErrors[3];
+
 	VulkanExample() : VulkanExampleBase()
 	{
 		title = "Screen space ambient occlusion";
+		// Command buffers are recorded per frame and all uniform buffers have per-frame slots
+		useFramesInFlight = true;
+		// The scene's textures and geometry are uploaded in one batch on the transfer queue
+		enableUploadManager = true;
+		// All options are registered before the arguments are parsed once
+		commandLineParser.add("computessao", { "-cs", "--computessao" }, 0, "Generate SSAO with a compute shader instead of a fragment shader");
+		commandLineParser.add("positionfromdepth", { "-pd", "--positionfromdepth" }, 0, "Reconstruct view space positions from the depth attachment instead of storing them in the G-Buffer");
+		commandLineParser.add("normalencoding", { "-ne", "--normalencoding" }, 1, "G-Buffer normal encoding (rgba8, oct16, oct8)");
+		commandLineParser.add("ssaoscale", { "-ss", "--ssaoscale" }, 1, "SSAO resolution divisor (1, 2 or 4)");
+		commandLineParser.add("blurradius", { "-blr", "--blurradius" }, 1, "SSAO blur radius in pixels (1..16)");
+		commandLineParser.add("temporalssao", { "-ts", "--temporalssao" }, 0, "Accumulate SSAO over several frames, evaluating only a subset of the kernel per frame");
+		commandLineParser.add("temporalsamples", { "-tss", "--temporalsamples" }, 1, "Kernel samples evaluated per frame with temporal SSAO (8 or 16)");
+		commandLineParser.add("deinterleavedssao", { "-dis", "--deinterleavedssao" }, 0, "Generate SSAO on deinterleaved quarter resolution layers (requires compute shader support)");
+		commandLineParser.add("nodepthpyramid", { "-ndp", "--nodepthpyramid" }, 0, "Read all SSAO samples from the full resolution linear depth instead of the depth pyramid");
+		commandLineParser.add("noaliasing", { "-nal", "--noaliasing" }, 0, "Give every render target its own memory instead of aliasing render targets with disjoint lifetimes and using transient attachments");
+		commandLineParser.add("ssaoradius", { "-sr", "--ssaoradius" }, 1, "SSAO sample radius in view space units");
+		commandLineParser.add("kernelsize", { "-ks", "--kernelsize" }, 1, "SSAO kernel size (8, 16, 32 or 64)");
+		commandLineParser.add("aotechnique", { "-ao", "--aotechnique" }, 1, "Ambient occlusion technique (crytek, hbao, gtao)");
+		commandLineParser.add("aobenchmark", { "-aob", "--aobenchmark" }, 0, "Render a camera path with every AO technique and report GPU time per pass and the error against a high sample reference");
+		commandLineParser.add("aobenchmarkfile", { "-aobf", "--aobenchmarkfile" }, 1, "Result file of the AO technique benchmark");
+		commandLineParser.parse(args);
+
+		computeSSAO = commandLineParser.isSet("computessao");
+		positionFromDepth = commandLineParser.isSet("positionfromdepth");
+		if (commandLineParser.isSet("normalencoding")) {
+			const std::string encoding = commandLineParser.getValueAsString("normalencoding", "rgba8");
+			if (encoding == "oct16") {
+				normalEncoding = NormalEncodingOct16;
+			} else if (encoding == "oct8") {
+				normalEncoding = NormalEncodingOct8;
+			} else if (encoding != "rgba8") {
+				std::cerr << "Unknown normal encoding \"" << encoding << "\", using rgba8\n";
+			}
+		}
+		if (commandLineParser.isSet("ssaoscale")) {
+			const int32_t scale = commandLineParser.getValueAsInt("ssaoscale", 1);
+			ssaoScaleIndex = (scale >= 4) ? 2 : (scale >= 2) ? 1 : 0;
+		}
+		if (commandLineParser.isSet("blurradius")) {
+			blurRadius = std::max(1, std::min(commandLineParser.getValueAsInt("blurradius", blurRadius), 16));
+		}
+		temporalSSAO = commandLineParser.isSet("temporalssao");
+		if (commandLineParser.isSet("temporalsamples")) {
+			temporalSamplesIndex = (commandLineParser.getValueAsInt("temporalsamples", 16) <= 8) ? 0 : 1;
+		}
+		deinterleavedSSAO = commandLineParser.isSet("deinterleavedssao");
+		depthPyramidEnabled = !commandLineParser.isSet("nodepthpyramid");
+		renderTargetAliasing = !commandLineParser.isSet("noaliasing");
+		// Radii of a benchmark sweep are added before the variants are built, so switching between configurations never creates pipelines
+		// Invalid radii are skipped here and reported when the sweep applies them
+		for (const auto& configuration : benchmarkSweep) {
+			for (const auto& parameter : configuration) {
+				float radius;
+				if ((parameter.first == "radius") && parsePositiveFloat(parameter.second, radius)) {
+					addSSAORadius(radius);
+				}
+			}
+		}
+		ssaoRadiusIndex = addSSAORadius(SSAO_RADIUS);
+		if (commandLineParser.isSet("ssaoradius")) {
+			const std::string value = commandLineParser.getValueAsString("ssaoradius", "");
+			float radius;
+			if (parsePositiveFloat(value, radius)) {
+				ssaoRadiusIndex = addSSAORadius(radius);
+			} else {
+				std::cerr << "Invalid SSAO radius \"" << value << "\", using " << SSAO_RADIUS << "\n";
+			}
+		}
+		if (commandLineParser.isSet("kernelsize")) {
+			ssaoKernelSizeIndex = getSSAOKernelSizeIndex(commandLineParser.getValueAsInt("kernelsize", SSAO_KERNEL_SIZE));
+		}
+		for (uint32_t kernelSize : ssaoKernelSizes) {
+			ssaoKernelSizeNames.push_back(std::to_string(kernelSize));
+		}
+		for (float radius : ssaoRadii) {
+			char name[16];
+			snprintf(name, sizeof(name), "%.2f", radius);
+			ssaoRadiusNames.push_back(name);
+		}
+		if (commandLineParser.isSet("aotechnique")) {
+			const std::string technique = commandLineParser.getValueAsString("aotechnique", "crytek");
+			if (technique == "hbao") {
+				aoTechnique = AOTechniqueHBAO;
+			} else if (technique == "gtao") {
+				aoTechnique = AOTechniqueGTAO;
+			} else if (technique != "crytek") {
+				std::cerr << "Unknown AO technique \"" << technique << "\", using crytek\n";
+			}
+		}
+		if (commandLineParser.isSet("aobenchmark")) {
+			aoBenchmark.active = true;
+			aoBenchmark.filename = commandLineParser.getValueAsString("aobenchmarkfile", aoBenchmark.filename);
+			// The path is played back by the AO benchmark itself, as every path frame is rendered once per technique
+			if (!cameraPath.empty()) {
+				aoBenchmark.cameraPath = cameraPath;
+				cameraPath.keyframes.clear();
+				benchmark.segmentNames.clear();
+			} else {
+				createDefaultAOBenchmarkPath();
+			}
+			aoBenchmark.pathFrames = aoBenchmark.cameraPath.getFrameCount();
+			// Temporal accumulation would mix the techniques, the run uses the base benchmark loop with one submission per technique and path frame
+			temporalSSAO = false;
+			// All techniques and the reference are compared as fragment shaders, so the render graph stays the same for the whole run
+			computeSSAO = false;
+			deinterleavedSSAO = false;
+			benchmark.active = true;
+			benchmark.warmup = 0;
+			benchmark.duration = std::numeric_limits<uint32_t>::max();
+			benchmark.outputFrames = static_cast<int>(aoBenchmark.getSubmissionCount());
+			vks::tools::errorModeSilent = true;
+		}
 		camera.type = Camera::CameraType::firstperson;
 #ifndef __ANDROID__
 		camera.rotationSpeed = 0.25f;
@@ -131,338 +456,596 @@ public:
 	~VulkanExample()
 	{
 		if (device) {
-			vkDestroySampler(device, colorSampler, nullptr);
+			// Variants may still be built in the background
+			ssaoVariantBuilderCancelled = true;
+			ssaoVariantBuilder.reset();
 
-			// Attachments
-			frameBuffers.offscreen.position.destroy(device);
-			frameBuffers.offscreen.normal.destroy(device);
-			frameBuffers.offscreen.albedo.destroy(device);
-			frameBuffers.offscreen.depth.destroy(device);
-			frameBuffers.ssao.color.destroy(device);
-			frameBuffers.ssaoBlur.color.destroy(device);
-
-			// Framebuffers
-			frameBuffers.offscreen.destroy(device);
-			frameBuffers.ssao.destroy(device);
-			frameBuffers.ssaoBlur.destroy(device);
+			vkDestroySampler(device, colorSampler, nullptr);
+			vkDestroySampler(device, depthPyramidSampler, nullptr);
+			renderGraph.destroy();
 
 			vkDestroyPipeline(device, pipelines.offscreen, nullptr);
 			vkDestroyPipeline(device, pipelines.composition, nullptr);
-			vkDestroyPipeline(device, pipelines.ssao, nullptr);
-			vkDestroyPipeline(device, pipelines.ssaoBlur, nullptr);
+			// The SSAO, compute SSAO, deinterleaved SSAO and temporal pipelines are owned by the variants
+			for (SSAOPipelineVariant& variant : ssaoPipelineVariants) {
+				for (VkPipeline pipeline : { variant.ssao[0], variant.ssao[1], variant.ssao[2], variant.ssaoCompute, variant.ssaoDeinterleaved, variant.temporal }) {
+					if (pipeline != VK_NULL_HANDLE) {
+						vkDestroyPipeline(device, pipeline, nullptr);
+					}
+				}
+			}
+			if (pipelines.ssaoReference != VK_NULL_HANDLE) {
+				vkDestroyPipeline(device, pipelines.ssaoReference, nullptr);
+			}
+			if (pipelines.ssaoBlur != VK_NULL_HANDLE) {
+				vkDestroyPipeline(device, pipelines.ssaoBlur, nullptr);
+			}
+			vkDestroyPipeline(device, pipelines.ssaoBlurFragment, nullptr);
+			vkDestroyPipeline(device, pipelines.depthDownsample, nullptr);
+			vkDestroyPipeline(device, pipelines.upsample, nullptr);
+			if (pipelines.depthPyramid != VK_NULL_HANDLE) {
+				vkDestroyPipeline(device, pipelines.depthPyramid, nullptr);
+			}
+			for (VkPipeline pipeline : { pipelines.deinterleave, pipelines.reinterleave }) {
+				if (pipeline != VK_NULL_HANDLE) {
+					vkDestroyPipeline(device, pipeline, nullptr);
+				}
+			}
 
 			vkDestroyPipelineLayout(device, pipelineLayouts.gBuffer, nullptr);
 			vkDestroyPipelineLayout(device, pipelineLayouts.ssao, nullptr);
 			vkDestroyPipelineLayout(device, pipelineLayouts.ssaoBlur, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.ssaoBlurFragment, nullptr);
 			vkDestroyPipelineLayout(device, pipelineLayouts.composition, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.depthDownsample, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.upsample, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.temporal, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.depthPyramid, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.deinterleave, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.ssaoDeinterleaved, nullptr);
+			vkDestroyPipelineLayout(device, pipelineLayouts.reinterleave, nullptr);
 
 			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.gBuffer, nullptr);
 			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.ssao, nullptr);
 			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.ssaoBlur, nullptr);
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.ssaoBlurFragment, nullptr);
 			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.composition, nullptr);
-
-			// Uniform buffers
-			uniformBuffers.sceneParams.destroy();
-			uniformBuffers.ssaoKernel.destroy();
-			uniformBuffers.ssaoParams.destroy();
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.depthDownsample, nullptr);
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.upsample, nullptr);
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.temporal, nullptr);
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.depthPyramid, nullptr);
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.deinterleave, nullptr);
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.ssaoDeinterleaved, nullptr);
+			vkDestroyDescriptorSetLayout(device, descriptorSetLayouts.reinterleave, nullptr);
 
 			ssaoNoise.destroy();
+
+			for (AOBenchmark::Submission& submission : aoBenchmark.submissions) {
+				vkDestroyQueryPool(device, submission.queryPool, nullptr);
+				submission.readback.destroy();
+			}
 		}
 	}
 
 	void getEnabledFeatures()
 	{
 		enabledFeatures.samplerAnisotropy = deviceFeatures.samplerAnisotropy;
+		// Writing to the single channel SSAO target from a compute shader requires the r8 storage image format
+		enabledFeatures.shaderStorageImageExtendedFormats = deviceFeatures.shaderStorageImageExtendedFormats;
 	}
 
-	// Create a frame buffer attachment
-	void createAttachment(
-		VkFormat format,
-		VkImageUsageFlagBits usage,
-		FrameBufferAttachment *attachment,
-		uint32_t width,
-		uint32_t height)
+	// Returns the divisor of the SSAO resolution relative to the full resolution
+	uint32_t getSSAOScale()
 	{
-		VkImageAspectFlags aspectMask = 0;
+		return 1u << ssaoScaleIndex;
+	}
 
-		attachment->format = format;
+	// Returns the depth format used by the G-Buffer for the given position mode
+	VkFormat getGBufferDepthFormat(bool fromDepth)
+	{
+		VkFormat depthFormat;
+		if (fromDepth) {
+			// The depth attachment is sampled for position reconstruction, so this requires a depth only format that can also be sampled
+			const std::vector<VkFormat> formatList = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM };
+			for (auto& format : formatList) {
+				VkFormatProperties formatProps;
+				vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProps);
+				if ((formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) && (formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+					return format;
+				}
+			}
+			vks::tools::exitFatal("Could not find a depth format that supports sampling", -1);
+		}
+		VkBool32 validDepthFormat = vks::tools::getSupportedDepthFormat(physicalDevice, &depthFormat);
+		assert(validDepthFormat);
+		return depthFormat;
+	}
 
-		if (usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
-		{
-			aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	// Returns the format of the normal attachment for the given encoding
+	VkFormat getNormalFormat(NormalEncoding encoding)
+	{
+		switch (encoding) {
+		case NormalEncodingOct16: {
+			// Color attachment support for SNORM formats is optional, half floats are used as a fallback
+			VkFormatProperties formatProps;
+			vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R16G16_SNORM, &formatProps);
+			return (formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT) ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R16G16_SFLOAT;
 		}
-		if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
-		{
-			aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-			if (format >= VK_FORMAT_D16_UNORM_S8_UINT)
-				aspectMask |=VK_IMAGE_ASPECT_STENCIL_BIT;
-		}
-
-		assert(aspectMask > 0);
-
-		VkImageCreateInfo image = vks::initializers::imageCreateInfo();
-		image.imageType = VK_IMAGE_TYPE_2D;
-		image.format = format;
-		image.extent.width = width;
-		image.extent.height = height;
-		image.extent.depth = 1;
-		image.mipLevels = 1;
-		image.arrayLayers = 1;
-		image.samples = VK_SAMPLE_COUNT_1_BIT;
-		image.tiling = VK_IMAGE_TILING_OPTIMAL;
-		image.usage = usage | VK_IMAGE_USAGE_SAMPLED_BIT;
-
-		VkMemoryAllocateInfo memAlloc = vks::initializers::memoryAllocateInfo();
-		VkMemoryRequirements memReqs;
-
-		VK_CHECK_RESULT(vkCreateImage(device, &image, nullptr, &attachment->image));
-		vkGetImageMemoryRequirements(device, attachment->image, &memReqs);
-		memAlloc.allocationSize = memReqs.size;
-		memAlloc.memoryTypeIndex = vulkanDevice->getMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-		VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &attachment->mem));
-		VK_CHECK_RESULT(vkBindImageMemory(device, attachment->image, attachment->mem, 0));
-
-		VkImageViewCreateInfo imageView = vks::initializers::imageViewCreateInfo();
-		imageView.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		imageView.format = format;
-		imageView.subresourceRange = {};
-		imageView.subresourceRange.aspectMask = aspectMask;
-		imageView.subresourceRange.baseMipLevel = 0;
-		imageView.subresourceRange.levelCount = 1;
-		imageView.subresourceRange.baseArrayLayer = 0;
-		imageView.subresourceRange.layerCount = 1;
-		imageView.image = attachment->image;
-		VK_CHECK_RESULT(vkCreateImageView(device, &imageView, nullptr, &attachment->view));
-	}
-
-	void prepareOffscreenFramebuffers()
-	{
-		// Attachments
-#if defined(__ANDROID__)
-		const uint32_t ssaoWidth = width / 2;
-		const uint32_t ssaoHeight = height / 2;
-#else
-		const uint32_t ssaoWidth = width;
-		const uint32_t ssaoHeight = height;
-#endif
+		case NormalEncodingOct8:
+			return VK_FORMAT_R8G8_UNORM;
+		default:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+		}
+	}
 
-		frameBuffers.offscreen.setSize(width, height);
-		frameBuffers.ssao.setSize(ssaoWidth, ssaoHeight);
-		frameBuffers.ssaoBlur.setSize(width, height);
+	// Host side implementation of the normal encodings in normalencoding.glsl including quantization to the attachment format
+	static glm::vec2 signNotZero(glm::vec2 v)
+	{
+		return glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+	}
 
-		// Find a suitable depth format
-		VkFormat attDepthFormat;
-		VkBool32 validDepthFormat = vks::tools::getSupportedDepthFormat(physicalDevice, &attDepthFormat);
-		assert(validDepthFormat);
+	static float quantize(float value, VkFormat format)
+	{
+		switch (format) {
+		case VK_FORMAT_R16G16_SNORM:
+			return std::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f) / 32767.0f;
+		case VK_FORMAT_R16G16_SFLOAT: {
+			// Round to the 11 significant bits of a half float
+			int exponent;
+			const float mantissa = std::frexp(value, &exponent);
+			return std::ldexp(std::round(std::ldexp(mantissa, 11)), exponent - 11);
+		}
+		default:
+			return std::round(glm::clamp(value, 0.0f, 1.0f) * 255.0f) / 255.0f;
+		}
+	}
 
-		// G-Buffer
-		createAttachment(VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, &frameBuffers.offscreen.position, width, height);	// Position + Depth
-		createAttachment(VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, &frameBuffers.offscreen.normal, width, height);			// Normals
-		createAttachment(VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, &frameBuffers.offscreen.albedo, width, height);			// Albedo (color)
-		createAttachment(attDepthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, &frameBuffers.offscreen.depth, width, height);			// Depth
+	glm::vec3 encodeDecodeNormal(glm::vec3 n, NormalEncoding encoding, VkFormat format)
+	{
+		if (encoding == NormalEncodingRGBA8) {
+			glm::vec3 encoded = n * 0.5f + 0.5f;
+			glm::vec3 decoded(quantize(encoded.x, format), quantize(encoded.y, format), quantize(encoded.z, format));
+			return glm::normalize(decoded * 2.0f - 1.0f);
+		}
+		n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		glm::vec2 e = (n.z >= 0.0f) ? glm::vec2(n.x, n.y) : (1.0f - glm::abs(glm::vec2(n.y, n.x))) * signNotZero(glm::vec2(n.x, n.y));
+		if (encoding == NormalEncodingOct8) {
+			e = glm::vec2(quantize(e.x * 0.5f + 0.5f, format), quantize(e.y * 0.5f + 0.5f, format)) * 2.0f - 1.0f;
+		} else {
+			e = glm::vec2(quantize(e.x, format), quantize(e.y, format));
+		}
+		glm::vec3 decoded(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+		if (decoded.z < 0.0f) {
+			glm::vec2 xy = (1.0f - glm::abs(glm::vec2(decoded.y, decoded.x))) * signNotZero(glm::vec2(decoded.x, decoded.y));
+			decoded.x = xy.x;
+			decoded.y = xy.y;
+		}
+		return glm::normalize(decoded);
+	}
 
-		// SSAO
-		createAttachment(VK_FORMAT_R8_UNORM, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, &frameBuffers.ssao.color, ssaoWidth, ssaoHeight);				// Color
+	static const uint32_t normalErrorDirectionCount = 100000;
 
-		// SSAO blur
-		createAttachment(VK_FORMAT_R8_UNORM, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, &frameBuffers.ssaoBlur.color, width, height);					// Color
+	// Measures the angular error of all normal encodings over a set of evenly distributed directions
+	void calculateNormalEncodingErrors()
+	{
+		const uint32_t directionCount = normalErrorDirectionCount;
+		for (uint32_t i = 0; i < 3; i++) {
+			const NormalEncoding encoding = static_cast<NormalEncoding>(i);
+			const VkFormat format = getNormalFormat(encoding);
+			double errorSum = 0.0;
+			double errorMax = 0.0;
+			// Spherical Fibonacci point set
+			for (uint32_t j = 0; j < directionCount; j++) {
+				const float z = 1.0f - (2.0f * j + 1.0f) / directionCount;
+				const float r = std::sqrt(1.0f - z * z);
+				const float phi = j * 2.39996323f;
+				const glm::vec3 n(r * std::cos(phi), r * std::sin(phi), z);
+				const glm::vec3 decoded = encodeDecodeNormal(n, encoding, format);
+				const double error = glm::degrees(std::acos(glm::clamp((double)glm::dot(n, decoded), -1.0, 1.0)));
+				errorSum += error;
+				errorMax = std::max(errorMax, error);
+			}
+			normalEncodingErrors[i] = { errorSum / directionCount, errorMax };
+		}
+	}
 
-		// Render passes
+	uint32_t getNormalFormatSize(VkFormat format)
+	{
+		return (format == VK_FORMAT_R8G8_UNORM) ? 2 : 4;
+	}
 
-		// G-Buffer creation
-		{
-			std::array<VkAttachmentDescription, 4> attachmentDescs = {};
+	// Calculates the per pixel memory and bandwidth of the G-Buffer for both position modes
+	// Bandwidth assumes one write per attachment and pixel and no framebuffer compression
+	// Depends on the kernel size of the active SSAO variant, recalculated whenever another variant is activated
+	void calculateGBufferFootprints()
+	{
+		auto depthFormatSize = [](VkFormat format) -> uint32_t {
+			switch (format) {
+			case VK_FORMAT_D16_UNORM: return 2;
+			case VK_FORMAT_D16_UNORM_S8_UINT: return 3;
+			case VK_FORMAT_D32_SFLOAT_S8_UINT: return 5;
+			default: return 4;
+			}
+		};
+		const uint32_t positionSize = 16;
+		const uint32_t normalSize = getNormalFormatSize(getNormalFormat(normalEncoding));
+		const uint32_t albedoSize = 4;
+		const uint32_t ssaoSize = 1;
+		const uint32_t linearDepthSize = 4;
+		const uint32_t kernelSize = ssaoPipelineVariants[activeSSAOVariant].kernelSize;
+		for (uint32_t i = 0; i < 2; i++) {
+			const bool fromDepth = (i == 1);
+			const uint32_t depthSize = depthFormatSize(getGBufferDepthFormat(fromDepth));
+			// Size of a single position (or depth) fetch
+			const uint32_t positionFetchSize = fromDepth ? depthSize : positionSize;
+			GBufferFootprint& footprint = gBufferFootprints[i];
+			footprint.memory = (fromDepth ? 0 : positionSize) + normalSize + albedoSize + depthSize;
+			footprint.gBufferWrite = footprint.memory;
+			// Center position, normal and one linear depth fetch per kernel sample
+			footprint.ssaoRead = positionFetchSize + normalSize + linearDepthSize * kernelSize;
+			footprint.compositionRead = positionFetchSize + normalSize + albedoSize + ssaoSize;
+		}
+	}
 
-			// Init attachment properties
-			for (uint32_t i = 0; i < static_cast<uint32_t>(attachmentDescs.size()); i++)
-			{
-				attachmentDescs[i].samples = VK_SAMPLE_COUNT_1_BIT;
-				attachmentDescs[i].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-				attachmentDescs[i].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-				attachmentDescs[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-				attachmentDescs[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-				attachmentDescs[i].finalLayout = (i == 3) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			}
-
-			// Formats
-			attachmentDescs[0].format = frameBuffers.offscreen.position.format;
-			attachmentDescs[1].format = frameBuffers.offscreen.normal.format;
-			attachmentDescs[2].format = frameBuffers.offscreen.albedo.format;
-			attachmentDescs[3].format = frameBuffers.offscreen.depth.format;
-
-			std::vector<VkAttachmentReference> colorReferences;
-			colorReferences.push_back({ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
-			colorReferences.push_back({ 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
-			colorReferences.push_back({ 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
-
-			VkAttachmentReference depthReference = {};
-			depthReference.attachment = 3;
-			depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-			VkSubpassDescription subpass = {};
-			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-			subpass.pColorAttachments = colorReferences.data();
-			subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
-			subpass.pDepthStencilAttachment = &depthReference;
-
-			// Use subpass dependencies for attachment layout transitions
-			std::array<VkSubpassDependency, 2> dependencies;
-
-			dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-			dependencies[0].dstSubpass = 0;
-			dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-			dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-			dependencies[1].srcSubpass = 0;
-			dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-			dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-			dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-			VkRenderPassCreateInfo renderPassInfo = {};
-			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-			renderPassInfo.pAttachments = attachmentDescs.data();
-			renderPassInfo.attachmentCount = static_cast<uint32_t>(attachmentDescs.size());
-			renderPassInfo.subpassCount = 1;
-			renderPassInfo.pSubpasses = &subpass;
-			renderPassInfo.dependencyCount = 2;
-			renderPassInfo.pDependencies = dependencies.data();
-			VK_CHECK_RESULT(vkCreateRenderPass(device, &renderPassInfo, nullptr, &frameBuffers.offscreen.renderPass));
-
-			std::array<VkImageView, 4> attachments;
-			attachments[0] = frameBuffers.offscreen.position.view;
-			attachments[1] = frameBuffers.offscreen.normal.view;
-			attachments[2] = frameBuffers.offscreen.albedo.view;
-			attachments[3] = frameBuffers.offscreen.depth.view;
-
-			VkFramebufferCreateInfo fbufCreateInfo = vks::initializers::framebufferCreateInfo();
-			fbufCreateInfo.renderPass = frameBuffers.offscreen.renderPass;
-			fbufCreateInfo.pAttachments = attachments.data();
-			fbufCreateInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-			fbufCreateInfo.width = frameBuffers.offscreen.width;
-			fbufCreateInfo.height = frameBuffers.offscreen.height;
-			fbufCreateInfo.layers = 1;
-			VK_CHECK_RESULT(vkCreateFramebuffer(device, &fbufCreateInfo, nullptr, &frameBuffers.offscreen.frameBuffer));
+	// Writes the G-Buffer footprints and normal encoding errors to the benchmark log, they are shown in the overlay otherwise
+	void printGBufferStatistics()
+	{
+		const char* encodingNames[3] = { "rgba8", "oct16", "oct8" };
+		std::cout << "G-Buffer normal encodings (angular error over " << normalErrorDirectionCount << " directions):\n";
+		std::cout << "encoding  bytes/pixel  mean error (deg)  max error (deg)\n";
+		for (uint32_t i = 0; i < 3; i++) {
+			const NormalEncoding encoding = static_cast<NormalEncoding>(i);
+			std::cout << std::left << std::setw(10) << encodingNames[i] << std::right
+				<< std::setw(11) << getNormalFormatSize(getNormalFormat(encoding))
+				<< std::fixed << std::setprecision(4)
+				<< std::setw(18) << normalEncodingErrors[i].mean
+				<< std::setw(17) << normalEncodingErrors[i].max
+				<< (normalEncoding == encoding ? "  (active)" : "") << "\n";
+		}
+		std::cout.unsetf(std::ios_base::floatfield);
+		const uint32_t normalSize = getNormalFormatSize(getNormalFormat(normalEncoding));
+		std::cout << "G-Buffer cost per pixel in bytes (kernel size " << ssaoPipelineVariants[activeSSAOVariant].kernelSize << ", normal encoding " << normalSize << " bytes):\n";
+		std::cout << "mode                 memory  g-buffer write  ssao read  composition read\n";
+		const char* modeNames[2] = { "position attachment", "position from depth" };
+		for (uint32_t i = 0; i < 2; i++) {
+			const GBufferFootprint& footprint = gBufferFootprints[i];
+			std::cout << std::left << std::setw(21) << modeNames[i] << std::right
+				<< std::setw(6) << footprint.memory
+				<< std::setw(16) << footprint.gBufferWrite
+				<< std::setw(11) << footprint.ssaoRead
+				<< std::setw(18) << footprint.compositionRead
+				<< (positionFromDepth == (i == 1) ? "  (active)" : "") << "\n";
 		}
+	}
 
-		// SSAO
-		{
-			VkAttachmentDescription attachmentDescription{};
-			attachmentDescription.format = frameBuffers.ssao.color.format;
-			attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
-			attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-			attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-			attachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-			attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-			attachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			attachmentDescription.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-			VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-
-			VkSubpassDescription subpass = {};
-			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-			subpass.pColorAttachments = &colorReference;
-			subpass.colorAttachmentCount = 1;
-
-			std::array<VkSubpassDependency, 2> dependencies;
-
-			dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-			dependencies[0].dstSubpass = 0;
-			dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-			dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-			dependencies[1].srcSubpass = 0;
-			dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-			dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-			dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-			VkRenderPassCreateInfo renderPassInfo = {};
-			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-			renderPassInfo.pAttachments = &attachmentDescription;
-			renderPassInfo.attachmentCount = 1;
-			renderPassInfo.subpassCount = 1;
-			renderPassInfo.pSubpasses = &subpass;
-			renderPassInfo.dependencyCount = 2;
-			renderPassInfo.pDependencies = dependencies.data();
-			VK_CHECK_RESULT(vkCreateRenderPass(device, &renderPassInfo, nullptr, &frameBuffers.ssao.renderPass));
-
-			VkFramebufferCreateInfo fbufCreateInfo = vks::initializers::framebufferCreateInfo();
-			fbufCreateInfo.renderPass = frameBuffers.ssao.renderPass;
-			fbufCreateInfo.pAttachments = &frameBuffers.ssao.color.view;
-			fbufCreateInfo.attachmentCount = 1;
-			fbufCreateInfo.width = frameBuffers.ssao.width;
-			fbufCreateInfo.height = frameBuffers.ssao.height;
-			fbufCreateInfo.layers = 1;
-			VK_CHECK_RESULT(vkCreateFramebuffer(device, &fbufCreateInfo, nullptr, &frameBuffers.ssao.frameBuffer));
+	// Only one of the SSAO paths is declared in the render graph, so the images of the other paths are never written
+	enum SSAOPath { SSAOPathFragment = 0, SSAOPathCompute, SSAOPathDeinterleaved };
+	SSAOPath getSSAOPath()
+	{
+		// The reference and the other AO techniques are only implemented as fragment shaders
+		const bool crytekSSAO = (aoTechnique == AOTechniqueCrytek) && !aoBenchmark.renderingReference();
+		if (crytekSSAO && deinterleavedSSAO) {
+			return SSAOPathDeinterleaved;
 		}
+		if (crytekSSAO && computeSSAO) {
+			return SSAOPathCompute;
+		}
+		return SSAOPathFragment;
+	}
 
-		// SSAO Blur
-		{
-			VkAttachmentDescription attachmentDescription{};
-			attachmentDescription.format = frameBuffers.ssaoBlur.color.format;
-			attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
-			attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-			attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-			attachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-			attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-			attachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			attachmentDescription.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-			VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-
-			VkSubpassDescription subpass = {};
-			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-			subpass.pColorAttachments = &colorReference;
-			subpass.colorAttachmentCount = 1;
-
-			std::array<VkSubpassDependency, 2> dependencies;
-
-			dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-			dependencies[0].dstSubpass = 0;
-			dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-			dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-			dependencies[1].srcSubpass = 0;
-			dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-			dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-			dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-			dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-			VkRenderPassCreateInfo renderPassInfo = {};
-			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-			renderPassInfo.pAttachments = &attachmentDescription;
-			renderPassInfo.attachmentCount = 1;
-			renderPassInfo.subpassCount = 1;
-			renderPassInfo.pSubpasses = &subpass;
-			renderPassInfo.dependencyCount = 2;
-			renderPassInfo.pDependencies = dependencies.data();
-			VK_CHECK_RESULT(vkCreateRenderPass(device, &renderPassInfo, nullptr, &frameBuffers.ssaoBlur.renderPass));
-
-			VkFramebufferCreateInfo fbufCreateInfo = vks::initializers::framebufferCreateInfo();
-			fbufCreateInfo.renderPass = frameBuffers.ssaoBlur.renderPass;
-			fbufCreateInfo.pAttachments = &frameBuffers.ssaoBlur.color.view;
-			fbufCreateInfo.attachmentCount = 1;
-			fbufCreateInfo.width = frameBuffers.ssaoBlur.width;
-			fbufCreateInfo.height = frameBuffers.ssaoBlur.height;
-			fbufCreateInfo.layers = 1;
-			VK_CHECK_RESULT(vkCreateFramebuffer(device, &fbufCreateInfo, nullptr, &frameBuffers.ssaoBlur.frameBuffer));
+	// Settings that change the passes or images of the render graph, the graph is rebuilt if any of them changes
+	// Switching between the AO benchmark's reference and a technique must not change it, the reference ignores the depth pyramid through its parameters instead
+	std::array<int32_t, 7> getRenderGraphConfiguration()
+	{
+		return { uboSSAOParams.ssao, uboSSAOParams.ssaoOnly, uboSSAOParams.ssaoBlur, temporalSSAO, getSSAOPath(), depthPyramidEnabled, ssaoScaleIndex };
+	}
+
+	// View space positions are either read from the position attachment or reconstructed from the depth attachment
+	vks::RenderGraph::ResourceHandle getPositionSource()
+	{
+		return positionFromDepth ? renderTargets.depth : renderTargets.position;
+	}
+
+	// With temporal SSAO all later passes read the accumulated result instead of the SSAO of the current frame
+	vks::RenderGraph::ResourceHandle getSSAOResult()
+	{
+		return temporalSSAO ? renderTargets.temporal : renderTargets.ssao;
+	}
+
+	// Passes without image accesses that are never culled, e.g. to begin and end profiler scopes spanning several passes
+	void addMarkerPass(const std::string& name, std::function<void(VkCommandBuffer)> record)
+	{
+		vks::RenderGraph::PassHandle pass = renderGraph.addPass(name, vks::RenderGraph::PassType::Transfer, record);
+		renderGraph.setSideEffects(pass);
+	}
+
+	// Timestamp after the given pass, only part of the graph while the AO technique benchmark is running
+	void addBenchmarkTimestampPass(BenchmarkPass benchmarkPass)
+	{
+		if (!aoBenchmark.active) {
+			return;
 		}
+		addMarkerPass(benchmarkPassNames[benchmarkPass] + " timestamp", [this, benchmarkPass](VkCommandBuffer commandBuffer) {
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, aoBenchmark.submissions[currentFrame].queryPool, benchmarkPass + 1);
+		});
+	}
+
+	// Declares all render targets and passes for the current settings and compiles the graph
+	// Passes that don't contribute to the composition are culled, e.g. the upsampling at full SSAO resolution or the blur if it's disabled
+	void buildRenderGraph()
+	{
+		typedef vks::RenderGraph::PassType PassType;
+		typedef vks::RenderGraph::Access Access;
+
+		renderGraph.reset();
+		renderGraphConfiguration = getRenderGraphConfiguration();
+
+		const uint32_t ssaoScale = getSSAOScale();
+		ssaoExtent = { std::max(width / ssaoScale, 1u), std::max(height / ssaoScale, 1u) };
+		// Each deinterleaved layer covers every fourth pixel of the SSAO target in both directions
+		deinterleavedLayers.width = (ssaoExtent.width + 3) / 4;
+		deinterleavedLayers.height = (ssaoExtent.height + 3) / 4;
+		depthPyramidLevels = std::min(static_cast<uint32_t>(std::floor(std::log2(std::max(ssaoExtent.width, ssaoExtent.height)))) + 1, static_cast<uint32_t>(DEPTH_PYRAMID_MAX_LEVELS));
+
+		// The descriptors of the compute paths reference their images as storage images even if the paths are not part of the graph
+		const VkImageUsageFlags storageUsage = computeSSAOSupported ? VK_IMAGE_USAGE_STORAGE_BIT : 0;
+		auto image = [](VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage = 0, uint32_t layers = 1, uint32_t levels = 1) {
+			vks::RenderGraph::ImageDesc desc;
+			desc.format = format;
+			desc.width = width;
+			desc.height = height;
+			desc.layers = layers;
+			desc.levels = levels;
+			desc.usage = usage;
+			return desc;
+		};
+
+		// G-Buffer at full resolution, the position attachment is not required if positions are reconstructed from depth
+		renderTargets.position = positionFromDepth ? vks::RenderGraph::None : renderGraph.createImage("Position", image(VK_FORMAT_R32G32B32A32_SFLOAT, width, height));
+		renderTargets.normal = renderGraph.createImage("Normal", image(getNormalFormat(normalEncoding), width, height));
+		renderTargets.albedo = renderGraph.createImage("Albedo", image(VK_FORMAT_R8G8B8A8_UNORM, width, height));
+		// Unless positions are reconstructed from it, depth is only used within the G-Buffer pass and becomes a transient attachment
+		renderTargets.depth = renderGraph.createImage("Depth", image(getGBufferDepthFormat(positionFromDepth), width, height));
+		// SSAO upsampled to full resolution
+		renderTargets.upsample = renderGraph.createImage("SSAO upsample", image(VK_FORMAT_R8_UNORM, width, height));
+
+		// Targets at SSAO resolution
+		renderTargets.linearDepth = renderGraph.createImage("Linear depth", image(VK_FORMAT_R32_SFLOAT, ssaoExtent.width, ssaoExtent.height));
+		renderTargets.depthPyramid = depthPyramidSupported ? renderGraph.createImage("Depth pyramid", image(VK_FORMAT_R32G32_SFLOAT, ssaoExtent.width, ssaoExtent.height, VK_IMAGE_USAGE_STORAGE_BIT, 1, depthPyramidLevels)) : vks::RenderGraph::None;
+		renderTargets.ssao = renderGraph.createImage("SSAO", image(VK_FORMAT_R8_UNORM, ssaoExtent.width, ssaoExtent.height, storageUsage));
+		renderTargets.temporal = renderGraph.createImage("SSAO temporal", image(temporalFormat, ssaoExtent.width, ssaoExtent.height));
+		renderTargets.history = renderGraph.createImage("SSAO history", image(temporalFormat, ssaoExtent.width, ssaoExtent.height));
+		renderTargets.blurIntermediate = computeSSAOSupported ? renderGraph.createImage("SSAO blur intermediate", image(VK_FORMAT_R8_UNORM, ssaoExtent.width, ssaoExtent.height, VK_IMAGE_USAGE_STORAGE_BIT)) : vks::RenderGraph::None;
+		renderTargets.blur = renderGraph.createImage("SSAO blur", image(VK_FORMAT_R8_UNORM, ssaoExtent.width, ssaoExtent.height, storageUsage));
+		if (computeSSAOSupported) {
+			renderTargets.deinterleavedDepth = renderGraph.createImage("Deinterleaved depth", image(VK_FORMAT_R32_SFLOAT, deinterleavedLayers.width, deinterleavedLayers.height, VK_IMAGE_USAGE_STORAGE_BIT, DEINTERLEAVE_LAYERS));
+			renderTargets.deinterleavedNormal = renderGraph.createImage("Deinterleaved normal", image(VK_FORMAT_R8G8B8A8_UNORM, deinterleavedLayers.width, deinterleavedLayers.height, VK_IMAGE_USAGE_STORAGE_BIT, DEINTERLEAVE_LAYERS));
+			renderTargets.deinterleavedAO = renderGraph.createImage("Deinterleaved SSAO", image(VK_FORMAT_R8_UNORM, deinterleavedLayers.width, deinterleavedLayers.height, VK_IMAGE_USAGE_STORAGE_BIT, DEINTERLEAVE_LAYERS));
+		} else {
+			renderTargets.deinterleavedDepth = renderTargets.deinterleavedNormal = renderTargets.deinterleavedAO = vks::RenderGraph::None;
+		}
+
+		const vks::RenderGraph::ResourceHandle positionSource = getPositionSource();
+		const vks::RenderGraph::ResourceHandle ssaoResult = getSSAOResult();
+		VkClearValue colorClear{};
+		colorClear.color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+		VkClearValue depthClear{};
+		depthClear.depthStencil = { 1.0f, 0 };
+		vks::RenderGraph::PassHandle pass;
+
+		/*
+			First pass: Fill G-Buffer components (positions+depth, normals, albedo) using MRT
+		*/
+
+		pass = renderGraph.addPass("G-Buffer", PassType::Graphics, [this](VkCommandBuffer commandBuffer) {
+			vks::GpuProfiler::Scope gBufferScope(profiler, commandBuffer, "G-Buffer");
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines.offscreen);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayouts.gBuffer, 0, 1, &descriptorSets.gBuffer, 1, &uniformAllocations.sceneParams.offset);
+			scene.draw(commandBuffer, vkglTF::RenderFlags::BindImages, pipelineLayouts.gBuffer);
+		});
+		// The fragment shader always writes position, normals and albedo to locations 0..2, without a position attachment location 0 is unused
+		renderGraph.write(pass, renderTargets.position, Access::ColorAttachment, colorClear);
+		renderGraph.write(pass, renderTargets.normal, Access::ColorAttachment, colorClear);
+		renderGraph.write(pass, renderTargets.albedo, Access::ColorAttachment, colorClear);
+		renderGraph.write(pass, renderTargets.depth, Access::DepthStencilAttachment, depthClear);
+		addBenchmarkTimestampPass(BenchmarkPassGBuffer);
+
+		/*
+			Depth downsample: Linear depth at SSAO resolution
+		*/
+
+		// Linear depth, AO and temporal accumulation are profiled as a single SSAO scope
+		addMarkerPass("SSAO begin", [this](VkCommandBuffer commandBuffer) { profilerScopes.ssao = profiler.beginScope(commandBuffer, "SSAO"); });
+		pass = renderGraph.addPass("Linear depth", PassType::Graphics, [this](VkCommandBuffer commandBuffer) {
+			drawFullscreen(commandBuffer, pipelines.depthDownsample, pipelineLayouts.depthDownsample, descriptorSets.depthDownsample, { uniformAllocations.ssaoParams.offset });
+		});
+		renderGraph.read(pass, positionSource);
+		renderGraph.write(pass, renderTargets.linearDepth, Access::ColorAttachment, colorClear);
+
+		// Min/max depth pyramid, culled if no SSAO path samples it
+		if (depthPyramidSupported) {
+			pass = renderGraph.addPass("Depth pyramid", PassType::Compute, [this](VkCommandBuffer commandBuffer) { buildDepthPyramidCommands(commandBuffer); });
+			renderGraph.read(pass, renderTargets.linearDepth);
+			renderGraph.write(pass, renderTargets.depthPyramid, Access::StorageWrite);
+		}
+		addBenchmarkTimestampPass(BenchmarkPassLinearDepth);
+
+		/*
+			Second pass: SSAO generation
+		*/
+
+		const SSAOPath ssaoPath = getSSAOPath();
+		// The deinterleaved path samples its own depth layers
+		const bool readDepthPyramid = depthPyramidSupported && depthPyramidEnabled && (ssaoPath != SSAOPathDeinterleaved);
+		if (ssaoPath == SSAOPathDeinterleaved) {
+			pass = renderGraph.addPass("Deinterleave", PassType::Compute, [this](VkCommandBuffer commandBuffer) { buildDeinterleaveCommands(commandBuffer); });
+			renderGraph.read(pass, renderTargets.linearDepth);
+			renderGraph.read(pass, renderTargets.normal);
+			renderGraph.write(pass, renderTargets.deinterleavedDepth, Access::StorageWrite);
+			renderGraph.write(pass, renderTargets.deinterleavedNormal, Access::StorageWrite);
+
+			pass = renderGraph.addPass("SSAO layers", PassType::Compute, [this](VkCommandBuffer commandBuffer) { buildDeinterleavedSSAOCommands(commandBuffer); });
+			renderGraph.read(pass, renderTargets.deinterleavedDepth);
+			renderGraph.read(pass, renderTargets.deinterleavedNormal);
+			renderGraph.write(pass, renderTargets.deinterleavedAO, Access::StorageWrite);
+
+			pass = renderGraph.addPass("Reinterleave", PassType::Compute, [this](VkCommandBuffer commandBuffer) { buildReinterleaveCommands(commandBuffer); });
+			renderGraph.read(pass, renderTargets.deinterleavedAO);
+			renderGraph.write(pass, renderTargets.ssao, Access::StorageWrite);
+		} else {
+			if (ssaoPath == SSAOPathCompute) {
+				pass = renderGraph.addPass("SSAO", PassType::Compute, [this](VkCommandBuffer commandBuffer) { buildComputeSSAOCommands(commandBuffer); });
+				renderGraph.write(pass, renderTargets.ssao, Access::StorageWrite);
+			} else {
+				pass = renderGraph.addPass("SSAO", PassType::Graphics, [this](VkCommandBuffer commandBuffer) {
+					const std::array<uint32_t, 2> ssaoOffsets = getSSAODynamicOffsets();
+					drawFullscreen(commandBuffer, aoBenchmark.renderingReference() ? pipelines.ssaoReference : pipelines.ssao[aoTechnique], pipelineLayouts.ssao, descriptorSets.ssao, { ssaoOffsets.begin(), ssaoOffsets.end() });
+				});
+				renderGraph.write(pass, renderTargets.ssao, Access::ColorAttachment, colorClear);
+			}
+			renderGraph.read(pass, positionSource);
+			renderGraph.read(pass, renderTargets.normal);
+			renderGraph.read(pass, renderTargets.linearDepth);
+			if (readDepthPyramid) {
+				renderGraph.read(pass, renderTargets.depthPyramid);
+			}
+		}
+		addBenchmarkTimestampPass(BenchmarkPassAO);
+
+		/*
+			Temporal accumulation: Blend the reprojected history with the SSAO of this frame (only if temporal SSAO is enabled)
+		*/
+
+		if (temporalSSAO) {
+			pass = renderGraph.addPass("SSAO temporal", PassType::Graphics, [this](VkCommandBuffer commandBuffer) {
+				drawFullscreen(commandBuffer, pipelines.temporal, pipelineLayouts.temporal, descriptorSets.temporal, { uniformAllocations.ssaoParams.offset });
+			});
+			renderGraph.read(pass, renderTargets.ssao);
+			renderGraph.read(pass, renderTargets.linearDepth);
+			renderGraph.read(pass, renderTargets.history);
+			renderGraph.write(pass, renderTargets.temporal, Access::ColorAttachment, colorClear);
+
+			// The accumulated result becomes the history that is reprojected in the next frame
+			pass = renderGraph.addPass("SSAO history", PassType::Transfer, [this](VkCommandBuffer commandBuffer) { buildTemporalHistoryCopyCommands(commandBuffer); });
+			renderGraph.read(pass, renderTargets.temporal, Access::TransferSrc);
+			renderGraph.write(pass, renderTargets.history, Access::TransferDst);
+		}
+		addMarkerPass("SSAO end", [this](VkCommandBuffer commandBuffer) { profiler.endScope(commandBuffer, profilerScopes.ssao); });
+		addBenchmarkTimestampPass(BenchmarkPassTemporal);
+
+		/*
+			Third pass: SSAO blur
+			Separable depth aware compute blur, with the fragment shader box blur as a fallback for devices that can't write the SSAO format as a storage image
+		*/
+
+		addMarkerPass("Blur begin", [this](VkCommandBuffer commandBuffer) { profilerScopes.blur = profiler.beginScope(commandBuffer, "Blur"); });
+		if (computeSSAOSupported) {
+			pass = renderGraph.addPass("SSAO blur horizontal", PassType::Compute, [this](VkCommandBuffer commandBuffer) { buildComputeBlurCommands(commandBuffer, true); });
+			renderGraph.read(pass, ssaoResult);
+			renderGraph.read(pass, renderTargets.linearDepth);
+			renderGraph.write(pass, renderTargets.blurIntermediate, Access::StorageWrite);
+
+			pass = renderGraph.addPass("SSAO blur vertical", PassType::Compute, [this](VkCommandBuffer commandBuffer) { buildComputeBlurCommands(commandBuffer, false); });
+			renderGraph.read(pass, renderTargets.blurIntermediate);
+			renderGraph.read(pass, renderTargets.linearDepth);
+			renderGraph.write(pass, renderTargets.blur, Access::StorageWrite);
+		} else {
+			pass = renderGraph.addPass("SSAO blur", PassType::Graphics, [this](VkCommandBuffer commandBuffer) {
+				drawFullscreen(commandBuffer, pipelines.ssaoBlurFragment, pipelineLayouts.ssaoBlurFragment, descriptorSets.ssaoBlurFragment, {});
+			});
+			renderGraph.read(pass, ssaoResult);
+			renderGraph.write(pass, renderTargets.blur, Access::ColorAttachment, colorClear);
+		}
+		addMarkerPass("Blur end", [this](VkCommandBuffer commandBuffer) { profiler.endScope(commandBuffer, profilerScopes.blur); });
+		addBenchmarkTimestampPass(BenchmarkPassBlur);
+
+		/*
+			Fourth pass: Depth aware upsampling to full resolution (culled if SSAO runs at full resolution)
+		*/
+
+		pass = renderGraph.addPass("SSAO upsample", PassType::Graphics, [this](VkCommandBuffer commandBuffer) {
+			vks::GpuProfiler::Scope upsampleScope(profiler, commandBuffer, "Upsample");
+			drawFullscreen(commandBuffer, pipelines.upsample, pipelineLayouts.upsample, descriptorSets.upsample, { uniformAllocations.ssaoParams.offset });
+		});
+		renderGraph.read(pass, uboSSAOParams.ssaoBlur ? renderTargets.blur : ssaoResult);
+		renderGraph.read(pass, renderTargets.linearDepth);
+		renderGraph.read(pass, positionSource);
+		renderGraph.write(pass, renderTargets.upsample, Access::ColorAttachment, colorClear);
+		addBenchmarkTimestampPass(BenchmarkPassUpsample);
+
+		/*
+			Final pass: Composition of the G-Buffer and the AO into the swapchain image
+		*/
+
+		pass = renderGraph.addPass("Composition", PassType::Graphics, [this](VkCommandBuffer commandBuffer) { buildCompositionCommands(commandBuffer); });
+		renderGraph.setSideEffects(pass);
+		renderGraph.read(pass, positionSource);
+		renderGraph.read(pass, renderTargets.normal);
+		renderGraph.read(pass, renderTargets.albedo);
+		if (uboSSAOParams.ssao || uboSSAOParams.ssaoOnly) {
+			renderGraph.read(pass, (ssaoScale > 1) ? renderTargets.upsample : (uboSSAOParams.ssaoBlur ? renderTargets.blur : ssaoResult));
+		}
+		addBenchmarkTimestampPass(BenchmarkPassComposition);
+
+		// The AO technique benchmark reads back the raw AO of every frame for comparison with the reference
+		if (aoBenchmark.active) {
+			pass = renderGraph.addPass("AO readback", PassType::Transfer, [this](VkCommandBuffer commandBuffer) { buildBenchmarkReadbackCommands(commandBuffer); });
+			renderGraph.setSideEffects(pass);
+			renderGraph.read(pass, renderTargets.ssao, Access::TransferSrc);
+		}
+
+		// The history is read by the next frame, so it must neither be culled nor share its memory
+		if (temporalSSAO && (uboSSAOParams.ssao || uboSSAOParams.ssaoOnly)) {
+			renderGraph.markOutput(renderTargets.history);
+		}
+
+		renderGraph.compile();
+		// The history has just been created and is read before it has been written for the first time
+		resetTemporalHistory();
+
+		const vks::RenderGraph::MemoryStatistics memory = renderGraph.getMemoryStatistics();
+		const bool memoryChanged = (memory.unaliased != renderTargetMemory.unaliased) || (memory.resident != renderTargetMemory.resident) || (memory.lazilyAllocated != renderTargetMemory.lazilyAllocated);
+		renderTargetMemory = memory;
+		if (memoryChanged) {
+			const double MiB = 1024.0 * 1024.0;
+			std::cout << std::fixed << std::setprecision(2) << "Render targets: " << renderTargetMemory.unaliased / MiB << " MiB without aliasing, "
+				<< renderTargetMemory.resident / MiB << " MiB resident and " << renderTargetMemory.lazilyAllocated / MiB << " MiB lazily allocated with aliasing and transient attachments" << "\n";
+			std::cout.unsetf(std::ios_base::floatfield);
+		}
+	}
+
+	// Checks which compute paths the device supports, creates the render passes for pipeline creation and builds the render graph
+	void prepareRenderGraph()
+	{
+		// The compute shader SSAO path writes to the SSAO target as a storage image
+		VkFormatProperties ssaoFormatProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8_UNORM, &ssaoFormatProperties);
+		computeSSAOSupported = enabledFeatures.shaderStorageImageExtendedFormats && (ssaoFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+		if (!computeSSAOSupported) {
+			std::cout << "Storage image writes to VK_FORMAT_R8_UNORM are not supported, falling back to fragment shader SSAO and blur\n";
+			computeSSAO = false;
+			deinterleavedSSAO = false;
+		}
+
+		// The depth pyramid is written as a two channel float storage image
+		VkFormatProperties pyramidFormatProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R32G32_SFLOAT, &pyramidFormatProperties);
+		depthPyramidSupported = enabledFeatures.shaderStorageImageExtendedFormats && (pyramidFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+		if (!depthPyramidSupported) {
+			std::cout << "Storage image writes to VK_FORMAT_R32G32_SFLOAT are not supported, SSAO samples read the full resolution linear depth\n";
+			depthPyramidEnabled = false;
+		}
+
+		renderGraph.create(vulkanDevice, renderTargetAliasing);
+
+		// Render passes are owned by the graph and stay valid across rebuilds, so the pipelines don't have to be recreated
+		renderPasses.gBuffer = renderGraph.getRenderPass({ positionFromDepth ? VK_FORMAT_UNDEFINED : VK_FORMAT_R32G32B32A32_SFLOAT, getNormalFormat(normalEncoding), VK_FORMAT_R8G8B8A8_UNORM }, getGBufferDepthFormat(positionFromDepth));
+		renderPasses.linearDepth = renderGraph.getRenderPass({ VK_FORMAT_R32_SFLOAT });
+		// SSAO, blur and upsampling
+		renderPasses.ssao = renderGraph.getRenderPass({ VK_FORMAT_R8_UNORM });
+		renderPasses.temporal = renderGraph.getRenderPass({ temporalFormat });
+
+		buildRenderGraph();
 
 		// Shared sampler used for all color attachments
 		VkSamplerCreateInfo sampler = vks::initializers::samplerCreateInfo();
@@ -478,160 +1061,184 @@ public:
 		sampler.maxLod = 1.0f;
 		sampler.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 		VK_CHECK_RESULT(vkCreateSampler(device, &sampler, nullptr, &colorSampler));
+
+		// Depth pyramid sampler, levels are selected explicitly in the shader
+		sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		sampler.maxLod = static_cast<float>(DEPTH_PYRAMID_MAX_LEVELS);
+		VK_CHECK_RESULT(vkCreateSampler(device, &sampler, nullptr, &depthPyramidSampler));
 	}
 
 	void loadAssets()
 	{
+		VKS_TRACE_SCOPE("loadAssets");
 		vkglTF::descriptorBindingFlags  = vkglTF::DescriptorBindingFlags::ImageBaseColor;
 		const uint32_t gltfLoadingFlags = vkglTF::FileLoadingFlags::FlipY | vkglTF::FileLoadingFlags::PreTransformVertices;
 		scene.loadFromFile(getAssetPath() + "models/sponza/sponza.gltf", vulkanDevice, queue, gltfLoadingFlags);
 	}
 
-	void buildCommandBuffers()
+	// Draws a fullscreen triangle, the render graph has already begun the pass's render pass and set the viewport and scissor
+	void drawFullscreen(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet, const std::vector<uint32_t>& dynamicOffsets)
 	{
-		VkCommandBufferBeginInfo cmdBufInfo = vks::initializers::commandBufferBeginInfo();
-
-		for (int32_t i = 0; i < drawCmdBuffers.size(); ++i)
-		{
-			VK_CHECK_RESULT(vkBeginCommandBuffer(drawCmdBuffers[i], &cmdBufInfo));
-
-			/*
-				Offscreen SSAO generation
-			*/
-			{
-				// Clear values for all attachments written in the fragment shader
-				std::vector<VkClearValue> clearValues(4);
-				clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-				clearValues[1].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-				clearValues[2].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-				clearValues[3].depthStencil = { 1.0f, 0 };
-
-				VkRenderPassBeginInfo renderPassBeginInfo = vks::initializers::renderPassBeginInfo();
-				renderPassBeginInfo.renderPass = frameBuffers.offscreen.renderPass;
-				renderPassBeginInfo.framebuffer = frameBuffers.offscreen.frameBuffer;
-				renderPassBeginInfo.renderArea.extent.width = frameBuffers.offscreen.width;
-				renderPassBeginInfo.renderArea.extent.height = frameBuffers.offscreen.height;
-				renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-				renderPassBeginInfo.pClearValues = clearValues.data();
-
-				/*
-					First pass: Fill G-Buffer components (positions+depth, normals, albedo) using MRT
-				*/
-
-				vkCmdBeginRenderPass(drawCmdBuffers[i], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-				VkViewport viewport = vks::initializers::viewport((float)frameBuffers.offscreen.width, (float)frameBuffers.offscreen.height, 0.0f, 1.0f);
-				vkCmdSetViewport(drawCmdBuffers[i], 0, 1, &viewport);
-
-				VkRect2D scissor = vks::initializers::rect2D(frameBuffers.offscreen.width, frameBuffers.offscreen.height, 0, 0);
-				vkCmdSetScissor(drawCmdBuffers[i], 0, 1, &scissor);
-
-				vkCmdBindPipeline(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines.offscreen);
-
-				vkCmdBindDescriptorSets(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayouts.gBuffer, 0, 1, &descriptorSets.gBuffer, 0, nullptr);
-				scene.draw(drawCmdBuffers[i], vkglTF::RenderFlags::BindImages, pipelineLayouts.gBuffer);
-
-				vkCmdEndRenderPass(drawCmdBuffers[i]);
-
-				/*
-					Second pass: SSAO generation
-				*/
-
-				clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-				clearValues[1].depthStencil = { 1.0f, 0 };
-
-				renderPassBeginInfo.framebuffer = frameBuffers.ssao.frameBuffer;
-				renderPassBeginInfo.renderPass = frameBuffers.ssao.renderPass;
-				renderPassBeginInfo.renderArea.extent.width = frameBuffers.ssao.width;
-				renderPassBeginInfo.renderArea.extent.height = frameBuffers.ssao.height;
-				renderPassBeginInfo.clearValueCount = 2;
-				renderPassBeginInfo.pClearValues = clearValues.data();
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+	}
 
-				vkCmdBeginRenderPass(drawCmdBuffers[i], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	// Generates the SSAO target with a compute shader that writes the occlusion values as a storage image
+	void buildComputeSSAOCommands(VkCommandBuffer commandBuffer)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.ssaoCompute);
+		const std::array<uint32_t, 2> ssaoOffsets = getSSAODynamicOffsets();
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayouts.ssao, 0, 1, &descriptorSets.ssao, static_cast<uint32_t>(ssaoOffsets.size()), ssaoOffsets.data());
+		// The compute shader works on tiles of 16x16 pixels
+		vkCmdDispatch(commandBuffer, (ssaoExtent.width + 15) / 16, (ssaoExtent.height + 15) / 16, 1);
+	}
 
-				viewport = vks::initializers::viewport((float)frameBuffers.ssao.width, (float)frameBuffers.ssao.height, 0.0f, 1.0f);
-				vkCmdSetViewport(drawCmdBuffers[i], 0, 1, &viewport);
-				scissor = vks::initializers::rect2D(frameBuffers.ssao.width, frameBuffers.ssao.height, 0, 0);
-				vkCmdSetScissor(drawCmdBuffers[i], 0, 1, &scissor);
+	// Splits linear depth and normals into the deinterleaved layers
+	void buildDeinterleaveCommands(VkCommandBuffer commandBuffer)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.deinterleave);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayouts.deinterleave, 0, 1, &descriptorSets.deinterleave, 0, nullptr);
+		vkCmdDispatch(commandBuffer, (deinterleavedLayers.width + 7) / 8, (deinterleavedLayers.height + 7) / 8, DEINTERLEAVE_LAYERS);
+	}
 
-				vkCmdBindDescriptorSets(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayouts.ssao, 0, 1, &descriptorSets.ssao, 0, nullptr);
-				vkCmdBindPipeline(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines.ssao);
-				vkCmdDraw(drawCmdBuffers[i], 3, 1, 0, 0);
+	// Runs SSAO on each deinterleaved layer with the layer's constant rotation
+	void buildDeinterleavedSSAOCommands(VkCommandBuffer commandBuffer)
+	{
+		const glm::ivec2 ssaoSize(ssaoExtent.width, ssaoExtent.height);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.ssaoDeinterleaved);
+		const std::array<uint32_t, 2> ssaoOffsets = getSSAODynamicOffsets();
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayouts.ssaoDeinterleaved, 0, 1, &descriptorSets.ssaoDeinterleaved, static_cast<uint32_t>(ssaoOffsets.size()), ssaoOffsets.data());
+		vkCmdPushConstants(commandBuffer, pipelineLayouts.ssaoDeinterleaved, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(glm::ivec2), &ssaoSize);
+		vkCmdDispatch(commandBuffer, (deinterleavedLayers.width + 7) / 8, (deinterleavedLayers.height + 7) / 8, DEINTERLEAVE_LAYERS);
+	}
 
-				vkCmdEndRenderPass(drawCmdBuffers[i]);
+	// Gathers the deinterleaved SSAO layers back into the SSAO target
+	void buildReinterleaveCommands(VkCommandBuffer commandBuffer)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.reinterleave);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayouts.reinterleave, 0, 1, &descriptorSets.reinterleave, 0, nullptr);
+		vkCmdDispatch(commandBuffer, (ssaoExtent.width + 15) / 16, (ssaoExtent.height + 15) / 16, 1);
+	}
 
-				/*
-					Third pass: SSAO blur
-				*/
+	// Builds all levels of the min/max depth pyramid from the linear depth target with a single dispatch
+	void buildDepthPyramidCommands(VkCommandBuffer commandBuffer)
+	{
+		const int32_t levels = static_cast<int32_t>(depthPyramidLevels);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.depthPyramid);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayouts.depthPyramid, 0, 1, &descriptorSets.depthPyramid, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipelineLayouts.depthPyramid, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(int32_t), &levels);
+		// Each work group reduces a tile of 32x32 texels
+		vkCmdDispatch(commandBuffer, (ssaoExtent.width + 31) / 32, (ssaoExtent.height + 31) / 32, 1);
+	}
 
-				renderPassBeginInfo.framebuffer = frameBuffers.ssaoBlur.frameBuffer;
-				renderPassBeginInfo.renderPass = frameBuffers.ssaoBlur.renderPass;
-				renderPassBeginInfo.renderArea.extent.width = frameBuffers.ssaoBlur.width;
-				renderPassBeginInfo.renderArea.extent.height = frameBuffers.ssaoBlur.height;
+	// Copies the accumulated temporal SSAO result to the history that is reprojected in the next frame
+	void buildTemporalHistoryCopyCommands(VkCommandBuffer commandBuffer)
+	{
+		VkImageCopy copyRegion = {};
+		copyRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copyRegion.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copyRegion.extent = { ssaoExtent.width, ssaoExtent.height, 1 };
+		vkCmdCopyImage(commandBuffer, renderGraph.getImage(renderTargets.temporal), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, renderGraph.getImage(renderTargets.history), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+	}
 
-				vkCmdBeginRenderPass(drawCmdBuffers[i], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	// One pass of the separable depth aware blur, along the rows into the intermediate image or along the columns into the blur target
+	void buildComputeBlurCommands(VkCommandBuffer commandBuffer, bool horizontal)
+	{
+		// Each work group blurs a segment of 128 pixels of one row or column
+		const uint32_t tileSize = 128;
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.ssaoBlur);
+		blurPushConstants.radius = blurRadius;
+		blurPushConstants.direction = horizontal ? glm::ivec2(1, 0) : glm::ivec2(0, 1);
+		vkCmdPushConstants(commandBuffer, pipelineLayouts.ssaoBlur, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BlurPushConstants), &blurPushConstants);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayouts.ssaoBlur, 0, 1, horizontal ? &descriptorSets.ssaoBlurHorizontal : &descriptorSets.ssaoBlurVertical, 0, nullptr);
+		if (horizontal) {
+			vkCmdDispatch(commandBuffer, (ssaoExtent.width + tileSize - 1) / tileSize, ssaoExtent.height, 1);
+		} else {
+			vkCmdDispatch(commandBuffer, (ssaoExtent.height + tileSize - 1) / tileSize, ssaoExtent.width, 1);
+		}
+	}
 
-				viewport = vks::initializers::viewport((float)frameBuffers.ssaoBlur.width, (float)frameBuffers.ssaoBlur.height, 0.0f, 1.0f);
-				vkCmdSetViewport(drawCmdBuffers[i], 0, 1, &viewport);
-				scissor = vks::initializers::rect2D(frameBuffers.ssaoBlur.width, frameBuffers.ssaoBlur.height, 0, 0);
-				vkCmdSetScissor(drawCmdBuffers[i], 0, 1, &scissor);
+	// Final composition of the G-Buffer and the AO into the swapchain image
+	void buildCompositionCommands(VkCommandBuffer commandBuffer)
+	{
+		vks::GpuProfiler::Scope compositionScope(profiler, commandBuffer, "Composition");
+		std::vector<VkClearValue> clearValues(2);
+		clearValues[0].color = defaultClearColor;
+		clearValues[1].depthStencil = { 1.0f, 0 };
 
-				vkCmdBindDescriptorSets(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayouts.ssaoBlur, 0, 1, &descriptorSets.ssaoBlur, 0, nullptr);
-				vkCmdBindPipeline(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines.ssaoBlur);
-				vkCmdDraw(drawCmdBuffers[i], 3, 1, 0, 0);
+		VkRenderPassBeginInfo renderPassBeginInfo = vks::initializers::renderPassBeginInfo();
+		renderPassBeginInfo.renderPass = renderPass;
+		renderPassBeginInfo.framebuffer = VulkanExampleBase::frameBuffers[currentBuffer];
+		renderPassBeginInfo.renderArea.extent.width = width;
+		renderPassBeginInfo.renderArea.extent.height = height;
+		renderPassBeginInfo.clearValueCount = 2;
+		renderPassBeginInfo.pClearValues = clearValues.data();
 
-				vkCmdEndRenderPass(drawCmdBuffers[i]);
-			}
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-			/*
-				Note: Explicit synchronization is not required between the render pass, as this is done implicit via sub pass dependencies
-			*/
+		VkViewport viewport = vks::initializers::viewport((float)width, (float)height, 0.0f, 1.0f);
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-			/*
-				Final render pass: Scene rendering with applied radial blur
-			*/
-			{
-				std::vector<VkClearValue> clearValues(2);
-				clearValues[0].color = defaultClearColor;
-				clearValues[1].depthStencil = { 1.0f, 0 };
+		VkRect2D scissor = vks::initializers::rect2D(width, height, 0, 0);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-				VkRenderPassBeginInfo renderPassBeginInfo = vks::initializers::renderPassBeginInfo();
-				renderPassBeginInfo.renderPass = renderPass;
-				renderPassBeginInfo.framebuffer = VulkanExampleBase::frameBuffers[i];
-				renderPassBeginInfo.renderArea.extent.width = width;
-				renderPassBeginInfo.renderArea.extent.height = height;
-				renderPassBeginInfo.clearValueCount = 2;
-				renderPassBeginInfo.pClearValues = clearValues.data();
+		drawFullscreen(commandBuffer, pipelines.composition, pipelineLayouts.composition, descriptorSets.composition, { uniformAllocations.ssaoParams.offset });
 
-				vkCmdBeginRenderPass(drawCmdBuffers[i], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		drawUI(commandBuffer);
 
-				VkViewport viewport = vks::initializers::viewport((float)width, (float)height, 0.0f, 1.0f);
-				vkCmdSetViewport(drawCmdBuffers[i], 0, 1, &viewport);
+		vkCmdEndRenderPass(commandBuffer);
+	}
 
-				VkRect2D scissor = vks::initializers::rect2D(width, height, 0, 0);
-				vkCmdSetScissor(drawCmdBuffers[i], 0, 1, &scissor);
+	// Copies the raw AO of this frame to the host visible readback buffer of the frame in flight
+	void buildBenchmarkReadbackCommands(VkCommandBuffer commandBuffer)
+	{
+		const vks::Buffer& readback = aoBenchmark.submissions[currentFrame].readback;
+		VkBufferImageCopy copyRegion{};
+		copyRegion.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copyRegion.imageExtent = { ssaoExtent.width, ssaoExtent.height, 1 };
+		vkCmdCopyImageToBuffer(commandBuffer, renderGraph.getImage(renderTargets.ssao), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &copyRegion);
+
+		// The readback buffer is not a resource of the render graph
+		VkBufferMemoryBarrier bufferBarrier = vks::initializers::bufferMemoryBarrier();
+		bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.buffer = readback.buffer;
+		bufferBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+	}
 
-				vkCmdBindDescriptorSets(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayouts.composition, 0, 1, &descriptorSets.composition, 0, NULL);
+	// Records the command buffer of the current frame in flight, commands are recorded every frame as they reference the frame's uniform buffer slots
+	void buildCommandBuffer()
+	{
+		VKS_TRACE_SCOPE("buildCommandBuffer");
+		VkCommandBuffer commandBuffer = framesInFlight[currentFrame].commandBuffer;
+		VkCommandBufferBeginInfo cmdBufInfo = vks::initializers::commandBufferBeginInfo();
 
-				// Final composition pass
-				vkCmdBindPipeline(drawCmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines.composition);
-				vkCmdDraw(drawCmdBuffers[i], 3, 1, 0, 0);
+		VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo));
+		profiler.resetQueries(commandBuffer);
 
-				drawUI(drawCmdBuffers[i]);
+		if (aoBenchmark.active) {
+			VkQueryPool queryPool = aoBenchmark.submissions[currentFrame].queryPool;
+			vkCmdResetQueryPool(commandBuffer, queryPool, 0, BenchmarkPassCount + 1);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+		}
 
-				vkCmdEndRenderPass(drawCmdBuffers[i]);
-			}
+		// Records all passes that haven't been culled, with the barriers the graph derived from the images they read and write
+		renderGraph.execute(commandBuffer);
 
-			VK_CHECK_RESULT(vkEndCommandBuffer(drawCmdBuffers[i]));
-		}
+		VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
 	}
 
 	void setupDescriptors()
 	{
 		// Pool
 		std::vector<VkDescriptorPoolSize> poolSizes = {
-			vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 10),
-			vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 12)
+			vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 9),
+			vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 33),
+			vks::initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 7 + DEPTH_PYRAMID_MAX_LEVELS)
 		};
 		VkDescriptorPoolCreateInfo descriptorPoolInfo = vks::initializers::descriptorPoolCreateInfo(poolSizes,  descriptorSets.count);
 		VK_CHECK_RESULT(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &descriptorPool));
@@ -639,66 +1246,136 @@ public:
 		std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings;
 		VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo;
 		VkDescriptorSetAllocateInfo descriptorAllocInfo = vks::initializers::descriptorSetAllocateInfo(descriptorPool, nullptr, 1);
-		std::vector<VkWriteDescriptorSet> writeDescriptorSets;
-		std::vector<VkDescriptorImageInfo> imageDescriptors;
 
 		// Layouts and Sets
 
 		// G-Buffer creation (offscreen scene rendering)
 		setLayoutBindings = {
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0),	// VS + FS Parameter UBO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0),	// VS + FS Parameter UBO
 		};
 		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
 		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.gBuffer));
-
 		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.gBuffer;
 		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.gBuffer));
-		writeDescriptorSets = {
-			vks::initializers::writeDescriptorSet(descriptorSets.gBuffer, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBuffers.sceneParams.descriptor),
+
+		// Depth downsample
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0),						// FS Position+Depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT, 1),								// FS Params UBO
 		};
-		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.depthDownsample));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.depthDownsample;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.depthDownsample));
+
+		// Depth pyramid
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0),						// CS Linear depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1, DEPTH_PYRAMID_MAX_LEVELS),		// CS Pyramid levels
+		};
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.depthPyramid));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.depthPyramid;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.depthPyramid));
 
 		// SSAO Generation
+		// The set is shared by the fragment and the compute shader path
+		const VkShaderStageFlags ssaoStages = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
 		setLayoutBindings = {
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0),						// FS Position+Depth
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1),						// FS Normals
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 2),						// FS SSAO Noise
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 3),								// FS SSAO Kernel UBO
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 4),								// FS Params UBO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, ssaoStages, 0),										// FS/CS Position+Depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, ssaoStages, 1),										// FS/CS Normals
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, ssaoStages, 2),										// FS/CS SSAO Noise
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, ssaoStages, 3),												// FS/CS SSAO Kernel UBO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, ssaoStages, 4),												// FS/CS Params UBO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 5),								// CS SSAO output
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, ssaoStages, 6),										// FS/CS Linear depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, ssaoStages, 7),										// FS/CS Depth pyramid
 		};
 		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
 		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.ssao));
-
 		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.ssao;
 		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.ssao));
-		imageDescriptors = {
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.offscreen.position.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.offscreen.normal.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+
+		// Deinterleaved SSAO
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0),						// CS Linear depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 1),						// CS Normals
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 2),								// CS Depth layers
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 3),								// CS Normal layers
 		};
-		writeDescriptorSets = {
-			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[0]),					// FS Position+Depth
-			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &imageDescriptors[1]),					// FS Normals
-			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &ssaoNoise.descriptor),		// FS SSAO Noise
-			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3, &uniformBuffers.ssaoKernel.descriptor),		// FS SSAO Kernel UBO
-			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4, &uniformBuffers.ssaoParams.descriptor),		// FS SSAO Params UBO
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.deinterleave));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.deinterleave;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.deinterleave));
+
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0),						// CS Depth layers
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 1),						// CS Normal layers
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 2),						// CS SSAO Noise
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT, 3),								// CS SSAO Kernel UBO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT, 4),								// CS Params UBO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 5),								// CS SSAO layers
 		};
-		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.ssaoDeinterleaved));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.ssaoDeinterleaved;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.ssaoDeinterleaved));
+
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0),						// CS SSAO layers
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1),								// CS SSAO output
+		};
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.reinterleave));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.reinterleave;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.reinterleave));
 
 		// SSAO Blur
+		// Both passes of the separable blur share the layout and only differ in the bound images
 		setLayoutBindings = {
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0),						// FS Sampler SSAO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 0),						// CS Sampler SSAO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 1),						// CS Linear depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 2),								// CS Blur output
 		};
 		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
 		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.ssaoBlur));
 		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.ssaoBlur;
-		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.ssaoBlur));
-		imageDescriptors = {
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.ssao.color.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.ssaoBlurHorizontal));
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.ssaoBlurVertical));
+
+		// SSAO Blur fallback (fragment shader)
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0),						// FS Sampler SSAO
 		};
-		writeDescriptorSets = {
-			vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlur, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[0]),
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.ssaoBlurFragment));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.ssaoBlurFragment;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.ssaoBlurFragment));
+
+		// SSAO temporal accumulation
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0),						// FS SSAO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1),						// FS Linear depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 2),						// FS History
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT, 3),								// FS Params UBO
 		};
-		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.temporal));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.temporal;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.temporal));
+
+		// SSAO upsample
+		setLayoutBindings = {
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0),						// FS SSAO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1),						// FS SSAO blurred
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 2),						// FS Linear depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 3),						// FS Position+Depth
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT, 4),								// FS Params UBO
+		};
+		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
+		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.upsample));
+		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.upsample;
+		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.upsample));
 
 		// Composition
 		setLayoutBindings = {
@@ -707,32 +1384,380 @@ public:
 			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 2),						// FS Albedo
 			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 3),						// FS SSAO
 			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 4),						// FS SSAO blurred
-			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, 5),								// FS Lights UBO
+			vks::initializers::descriptorSetLayoutBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT, 5),								// FS Lights UBO
 		};
 		setLayoutCreateInfo = vks::initializers::descriptorSetLayoutCreateInfo(setLayoutBindings.data(), static_cast<uint32_t>(setLayoutBindings.size()));
 		VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts.composition));
 		descriptorAllocInfo.pSetLayouts = &descriptorSetLayouts.composition;
 		VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &descriptorAllocInfo, &descriptorSets.composition));
+
+		updateDescriptorSets();
+	}
+
+	// Writes all descriptors that reference render targets, called again whenever the render graph has been rebuilt
+	void updateDescriptorSets()
+	{
+		std::vector<VkWriteDescriptorSet> writeDescriptorSets;
+		std::vector<VkDescriptorImageInfo> imageDescriptors;
+
+		// Shaders may statically use bindings they don't sample with the current settings, these point at images the graph actually reads so they are in the expected layout
+		// Images of culled passes are never written or transitioned and stay undefined
+		auto view = [this](vks::RenderGraph::ResourceHandle resource) { return renderGraph.getImageView(resource); };
+
+		// View space positions are either read from the position attachment or reconstructed from the depth attachment
+		const vks::RenderGraph::ResourceHandle positionSource = getPositionSource();
+		VkDescriptorImageInfo positionDescriptor = vks::initializers::descriptorImageInfo(colorSampler, view(positionSource), renderGraph.getLayout(positionSource, vks::RenderGraph::Access::Sampled));
+		VkDescriptorImageInfo linearDepthDescriptor = vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.linearDepth), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// With temporal SSAO all later passes read the accumulated result instead of the SSAO of the current frame
+		VkImageView ssaoResultView = view(getSSAOResult());
+
+		// G-Buffer creation (offscreen scene rendering)
+		writeDescriptorSets = {
+			vks::initializers::writeDescriptorSet(descriptorSets.gBuffer, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0, &uniformDescriptors.sceneParams),
+		};
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+		// Depth downsample
+		writeDescriptorSets = {
+			vks::initializers::writeDescriptorSet(descriptorSets.depthDownsample, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &positionDescriptor),		// FS Position+Depth
+			vks::initializers::writeDescriptorSet(descriptorSets.depthDownsample, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, &uniformDescriptors.ssaoParams),	// FS SSAO Params UBO
+		};
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+		// Depth pyramid
+		// If the image has less levels than the shader declares, the remaining array elements point to the last level and are never written
+		VkDescriptorImageInfo depthPyramidDescriptor = (depthPyramidSupported && depthPyramidEnabled) ?
+			vks::initializers::descriptorImageInfo(depthPyramidSampler, view(renderTargets.depthPyramid), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) :
+			linearDepthDescriptor;
+		if (depthPyramidSupported) {
+			std::array<VkDescriptorImageInfo, DEPTH_PYRAMID_MAX_LEVELS> levelDescriptors;
+			for (uint32_t i = 0; i < DEPTH_PYRAMID_MAX_LEVELS; i++) {
+				levelDescriptors[i] = vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, renderGraph.getLevelView(renderTargets.depthPyramid, std::min(i, depthPyramidLevels - 1)), VK_IMAGE_LAYOUT_GENERAL);
+			}
+			writeDescriptorSets = {
+				vks::initializers::writeDescriptorSet(descriptorSets.depthPyramid, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &linearDepthDescriptor),							// CS Linear depth
+				vks::initializers::writeDescriptorSet(descriptorSets.depthPyramid, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, levelDescriptors.data(), DEPTH_PYRAMID_MAX_LEVELS),	// CS Pyramid levels
+			};
+			vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+		}
+
+		// SSAO Generation
+		imageDescriptors = {
+			vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.normal), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, view(renderTargets.ssao), VK_IMAGE_LAYOUT_GENERAL),
+		};
+		writeDescriptorSets = {
+			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &positionDescriptor),					// FS/CS Position+Depth
+			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &imageDescriptors[0]),					// FS/CS Normals
+			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &ssaoNoise.descriptor),		// FS/CS SSAO Noise
+			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 3, &uniformDescriptors.ssaoKernel),		// FS/CS SSAO Kernel UBO
+			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 4, &uniformDescriptors.ssaoParams),		// FS/CS SSAO Params UBO
+			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6, &linearDepthDescriptor),				// FS/CS Linear depth
+			vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 7, &depthPyramidDescriptor),				// FS/CS Depth pyramid
+		};
+		// The storage image can only be written if the device supports it for the SSAO target format
+		if (computeSSAOSupported) {
+			writeDescriptorSets.push_back(vks::initializers::writeDescriptorSet(descriptorSets.ssao, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 5, &imageDescriptors[1]));	// CS SSAO output
+		}
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+		// Deinterleaved SSAO
+		if (computeSSAOSupported) {
+			imageDescriptors = {
+				vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.normal), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+				vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, view(renderTargets.deinterleavedDepth), VK_IMAGE_LAYOUT_GENERAL),
+				vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, view(renderTargets.deinterleavedNormal), VK_IMAGE_LAYOUT_GENERAL),
+				vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.deinterleavedDepth), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+				vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.deinterleavedNormal), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+				vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, view(renderTargets.deinterleavedAO), VK_IMAGE_LAYOUT_GENERAL),
+				vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.deinterleavedAO), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+				vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, view(renderTargets.ssao), VK_IMAGE_LAYOUT_GENERAL),
+			};
+			writeDescriptorSets = {
+				vks::initializers::writeDescriptorSet(descriptorSets.deinterleave, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &linearDepthDescriptor),					// CS Linear depth
+				vks::initializers::writeDescriptorSet(descriptorSets.deinterleave, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &imageDescriptors[0]),					// CS Normals
+				vks::initializers::writeDescriptorSet(descriptorSets.deinterleave, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2, &imageDescriptors[1]),								// CS Depth layers
+				vks::initializers::writeDescriptorSet(descriptorSets.deinterleave, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 3, &imageDescriptors[2]),								// CS Normal layers
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoDeinterleaved, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[3]),				// CS Depth layers
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoDeinterleaved, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &imageDescriptors[4]),				// CS Normal layers
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoDeinterleaved, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &ssaoNoise.descriptor),				// CS SSAO Noise
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoDeinterleaved, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 3, &uniformDescriptors.ssaoKernel),		// CS SSAO Kernel UBO
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoDeinterleaved, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 4, &uniformDescriptors.ssaoParams),		// CS SSAO Params UBO
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoDeinterleaved, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 5, &imageDescriptors[5]),						// CS SSAO layers
+				vks::initializers::writeDescriptorSet(descriptorSets.reinterleave, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[6]),					// CS SSAO layers
+				vks::initializers::writeDescriptorSet(descriptorSets.reinterleave, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, &imageDescriptors[7]),								// CS SSAO output
+			};
+			vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+		}
+
+		// SSAO temporal accumulation
 		imageDescriptors = {
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.offscreen.position.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.offscreen.normal.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.offscreen.albedo.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.ssao.color.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
-			vks::initializers::descriptorImageInfo(colorSampler, frameBuffers.ssaoBlur.color.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.ssao), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.history), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
 		};
 		writeDescriptorSets = {
-			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[0]),			// FS Sampler Position+Depth
-			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &imageDescriptors[1]),			// FS Sampler Normals
-			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &imageDescriptors[2]),			// FS Sampler Albedo
-			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, &imageDescriptors[3]),			// FS Sampler SSAO
-			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, &imageDescriptors[4]),			// FS Sampler SSAO blurred
-			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 5, &uniformBuffers.ssaoParams.descriptor),	// FS SSAO Params UBO
+			vks::initializers::writeDescriptorSet(descriptorSets.temporal, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[0]),				// FS Sampler SSAO
+			vks::initializers::writeDescriptorSet(descriptorSets.temporal, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &linearDepthDescriptor),			// FS Sampler Linear depth
+			vks::initializers::writeDescriptorSet(descriptorSets.temporal, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &imageDescriptors[1]),				// FS Sampler History
+			vks::initializers::writeDescriptorSet(descriptorSets.temporal, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 3, &uniformDescriptors.ssaoParams),	// FS SSAO Params UBO
 		};
 		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+		// SSAO Blur
+		// The intermediate image only exists if the compute blur is supported
+		const VkImageView blurIntermediateView = computeSSAOSupported ? view(renderTargets.blurIntermediate) : VK_NULL_HANDLE;
+		imageDescriptors = {
+			vks::initializers::descriptorImageInfo(colorSampler, ssaoResultView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(colorSampler, blurIntermediateView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, blurIntermediateView, VK_IMAGE_LAYOUT_GENERAL),
+			vks::initializers::descriptorImageInfo(VK_NULL_HANDLE, view(renderTargets.blur), VK_IMAGE_LAYOUT_GENERAL),
+		};
+		writeDescriptorSets = {
+			vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlurFragment, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[0]),
+		};
+		// The separable blur reads the SSAO target horizontally into the intermediate image, and that vertically into the blur target
+		if (computeSSAOSupported) {
+			writeDescriptorSets.insert(writeDescriptorSets.end(), {
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlurHorizontal, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[0]),	// CS Sampler SSAO
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlurHorizontal, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &linearDepthDescriptor),	// CS Linear depth
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlurHorizontal, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2, &imageDescriptors[2]),			// CS Intermediate output
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlurVertical, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[1]),		// CS Sampler intermediate
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlurVertical, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &linearDepthDescriptor),	// CS Linear depth
+				vks::initializers::writeDescriptorSet(descriptorSets.ssaoBlurVertical, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2, &imageDescriptors[3]),				// CS Blur output
+			});
+		}
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+		// SSAO upsample
+		// Without blur the blur target is never written, so the unblurred result is bound in its place
+		const VkImageView ssaoBlurredView = uboSSAOParams.ssaoBlur ? view(renderTargets.blur) : ssaoResultView;
+		imageDescriptors = {
+			vks::initializers::descriptorImageInfo(colorSampler, ssaoResultView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(colorSampler, ssaoBlurredView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+		};
+		writeDescriptorSets = {
+			vks::initializers::writeDescriptorSet(descriptorSets.upsample, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &imageDescriptors[0]),				// FS Sampler SSAO
+			vks::initializers::writeDescriptorSet(descriptorSets.upsample, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &imageDescriptors[1]),				// FS Sampler SSAO blurred
+			vks::initializers::writeDescriptorSet(descriptorSets.upsample, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &linearDepthDescriptor),			// FS Sampler Linear depth
+			vks::initializers::writeDescriptorSet(descriptorSets.upsample, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, &positionDescriptor),				// FS Sampler Position+Depth
+			vks::initializers::writeDescriptorSet(descriptorSets.upsample, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 4, &uniformDescriptors.ssaoParams),	// FS SSAO Params UBO
+		};
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+		// Composition
+		// If SSAO runs at a lower resolution, the upsampling pass already selects between the blurred and the unblurred result
+		// If no AO is displayed, all SSAO passes are culled and the AO bindings point at the albedo target instead, which the composition never samples through them
+		const bool upsample = getSSAOScale() > 1;
+		const bool displayAO = uboSSAOParams.ssao || uboSSAOParams.ssaoOnly;
+		const VkImageView albedoView = view(renderTargets.albedo);
+		const VkImageView compositionSSAOView = !displayAO ? albedoView : (upsample ? view(renderTargets.upsample) : ssaoResultView);
+		const VkImageView compositionSSAOBlurredView = !displayAO ? albedoView : (upsample ? view(renderTargets.upsample) : ssaoBlurredView);
+		imageDescriptors = {
+			vks::initializers::descriptorImageInfo(colorSampler, view(renderTargets.normal), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(colorSampler, albedoView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(colorSampler, compositionSSAOView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			vks::initializers::descriptorImageInfo(colorSampler, compositionSSAOBlurredView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+		};
+		writeDescriptorSets = {
+			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &positionDescriptor),			// FS Sampler Position+Depth
+			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &imageDescriptors[0]),			// FS Sampler Normals
+			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &imageDescriptors[1]),			// FS Sampler Albedo
+			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, &imageDescriptors[2]),			// FS Sampler SSAO
+			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, &imageDescriptors[3]),			// FS Sampler SSAO blurred
+			vks::initializers::writeDescriptorSet(descriptorSets.composition, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 5, &uniformDescriptors.ssaoParams),	// FS SSAO Params UBO
+		};
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+	}
+
+	SSAOSpecializationData getSSAOSpecializationData(uint32_t kernelSize, float radius)
+	{
+		SSAOSpecializationData specializationData{};
+		specializationData.kernelSize = kernelSize;
+		specializationData.radius = radius;
+		specializationData.positionFromDepth = positionFromDepth;
+		specializationData.normalEncoding = normalEncoding;
+		return specializationData;
+	}
+
+	// Values from the command line or a benchmark sweep file, returns false if the value is not a positive number
+	static bool parsePositiveFloat(const std::string& value, float& result)
+	{
+		char* end = nullptr;
+		result = strtof(value.c_str(), &end);
+		return !value.empty() && (*end == '\0') && std::isfinite(result) && (result > 0.0f);
+	}
+
+	static bool parsePositiveInt(const std::string& value, int32_t& result)
+	{
+		char* end = nullptr;
+		const long parsed = strtol(value.c_str(), &end, 10);
+		if (value.empty() || (*end != '\0') || (parsed <= 0) || (parsed > std::numeric_limits<int32_t>::max())) {
+			return false;
+		}
+		result = static_cast<int32_t>(parsed);
+		return true;
+	}
+
+	// Radii that are not one of the presets are added as an additional variant, returns the index of the radius
+	int32_t addSSAORadius(float radius)
+	{
+		radius = std::max(radius, 0.01f);
+		auto it = std::find_if(ssaoRadii.begin(), ssaoRadii.end(), [radius](float r) { return std::abs(r - radius) < 0.001f; });
+		if (it == ssaoRadii.end()) {
+			it = ssaoRadii.insert(std::upper_bound(ssaoRadii.begin(), ssaoRadii.end(), radius), radius);
+		}
+		return static_cast<int32_t>(it - ssaoRadii.begin());
+	}
+
+	// Largest preset kernel size not exceeding the requested size
+	int32_t getSSAOKernelSizeIndex(int32_t kernelSize)
+	{
+		int32_t index = 0;
+		for (size_t i = 0; i < ssaoKernelSizes.size(); i++) {
+			if (ssaoKernelSizes[i] <= static_cast<uint32_t>(std::max(kernelSize, 1))) {
+				index = static_cast<int32_t>(i);
+			}
+		}
+		return index;
+	}
+
+	uint32_t getSSAOVariantIndex(int32_t kernelSizeIndex, int32_t radiusIndex)
+	{
+		return static_cast<uint32_t>(kernelSizeIndex) * static_cast<uint32_t>(ssaoRadii.size()) + static_cast<uint32_t>(radiusIndex);
+	}
+
+	// Creates all pipelines of a variant, only uses state local to this function so it can run on the builder thread
+	void createSSAOPipelineVariant(SSAOPipelineVariant& variant)
+	{
+		SSAOSpecializationData specializationData = getSSAOSpecializationData(variant.kernelSize, variant.radius);
+		VkSpecializationInfo specializationInfo = vks::initializers::specializationInfo(static_cast<uint32_t>(ssaoSpecializationMapEntries.size()), ssaoSpecializationMapEntries.data(), sizeof(specializationData), &specializationData);
+
+		// Fullscreen pass state, matches the fullscreen passes in preparePipelines
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = vks::initializers::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
+		VkPipelineRasterizationStateCreateInfo rasterizationState = vks::initializers::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_FRONT_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0);
+		VkPipelineColorBlendAttachmentState blendAttachmentState = vks::initializers::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
+		VkPipelineColorBlendStateCreateInfo colorBlendState = vks::initializers::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
+		VkPipelineDepthStencilStateCreateInfo depthStencilState = vks::initializers::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS_OR_EQUAL);
+		VkPipelineViewportStateCreateInfo viewportState = vks::initializers::pipelineViewportStateCreateInfo(1, 1, 0);
+		VkPipelineMultisampleStateCreateInfo multisampleState = vks::initializers::pipelineMultisampleStateCreateInfo(VK_SAMPLE_COUNT_1_BIT, 0);
+		std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		VkPipelineDynamicStateCreateInfo dynamicState = vks::initializers::pipelineDynamicStateCreateInfo(dynamicStateEnables);
+		VkPipelineVertexInputStateCreateInfo emptyVertexInputState = vks::initializers::pipelineVertexInputStateCreateInfo();
+		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = { ssaoVariantShaderStages.fullscreen, ssaoVariantShaderStages.fullscreen };
+
+		VkGraphicsPipelineCreateInfo pipelineCreateInfo = vks::initializers::pipelineCreateInfo(pipelineLayouts.ssao, renderPasses.ssao, 0);
+		pipelineCreateInfo.pInputAssemblyState = &inputAssemblyState;
+		pipelineCreateInfo.pRasterizationState = &rasterizationState;
+		pipelineCreateInfo.pColorBlendState = &colorBlendState;
+		pipelineCreateInfo.pMultisampleState = &multisampleState;
+		pipelineCreateInfo.pViewportState = &viewportState;
+		pipelineCreateInfo.pDepthStencilState = &depthStencilState;
+		pipelineCreateInfo.pDynamicState = &dynamicState;
+		pipelineCreateInfo.pVertexInputState = &emptyVertexInputState;
+		pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+		pipelineCreateInfo.pStages = shaderStages.data();
+
+		// All AO techniques share the layout and specialization constants, the kernel size is the sample budget for HBAO and GTAO
+		for (uint32_t i = 0; i < AOTechniqueCount; i++) {
+			shaderStages[1] = ssaoVariantShaderStages.ssao[i];
+			shaderStages[1].pSpecializationInfo = &specializationInfo;
+			VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &variant.ssao[i]));
+		}
+
+		// SSAO temporal accumulation, the kernel size decides over how many frames results are accumulated
+		pipelineCreateInfo.renderPass = renderPasses.temporal;
+		pipelineCreateInfo.layout = pipelineLayouts.temporal;
+		shaderStages[1] = ssaoVariantShaderStages.temporal;
+		shaderStages[1].pSpecializationInfo = &specializationInfo;
+		VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &variant.temporal));
+
+		// Compute and deinterleaved SSAO, these use the same specialization constants as the fragment shader path
+		if (computeSSAOSupported) {
+			VkComputePipelineCreateInfo computePipelineCreateInfo = vks::initializers::computePipelineCreateInfo(pipelineLayouts.ssao, 0);
+			computePipelineCreateInfo.stage = ssaoVariantShaderStages.ssaoCompute;
+			computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+			VK_CHECK_RESULT(vkCreateComputePipelines(device, pipelineCache, 1, &computePipelineCreateInfo, nullptr, &variant.ssaoCompute));
+
+			computePipelineCreateInfo.layout = pipelineLayouts.ssaoDeinterleaved;
+			computePipelineCreateInfo.stage = ssaoVariantShaderStages.ssaoDeinterleaved;
+			computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+			VK_CHECK_RESULT(vkCreateComputePipelines(device, pipelineCache, 1, &computePipelineCreateInfo, nullptr, &variant.ssaoDeinterleaved));
+		}
+	}
+
+	// Builds the variant selected at startup right away and queues all other variants on the builder thread
+	void prepareSSAOPipelineVariants()
+	{
+		ssaoVariantShaderStages.fullscreen = loadShader(getShadersPath() + "ssao/fullscreen.vert.spv", VK_SHADER_STAGE_VERTEX_BIT);
+		for (uint32_t i = 0; i < AOTechniqueCount; i++) {
+			ssaoVariantShaderStages.ssao[i] = loadShader(getShadersPath() + "ssao/" + aoTechniqueShaders[i], VK_SHADER_STAGE_FRAGMENT_BIT);
+		}
+		ssaoVariantShaderStages.temporal = loadShader(getShadersPath() + "ssao/temporal.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
+		if (computeSSAOSupported) {
+			ssaoVariantShaderStages.ssaoCompute = loadShader(getShadersPath() + "ssao/ssao.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+			ssaoVariantShaderStages.ssaoDeinterleaved = loadShader(getShadersPath() + "ssao/ssaodeinterleaved.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+		}
+
+		ssaoPipelineVariants = std::vector<SSAOPipelineVariant>(ssaoKernelSizes.size() * ssaoRadii.size());
+		for (size_t k = 0; k < ssaoKernelSizes.size(); k++) {
+			for (size_t r = 0; r < ssaoRadii.size(); r++) {
+				SSAOPipelineVariant& variant = ssaoPipelineVariants[getSSAOVariantIndex(static_cast<int32_t>(k), static_cast<int32_t>(r))];
+				variant.kernelSize = ssaoKernelSizes[k];
+				variant.radius = ssaoRadii[r];
+			}
+		}
+
+		const uint32_t initialVariant = getSSAOVariantIndex(ssaoKernelSizeIndex, ssaoRadiusIndex);
+		{
+			VKS_TRACE_SCOPE("createSSAOPipelineVariant");
+			const auto buildStart = std::chrono::high_resolution_clock::now();
+			createSSAOPipelineVariant(ssaoPipelineVariants[initialVariant]);
+			pipelineCreationTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+		}
+		ssaoPipelineVariants[initialVariant].ready = true;
+		activateSSAOPipelineVariant(initialVariant);
+
+		// The pipeline creation time is reported by render() once the builder is done
+		deferPipelineCreationReport = true;
+		// Pipeline creation with the shared pipeline cache is thread safe, the shader modules and layouts outlive the builder
+		ssaoVariantBuilder.reset(new vks::Thread());
+		ssaoVariantBuilder->addJob([this, initialVariant] {
+			vks::trace::setThreadName("SSAO variant builder");
+			const auto buildStart = std::chrono::high_resolution_clock::now();
+			for (uint32_t i = 0; i < static_cast<uint32_t>(ssaoPipelineVariants.size()); i++) {
+				if (ssaoVariantBuilderCancelled) {
+					return;
+				}
+				if (i != initialVariant) {
+					VKS_TRACE_SCOPE("createSSAOPipelineVariant");
+					createSSAOPipelineVariant(ssaoPipelineVariants[i]);
+					ssaoPipelineVariants[i].ready = true;
+				}
+			}
+			ssaoVariantBuildTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+			ssaoVariantsBuilt = true;
+		});
+	}
+
+	// Selects the pipelines of a ready variant, called between frames on the render thread
+	void activateSSAOPipelineVariant(uint32_t index)
+	{
+		const SSAOPipelineVariant& variant = ssaoPipelineVariants[index];
+		assert(variant.ready);
+		pipelines.ssao = variant.ssao;
+		pipelines.ssaoCompute = variant.ssaoCompute;
+		pipelines.ssaoDeinterleaved = variant.ssaoDeinterleaved;
+		pipelines.temporal = variant.temporal;
+		// The kernel for the variant's size is uploaded to each frame's slot in updateUniformBufferSSAOKernel()
+		activeSSAOVariant = index;
+		calculateGBufferFootprints();
+		// Accumulated results of a different kernel or radius are not valid anymore
+		resetTemporalHistory();
 	}
 
 	void preparePipelines()
 	{
+		VKS_TRACE_SCOPE("preparePipelines");
 		// Layouts
 		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = vks::initializers::pipelineLayoutCreateInfo();
 
@@ -745,14 +1770,62 @@ public:
 		pipelineLayoutCreateInfo.setLayoutCount = 1;
 		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.ssao));
 
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.ssaoBlurFragment;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.ssaoBlurFragment));
+
+		// The blur direction and radius are passed as push constants
+		VkPushConstantRange blurPushConstantRange = vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(BlurPushConstants), 0);
 		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.ssaoBlur;
 		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &blurPushConstantRange;
 		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.ssaoBlur));
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+		pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
 
 		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.composition;
 		pipelineLayoutCreateInfo.setLayoutCount = 1;
 		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.composition));
 
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.depthDownsample;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.depthDownsample));
+
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.upsample;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.upsample));
+
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.temporal;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.temporal));
+
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.deinterleave;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.deinterleave));
+
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.reinterleave;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.reinterleave));
+
+		// The size of the interleaved SSAO target is passed as a push constant
+		VkPushConstantRange ssaoDeinterleavedPushConstantRange = vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(glm::ivec2), 0);
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.ssaoDeinterleaved;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &ssaoDeinterleavedPushConstantRange;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.ssaoDeinterleaved));
+
+		// The number of pyramid levels is passed as a push constant
+		VkPushConstantRange depthPyramidPushConstantRange = vks::initializers::pushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, sizeof(int32_t), 0);
+		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayouts.depthPyramid;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &depthPyramidPushConstantRange;
+		VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayouts.depthPyramid));
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+		pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
+
 		// Pipelines
 		VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = vks::initializers::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
 		VkPipelineRasterizationStateCreateInfo rasterizationState = vks::initializers::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0);
@@ -781,38 +1854,94 @@ public:
 		pipelineCreateInfo.pVertexInputState = &emptyVertexInputState;
 		rasterizationState.cullMode = VK_CULL_MODE_FRONT_BIT;
 
+		// The position mode and normal encoding are passed to the G-Buffer and composition shaders as specialization constants
+		struct GBufferSpecializationData {
+			VkBool32 positionFromDepth;
+			int32_t normalEncoding;
+		} gBufferSpecializationData;
+		gBufferSpecializationData.positionFromDepth = positionFromDepth;
+		gBufferSpecializationData.normalEncoding = normalEncoding;
+		std::array<VkSpecializationMapEntry, 2> gBufferSpecializationMapEntries = {
+			vks::initializers::specializationMapEntry(0, offsetof(GBufferSpecializationData, positionFromDepth), sizeof(GBufferSpecializationData::positionFromDepth)),
+			vks::initializers::specializationMapEntry(1, offsetof(GBufferSpecializationData, normalEncoding), sizeof(GBufferSpecializationData::normalEncoding))
+		};
+		VkSpecializationInfo gBufferSpecializationInfo = vks::initializers::specializationInfo(static_cast<uint32_t>(gBufferSpecializationMapEntries.size()), gBufferSpecializationMapEntries.data(), sizeof(gBufferSpecializationData), &gBufferSpecializationData);
+
 		// Final composition pipeline
 		shaderStages[0] = loadShader(getShadersPath() + "ssao/fullscreen.vert.spv", VK_SHADER_STAGE_VERTEX_BIT);
 		shaderStages[1] = loadShader(getShadersPath() + "ssao/composition.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
-		VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &pipelines.composition));
-
-		// SSAO generation pipeline
-		pipelineCreateInfo.renderPass = frameBuffers.ssao.renderPass;
+		shaderStages[1].pSpecializationInfo = &gBufferSpecializationInfo;
+		pipelineQueue.add(pipelineCreateInfo, &pipelines.composition);
+
+		// Depth downsample pipeline
+		pipelineCreateInfo.renderPass = renderPasses.linearDepth;
+		pipelineCreateInfo.layout = pipelineLayouts.depthDownsample;
+		shaderStages[1] = loadShader(getShadersPath() + "ssao/depthdownsample.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
+		shaderStages[1].pSpecializationInfo = &gBufferSpecializationInfo;
+		pipelineQueue.add(pipelineCreateInfo, &pipelines.depthDownsample);
+
+		// SSAO upsample pipeline
+		pipelineCreateInfo.renderPass = renderPasses.ssao;
+		pipelineCreateInfo.layout = pipelineLayouts.upsample;
+		shaderStages[1] = loadShader(getShadersPath() + "ssao/upsample.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
+		shaderStages[1].pSpecializationInfo = &gBufferSpecializationInfo;
+		pipelineQueue.add(pipelineCreateInfo, &pipelines.upsample);
+
+		// SSAO pipeline variants for all kernel sizes and radii
+		prepareSSAOPipelineVariants();
+
+		// The remaining SSAO pipelines don't depend on the kernel size and radius and use the values of the initial variant
+		pipelineCreateInfo.renderPass = renderPasses.ssao;
 		pipelineCreateInfo.layout = pipelineLayouts.ssao;
-		// SSAO Kernel size and radius are constant for this pipeline, so we set them using specialization constants
-		struct SpecializationData {
-			uint32_t kernelSize = SSAO_KERNEL_SIZE;
-			float radius = SSAO_RADIUS;
-		} specializationData;
-		std::array<VkSpecializationMapEntry, 2> specializationMapEntries = {
-			vks::initializers::specializationMapEntry(0, offsetof(SpecializationData, kernelSize), sizeof(SpecializationData::kernelSize)),
-			vks::initializers::specializationMapEntry(1, offsetof(SpecializationData, radius), sizeof(SpecializationData::radius))
-		};
-		VkSpecializationInfo specializationInfo = vks::initializers::specializationInfo(2, specializationMapEntries.data(), sizeof(specializationData), &specializationData);
-		shaderStages[1] = loadShader(getShadersPath() + "ssao/ssao.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
-		shaderStages[1].pSpecializationInfo = &specializationInfo;
-		VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &pipelines.ssao));
+		SSAOSpecializationData specializationData = getSSAOSpecializationData(ssaoKernelSizes[ssaoKernelSizeIndex], ssaoRadii[ssaoRadiusIndex]);
+		VkSpecializationInfo specializationInfo = vks::initializers::specializationInfo(static_cast<uint32_t>(ssaoSpecializationMapEntries.size()), ssaoSpecializationMapEntries.data(), sizeof(specializationData), &specializationData);
+		// The benchmark reference is GTAO with a much larger sample budget, which converges towards the ground truth cosine weighted visibility
+		if (aoBenchmark.active) {
+			SSAOSpecializationData referenceSpecializationData = specializationData;
+			referenceSpecializationData.kernelSize = AO_REFERENCE_KERNEL_SIZE;
+			VkSpecializationInfo referenceSpecializationInfo = specializationInfo;
+			referenceSpecializationInfo.pData = &referenceSpecializationData;
+			shaderStages[1] = loadShader(getShadersPath() + "ssao/" + aoTechniqueShaders[AOTechniqueGTAO], VK_SHADER_STAGE_FRAGMENT_BIT);
+			shaderStages[1].pSpecializationInfo = &referenceSpecializationInfo;
+			pipelineQueue.add(pipelineCreateInfo, &pipelines.ssaoReference);
+		}
+
+		// Deinterleave and reinterleave compute pipelines of the deinterleaved SSAO path
+		if (computeSSAOSupported) {
+			VkComputePipelineCreateInfo computePipelineCreateInfo = vks::initializers::computePipelineCreateInfo(pipelineLayouts.deinterleave, 0);
+			computePipelineCreateInfo.stage = loadShader(getShadersPath() + "ssao/deinterleave.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+			computePipelineCreateInfo.stage.pSpecializationInfo = &specializationInfo;
+			pipelineQueue.add(computePipelineCreateInfo, &pipelines.deinterleave);
+
+			computePipelineCreateInfo.layout = pipelineLayouts.reinterleave;
+			computePipelineCreateInfo.stage = loadShader(getShadersPath() + "ssao/reinterleave.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+			pipelineQueue.add(computePipelineCreateInfo, &pipelines.reinterleave);
+		}
+
+		// Depth pyramid compute pipeline
+		if (depthPyramidSupported) {
+			VkComputePipelineCreateInfo computePipelineCreateInfo = vks::initializers::computePipelineCreateInfo(pipelineLayouts.depthPyramid, 0);
+			computePipelineCreateInfo.stage = loadShader(getShadersPath() + "ssao/depthpyramid.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+			pipelineQueue.add(computePipelineCreateInfo, &pipelines.depthPyramid);
+		}
+
+		// Separable SSAO blur compute pipeline, used for both directions
+		if (computeSSAOSupported) {
+			VkComputePipelineCreateInfo computePipelineCreateInfo = vks::initializers::computePipelineCreateInfo(pipelineLayouts.ssaoBlur, 0);
+			computePipelineCreateInfo.stage = loadShader(getShadersPath() + "ssao/blur.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+			pipelineQueue.add(computePipelineCreateInfo, &pipelines.ssaoBlur);
+		}
 
-		// SSAO blur pipeline
-		pipelineCreateInfo.renderPass = frameBuffers.ssaoBlur.renderPass;
-		pipelineCreateInfo.layout = pipelineLayouts.ssaoBlur;
+		// SSAO blur fallback pipeline
+		pipelineCreateInfo.renderPass = renderPasses.ssao;
+		pipelineCreateInfo.layout = pipelineLayouts.ssaoBlurFragment;
 		shaderStages[1] = loadShader(getShadersPath() + "ssao/blur.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
-		VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &pipelines.ssaoBlur));
+		pipelineQueue.add(pipelineCreateInfo, &pipelines.ssaoBlurFragment);
 
 		// Fill G-Buffer pipeline
 		// Vertex input state from glTF model loader
 		pipelineCreateInfo.pVertexInputState = vkglTF::Vertex::getPipelineVertexInputState({ vkglTF::VertexComponent::Position, vkglTF::VertexComponent::UV, vkglTF::VertexComponent::Color, vkglTF::VertexComponent::Normal });
-		pipelineCreateInfo.renderPass = frameBuffers.offscreen.renderPass;
+		pipelineCreateInfo.renderPass = renderPasses.gBuffer;
 		pipelineCreateInfo.layout = pipelineLayouts.gBuffer;
 		// Blend attachment states required for all color attachments
 		// This is important, as color write mask will otherwise be 0x0 and you
@@ -827,7 +1956,11 @@ public:
 		rasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
 		shaderStages[0] = loadShader(getShadersPath() + "ssao/gbuffer.vert.spv", VK_SHADER_STAGE_VERTEX_BIT);
 		shaderStages[1] = loadShader(getShadersPath() + "ssao/gbuffer.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
-		VK_CHECK_RESULT(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineCreateInfo, nullptr, &pipelines.offscreen));
+		shaderStages[1].pSpecializationInfo = &gBufferSpecializationInfo;
+		pipelineQueue.add(pipelineCreateInfo, &pipelines.offscreen);
+
+		// Create all queued pipelines in parallel, the handles are valid once this returns
+		pipelineQueue.build();
 	}
 
 	float lerp(float a, float b, float f)
@@ -835,50 +1968,44 @@ public:
 		return a + f * (b - a);
 	}
 
+	// Dynamic offsets for the kernel (binding 3) and parameter (binding 4) UBOs of the SSAO descriptor sets
+	std::array<uint32_t, 2> getSSAODynamicOffsets()
+	{
+		return { uniformAllocations.ssaoKernel.offset, uniformAllocations.ssaoParams.offset };
+	}
+
 	// Prepare and initialize uniform buffer containing shader uniforms
 	void prepareUniformBuffers()
 	{
-		// Scene matrices
-		vulkanDevice->createBuffer(
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			&uniformBuffers.sceneParams,
-			sizeof(uboSceneParams));
-
-		// SSAO parameters
-		vulkanDevice->createBuffer(
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			&uniformBuffers.ssaoParams,
-			sizeof(uboSSAOParams));
-
-		// Update
-		updateUniformBufferMatrices();
-		updateUniformBufferSSAOParams();
+		// One region per frame in flight, holding the scene parameters, the largest kernel and the SSAO parameters
+		const VkDeviceSize alignment = vulkanDevice->properties.limits.minUniformBufferOffsetAlignment;
+		const VkDeviceSize frameSize =
+			vks::tools::alignedVkSize(sizeof(uboSceneParams), alignment) +
+			vks::tools::alignedVkSize(SSAO_KERNEL_SIZE * sizeof(glm::vec4), alignment) +
+			vks::tools::alignedVkSize(sizeof(uboSSAOParams), alignment);
+		uniformRing.create(vulkanDevice, frameSize, maxFramesInFlight);
+		uniformDescriptors.sceneParams = uniformRing.getDescriptor(sizeof(uboSceneParams));
+		uniformDescriptors.ssaoKernel = uniformRing.getDescriptor(SSAO_KERNEL_SIZE * sizeof(glm::vec4));
+		uniformDescriptors.ssaoParams = uniformRing.getDescriptor(sizeof(uboSSAOParams));
 
 		// SSAO
 		std::default_random_engine rndEngine(benchmark.active ? 0 : (unsigned)time(nullptr));
 		std::uniform_real_distribution<float> rndDist(0.0f, 1.0f);
 
-		// Sample kernel
-		std::vector<glm::vec4> ssaoKernel(SSAO_KERNEL_SIZE);
-		for (uint32_t i = 0; i < SSAO_KERNEL_SIZE; ++i)
-		{
-			glm::vec3 sample(rndDist(rndEngine) * 2.0 - 1.0, rndDist(rndEngine) * 2.0 - 1.0, rndDist(rndEngine));
-			sample = glm::normalize(sample);
-			sample *= rndDist(rndEngine);
-			float scale = float(i) / float(SSAO_KERNEL_SIZE);
-			scale = lerp(0.1f, 1.0f, scale * scale);
-			ssaoKernel[i] = glm::vec4(sample * scale, 0.0f);
-		}
-
-		// Upload as UBO
-		vulkanDevice->createBuffer(
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			&uniformBuffers.ssaoKernel,
-			ssaoKernel.size() * sizeof(glm::vec4),
-			ssaoKernel.data());
+		// Sample kernels, one for each kernel size of the pipeline variants
+		for (uint32_t kernelSize : ssaoKernelSizes) {
+			std::vector<glm::vec4> ssaoKernel(kernelSize);
+			for (uint32_t i = 0; i < kernelSize; ++i)
+			{
+				glm::vec3 sample(rndDist(rndEngine) * 2.0 - 1.0, rndDist(rndEngine) * 2.0 - 1.0, rndDist(rndEngine));
+				sample = glm::normalize(sample);
+				sample *= rndDist(rndEngine);
+				float scale = float(i) / float(kernelSize);
+				scale = lerp(0.1f, 1.0f, scale * scale);
+				ssaoKernel[i] = glm::vec4(sample * scale, 0.0f);
+			}
+			ssaoKernels.push_back(ssaoKernel);
+		}
 
 		// Random noise
 		std::vector<glm::vec4> noiseValues(SSAO_NOISE_DIM * SSAO_NOISE_DIM);
@@ -895,39 +2022,260 @@ public:
 		uboSceneParams.view = camera.matrices.view;
 		uboSceneParams.model = glm::mat4(1.0f);
 
-		VK_CHECK_RESULT(uniformBuffers.sceneParams.map());
-		uniformBuffers.sceneParams.copyTo(&uboSceneParams, sizeof(uboSceneParams));
-		uniformBuffers.sceneParams.unmap();
+		uniformAllocations.sceneParams = uniformRing.push(uboSceneParams);
+	}
+
+	void updateUniformBufferSSAOKernel()
+	{
+		const uint32_t kernelSize = ssaoPipelineVariants[activeSSAOVariant].kernelSize;
+		const size_t kernelIndex = std::find(ssaoKernelSizes.begin(), ssaoKernelSizes.end(), kernelSize) - ssaoKernelSizes.begin();
+		// The allocation covers the descriptor range of the largest kernel, only the active kernel's samples are written
+		uniformAllocations.ssaoKernel = uniformRing.allocate(SSAO_KERNEL_SIZE * sizeof(glm::vec4));
+		memcpy(uniformAllocations.ssaoKernel.mapped, ssaoKernels[kernelIndex].data(), kernelSize * sizeof(glm::vec4));
 	}
 
 	void updateUniformBufferSSAOParams()
 	{
 		uboSSAOParams.projection = camera.matrices.perspective;
-
-		VK_CHECK_RESULT(uniformBuffers.ssaoParams.map());
-		uniformBuffers.ssaoParams.copyTo(&uboSSAOParams, sizeof(uboSSAOParams));
-		uniformBuffers.ssaoParams.unmap();
+		uboSSAOParams.invProjection = glm::inverse(camera.matrices.perspective);
+
+		// Temporal accumulation
+		const glm::mat4 viewProjection = camera.matrices.perspective * camera.matrices.view;
+		uboSSAOParams.reprojection = previousViewProjection * glm::inverse(camera.matrices.view);
+		previousViewProjection = viewProjection;
+		uboSSAOParams.frameIndex = temporalSSAO ? static_cast<int32_t>(temporalFrameIndex) : 0;
+		const int32_t kernelSize = static_cast<int32_t>(ssaoPipelineVariants[activeSSAOVariant].kernelSize);
+		uboSSAOParams.samplesPerFrame = temporalSSAO ? std::min(temporalSamplesIndex == 0 ? 8 : 16, kernelSize) : kernelSize;
+		uboSSAOParams.resetHistory = historyResetPending;
+		historyResetPending = false;
+		// The benchmark reference reads all samples from the full resolution linear depth
+		uboSSAOParams.depthPyramidLevels = (depthPyramidEnabled && !aoBenchmark.renderingReference()) ? static_cast<int32_t>(depthPyramidLevels) : 0;
+
+		uniformAllocations.ssaoParams = uniformRing.push(uboSSAOParams);
 	}
 
 	void prepare()
 	{
+		VKS_TRACE_SCOPE("prepare");
 		VulkanExampleBase::prepare();
+		profiler.create(vulkanDevice, maxFramesInFlight);
 		loadAssets();
-		prepareOffscreenFramebuffers();
+		calculateNormalEncodingErrors();
+		prepareRenderGraph();
 		prepareUniformBuffers();
 		setupDescriptors();
+		// The footprints are calculated once the initial SSAO variant has been activated
 		preparePipelines();
-		buildCommandBuffers();
+		if (benchmark.active) {
+			printGBufferStatistics();
+		}
+		if (aoBenchmark.active) {
+			prepareAOBenchmark();
+		}
 		prepared = true;
 	}
 
-	void draw()
+	void prepareAOBenchmark()
+	{
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = BenchmarkPassCount + 1;
+		const VkDeviceSize readbackSize = static_cast<VkDeviceSize>(ssaoExtent.width) * ssaoExtent.height;
+		aoBenchmark.submissions.resize(maxFramesInFlight);
+		for (AOBenchmark::Submission& submission : aoBenchmark.submissions) {
+			VK_CHECK_RESULT(vkCreateQueryPool(device, &queryPoolInfo, nullptr, &submission.queryPool));
+			VK_CHECK_RESULT(vulkanDevice->createBuffer(
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&submission.readback,
+				readbackSize));
+			VK_CHECK_RESULT(submission.readback.map());
+		}
+		aoBenchmark.reference.resize(static_cast<size_t>(readbackSize));
+	}
+
+	// Camera path used if none is passed with --camerapath, the camera moves between the keyframes while turning around
+	void createDefaultAOBenchmarkPath()
+	{
+		aoBenchmark.cameraPath.keyframes = {
+			{ 0, { 1.0f, 0.75f, 0.0f }, { 0.0f, 90.0f, 0.0f }, "" },
+			{ 16, { 4.0f, 0.75f, 0.5f }, { -10.0f, 180.0f, 0.0f }, "" },
+			{ 32, { 1.0f, 2.5f, -0.5f }, { 15.0f, 270.0f, 0.0f }, "" },
+			{ 48, { -4.0f, 0.75f, 0.0f }, { 0.0f, 360.0f, 0.0f }, "" },
+			{ 63, { 1.0f, 0.75f, 0.0f }, { 0.0f, 450.0f, 0.0f }, "" },
+		};
+	}
+
+	// Selects the path frame and technique of the next submission, every path frame is rendered with the reference first and then with each technique
+	void selectAOBenchmarkSubmission()
+	{
+		const uint32_t submissionsPerFrame = AOTechniqueCount + 1;
+		aoBenchmark.frame = aoBenchmark.submitted / submissionsPerFrame;
+		aoBenchmark.technique = static_cast<int32_t>(aoBenchmark.submitted % submissionsPerFrame) - 1;
+		if (!aoBenchmark.renderingReference()) {
+			aoTechnique = aoBenchmark.technique;
+		}
+		aoBenchmark.cameraPath.apply(camera, aoBenchmark.frame);
+	}
+
+	// Collects the timestamps and the AO readback of a submission whose fence has been waited for
+	// Submissions are collected in the order they were made, so the reference of a path frame is always available before its techniques
+	void collectAOBenchmarkResults(AOBenchmark::Submission& submission)
 	{
-		VulkanExampleBase::prepareFrame();
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &drawCmdBuffers[currentBuffer];
-		VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
-		VulkanExampleBase::submitFrame();
+		if (!submission.pending) {
+			return;
+		}
+		submission.pending = false;
+		const uint8_t* ao = static_cast<const uint8_t*>(submission.readback.mapped);
+		if (submission.technique < 0) {
+			memcpy(aoBenchmark.reference.data(), ao, aoBenchmark.reference.size());
+			return;
+		}
+		AOBenchmark::Result& result = aoBenchmark.results[submission.technique];
+		std::array<uint64_t, BenchmarkPassCount + 1> timestamps{};
+		VK_CHECK_RESULT(vkGetQueryPoolResults(device, submission.queryPool, 0, BenchmarkPassCount + 1, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+		const double timestampPeriod = vulkanDevice->properties.limits.timestampPeriod;
+		for (uint32_t pass = 0; pass < BenchmarkPassCount; pass++) {
+			result.passTimes[pass] += static_cast<double>(timestamps[pass + 1] - timestamps[pass]) * timestampPeriod / 1000000.0;
+		}
+		for (size_t i = 0; i < aoBenchmark.reference.size(); i++) {
+			const double difference = (static_cast<double>(ao[i]) - static_cast<double>(aoBenchmark.reference[i])) / 255.0;
+			result.squaredError += difference * difference;
+		}
+		result.pixelCount += aoBenchmark.reference.size();
+	}
+
+	// Waits once for the submissions still in flight after the last one, collects them from the oldest on and writes the results
+	void finishAOBenchmark()
+	{
+		VK_CHECK_RESULT(vkQueueWaitIdle(queue));
+		for (uint32_t i = 0; i < maxFramesInFlight; i++) {
+			collectAOBenchmarkResults(aoBenchmark.submissions[(currentFrame + i) % maxFramesInFlight]);
+		}
+		saveAOBenchmarkResults();
+	}
+
+	// Average GPU time per pass and frame and the root mean square error against the reference for each technique
+	void saveAOBenchmarkResults()
+	{
+		std::stringstream table;
+		table << std::fixed << std::setprecision(4);
+		table << "technique";
+		for (const std::string& name : benchmarkPassNames) {
+			table << "," << name << " (ms)";
+		}
+		table << ",total (ms),rmse\n";
+		for (uint32_t i = 0; i < AOTechniqueCount; i++) {
+			const AOBenchmark::Result& result = aoBenchmark.results[i];
+			double total = 0.0;
+			table << aoTechniqueNames[i];
+			for (double passTime : result.passTimes) {
+				table << "," << passTime / aoBenchmark.pathFrames;
+				total += passTime / aoBenchmark.pathFrames;
+			}
+			table << "," << total << "," << std::sqrt(result.squaredError / std::max<double>(static_cast<double>(result.pixelCount), 1.0)) << "\n";
+		}
+		std::cout << "AO technique benchmark (" << aoBenchmark.pathFrames << " frames, " << ssaoExtent.width << "x" << ssaoExtent.height << " AO, reference: GTAO with " << AO_REFERENCE_KERNEL_SIZE << " samples)\n";
+		std::cout << table.str();
+		std::ofstream result(aoBenchmark.filename, std::ios::out);
+		if (result.is_open()) {
+			result << table.str();
+		}
+	}
+
+	// Discards the accumulated temporal SSAO history with the next frame, e.g. after a camera cut
+	void resetTemporalHistory()
+	{
+		historyResetPending = true;
+	}
+
+	// Recreates the render targets and passes of the graph and the descriptors referencing them
+	void rebuildRenderGraph()
+	{
+		vkDeviceWaitIdle(device);
+		buildRenderGraph();
+		updateDescriptorSets();
+	}
+
+	// All render targets are derived from the window size
+	virtual void windowResized()
+	{
+		rebuildRenderGraph();
+	}
+
+	// Benchmark sweep parameters, only the pipelines and attachments affected by a parameter are changed
+	virtual bool applySweepParameter(const std::string& name, const std::string& value)
+	{
+		// Invalid values are reported and leave the current setting unchanged, the parameter itself is known
+		if ((name == "kernelsize") || (name == "radius")) {
+			if (name == "kernelsize") {
+				int32_t kernelSize;
+				if (!parsePositiveInt(value, kernelSize)) {
+					std::cerr << "Invalid kernel size \"" << value << "\", expected a positive integer" << "\n";
+					return true;
+				}
+				ssaoKernelSizeIndex = getSSAOKernelSizeIndex(kernelSize);
+			} else {
+				float radius;
+				if (!parsePositiveFloat(value, radius)) {
+					std::cerr << "Invalid radius \"" << value << "\", expected a positive number" << "\n";
+					return true;
+				}
+				// All valid sweep radii have been added as variants in the constructor
+				ssaoRadiusIndex = addSSAORadius(radius);
+			}
+			const uint32_t variant = getSSAOVariantIndex(ssaoKernelSizeIndex, ssaoRadiusIndex);
+			if (!ssaoPipelineVariants[variant].ready) {
+				ssaoVariantBuilder->wait();
+			}
+			if (variant != activeSSAOVariant) {
+				activateSSAOPipelineVariant(variant);
+			}
+			return true;
+		}
+		if (name == "blur") {
+			uboSSAOParams.ssaoBlur = (value == "1") || (value == "on") || (value == "true");
+			return true;
+		}
+		if (name == "ssaoscale") {
+			// The render graph is rebuilt for the new resolution with the next frame
+			int32_t scale;
+			if (!parsePositiveInt(value, scale)) {
+				std::cerr << "Invalid SSAO scale \"" << value << "\", expected 1, 2 or 4" << "\n";
+				return true;
+			}
+			ssaoScaleIndex = (scale >= 4) ? 2 : (scale >= 2) ? 1 : 0;
+			return true;
+		}
+		return false;
+	}
+
+	// Uniform data is only written once beginFrame() has waited for the frame in flight and reset its ring buffer region
+	bool draw()
+	{
+		if (!VulkanExampleBase::beginFrame()) {
+			return false;
+		}
+		if (aoBenchmark.active) {
+			// The frame's fence has been waited for, so the results of its previous submission are available
+			AOBenchmark::Submission& submission = aoBenchmark.submissions[currentFrame];
+			collectAOBenchmarkResults(submission);
+			if (aoBenchmark.running()) {
+				submission.frame = aoBenchmark.frame;
+				submission.technique = aoBenchmark.technique;
+				submission.pending = true;
+			}
+		}
+		{
+			VKS_TRACE_SCOPE("updateUniformBuffers");
+			updateUniformBufferMatrices();
+			updateUniformBufferSSAOKernel();
+			updateUniformBufferSSAOParams();
+		}
+		buildCommandBuffer();
+		VulkanExampleBase::endFrame();
+		return true;
 	}
 
 	virtual void render()
@@ -935,9 +2283,34 @@ public:
 		if (!prepared) {
 			return;
 		}
-		updateUniformBufferMatrices();
-		updateUniformBufferSSAOParams();
-		draw();
+		// The technique of the next submission changes the render graph, so it is selected first
+		if (aoBenchmark.running()) {
+			selectAOBenchmarkSubmission();
+		}
+		// Switch to the requested kernel size and radius once the builder thread has created its pipelines
+		const uint32_t requestedVariant = getSSAOVariantIndex(ssaoKernelSizeIndex, ssaoRadiusIndex);
+		if ((requestedVariant != activeSSAOVariant) && ssaoPipelineVariants[requestedVariant].ready) {
+			activateSSAOPipelineVariant(requestedVariant);
+		}
+		if (deferPipelineCreationReport && ssaoVariantsBuilt) {
+			pipelineCreationTime += ssaoVariantBuildTime;
+			deferPipelineCreationReport = false;
+			reportPipelineCreationTime();
+		}
+		// Settings changed in the UI or by the benchmark may change which passes run and which images they read
+		if (getRenderGraphConfiguration() != renderGraphConfiguration) {
+			rebuildRenderGraph();
+		}
+		if (!draw()) {
+			return;
+		}
+		temporalFrameIndex++;
+		if (aoBenchmark.running()) {
+			aoBenchmark.submitted++;
+			if (!aoBenchmark.running()) {
+				finishAOBenchmark();
+			}
+		}
 	}
 
 	virtual void OnUpdateUIOverlay(vks::UIOverlay *overlay)
@@ -946,6 +2319,45 @@ public:
 			overlay->checkBox("Enable SSAO", &uboSSAOParams.ssao);
 			overlay->checkBox("SSAO blur", &uboSSAOParams.ssaoBlur);
 			overlay->checkBox("SSAO pass only", &uboSSAOParams.ssaoOnly);
+			overlay->comboBox("AO technique", &aoTechnique, aoTechniqueNames);
+			overlay->comboBox("Kernel size", &ssaoKernelSizeIndex, ssaoKernelSizeNames);
+			overlay->comboBox("Radius", &ssaoRadiusIndex, ssaoRadiusNames);
+			if (!ssaoPipelineVariants[getSSAOVariantIndex(ssaoKernelSizeIndex, ssaoRadiusIndex)].ready) {
+				overlay->text("Building pipelines...");
+			}
+			if (computeSSAOSupported) {
+				overlay->checkBox("Compute shader SSAO", &computeSSAO);
+				overlay->checkBox("Deinterleaved SSAO", &deinterleavedSSAO);
+			}
+			if (computeSSAOSupported) {
+				overlay->sliderInt("Blur radius", &blurRadius, 1, 16);
+			}
+			if (depthPyramidSupported) {
+				overlay->checkBox("Depth pyramid", &depthPyramidEnabled);
+			}
+			overlay->checkBox("Temporal SSAO", &temporalSSAO);
+			if (temporalSSAO) {
+				overlay->comboBox("Samples per frame", &temporalSamplesIndex, temporalSamplesNames);
+				if (overlay->button("Reset history")) {
+					resetTemporalHistory();
+				}
+			}
+			overlay->comboBox("SSAO resolution", &ssaoScaleIndex, ssaoScaleNames);
+			overlay->text("SSAO: %dx%d", ssaoExtent.width, ssaoExtent.height);
+			const float MiB = 1024.0f * 1024.0f;
+			overlay->text("Render targets: %.1f MiB (%.1f MiB without aliasing)", (renderTargetMemory.resident + renderTargetMemory.lazilyAllocated) / MiB, renderTargetMemory.unaliased / MiB);
+			overlay->text("Passes: %d (%d culled)", renderTargetMemory.passCount - renderTargetMemory.culledPassCount, renderTargetMemory.culledPassCount);
+		}
+		if (overlay->header("G-Buffer")) {
+			const GBufferFootprint& footprint = gBufferFootprints[positionFromDepth ? 1 : 0];
+			const char* encodingNames[3] = { "rgba8", "oct16", "oct8" };
+			overlay->text("Mode: %s", positionFromDepth ? "position from depth" : "position attachment");
+			overlay->text("Normals: %s", encodingNames[normalEncoding]);
+			overlay->text("Normal error: %.4f deg mean, %.4f deg max", normalEncodingErrors[normalEncoding].mean, normalEncodingErrors[normalEncoding].max);
+			overlay->text("Memory: %d bytes/pixel", footprint.memory);
+			overlay->text("G-Buffer write: %d bytes/pixel", footprint.gBufferWrite);
+			overlay->text("SSAO read: %d bytes/pixel", footprint.ssaoRead);
+			overlay->text("Composition read: %d bytes/pixel", footprint.compositionRead);
 		}
 	}
 };
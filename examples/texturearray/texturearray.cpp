@@ -492,16 +492,13 @@ public:
 			uniformData.instance[i].arrayIndex = (float)i;
 		}
 
+		// Map persistent
+		VK_CHECK_RESULT(uniformBuffer.map());
+
 		// Update instanced part of the uniform buffer
-		uint8_t *pData;
 		uint32_t dataOffset = sizeof(uniformData.matrices);
 		uint32_t dataSize = layerCount * sizeof(PerInstanceData);
-		VK_CHECK_RESULT(vkMapMemory(device, uniformBuffer.memory, dataOffset, dataSize, 0, (void **)&pData));
-		memcpy(pData, uniformData.instance, dataSize);
-		vkUnmapMemory(device, uniformBuffer.memory);
-
-		// Map persistent
-		VK_CHECK_RESULT(uniformBuffer.map());
+		memcpy(static_cast<uint8_t*>(uniformBuffer.mapped) + dataOffset, uniformData.instance, dataSize);
 	}
 
 	void updateUniformBuffersCamera()
@@ -1,35 +1,50 @@
 #version 450
 
-layout (binding = 0) uniform sampler2D samplerposition;
+#extension GL_GOOGLE_include_directive : require
+
+layout (binding = 0) uniform sampler2D samplerPositionDepth;
 layout (binding = 1) uniform sampler2D samplerNormal;
 layout (binding = 2) uniform sampler2D samplerAlbedo;
 layout (binding = 3) uniform sampler2D samplerSSAO;
 layout (binding = 4) uniform sampler2D samplerSSAOBlur;
 layout (binding = 5) uniform UBO 
 {
-	mat4 _dummy;
+	mat4 projection;
+	mat4 invProjection;
 	int ssao;
 	int ssaoOnly;
 	int ssaoBlur;
-} uboParams;
+} ubo;
 
 layout (location = 0) in vec2 inUV;
 
 layout (location = 0) out vec4 outFragColor;
 
+// If set, binding 0 is the depth attachment and view space positions are reconstructed from it
+layout (constant_id = 0) const bool POSITION_FROM_DEPTH = false;
+layout (constant_id = 1) const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.glsl"
+#include "gbufferposition.glsl"
+
 void main() 
 {
-	vec3 fragPos = texture(samplerposition, inUV).rgb;
-	vec3 normal = normalize(texture(samplerNormal, inUV).rgb * 2.0 - 1.0);
+	vec3 fragPos = getViewPosition(inUV);
+	vec3 normal = decodeNormal(texture(samplerNormal, inUV));
 	vec4 albedo = texture(samplerAlbedo, inUV);
-	 
-	float ssao = (uboParams.ssaoBlur == 1) ? texture(samplerSSAOBlur, inUV).r : texture(samplerSSAO, inUV).r;
+
+	// The AO targets are only written if they are used, so they are only sampled then
+	float ssao = 1.0;
+	if (ubo.ssao == 1 || ubo.ssaoOnly == 1)
+	{
+		ssao = (ubo.ssaoBlur == 1) ? texture(samplerSSAOBlur, inUV).r : texture(samplerSSAO, inUV).r;
+	}
 
 	vec3 lightPos = vec3(0.0);
 	vec3 L = normalize(lightPos - fragPos);
 	float NdotL = max(0.5, dot(normal, L));
 
-	if (uboParams.ssaoOnly == 1)
+	if (ubo.ssaoOnly == 1)
 	{
 		outFragColor.rgb = ssao.rrr;
 	}
@@ -37,11 +52,11 @@ void main()
 	{
 		vec3 baseColor = albedo.rgb * NdotL;
 
-		if (uboParams.ssao == 1)
+		if (ubo.ssao == 1)
 		{
 			outFragColor.rgb = ssao.rrr;
 
-			if (uboParams.ssaoOnly != 1)
+			if (ubo.ssaoOnly != 1)
 				outFragColor.rgb *= baseColor;
 		}
 		else
@@ -0,0 +1,26 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+layout (binding = 0) uniform sampler2D samplerPositionDepth;
+
+layout (binding = 1) uniform UBO
+{
+	mat4 projection;
+	mat4 invProjection;
+} ubo;
+
+layout (constant_id = 0) const bool POSITION_FROM_DEPTH = false;
+
+#include "gbufferposition.glsl"
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out float outFragColor;
+
+void main()
+{
+	// Point sample the full resolution G-Buffer at the center of the SSAO texel
+	// This picks the same G-Buffer texel as the nearest lookups of the SSAO pass, so depth and position stay consistent
+	outFragColor = getLinearDepth(inUV);
+}
@@ -0,0 +1,17 @@
+// Sampling of the min/max linear depth pyramid
+// The including shader declares samplerLinearDepth, samplerDepthPyramid and a uniform block instance named ubo that contains depthPyramidLevels
+
+// Samples closer than 2^LOG_MAX_OFFSET pixels to the center always read the full resolution level
+const int LOG_MAX_OFFSET = 3;
+
+// Returns the linear depth at uv, read from the pyramid level that matches the screen space distance to the pixel being shaded
+// Coarser levels return the closest depth of their footprint
+float sampleLinearDepth(vec2 uv, vec2 centerUV, vec2 dim)
+{
+	if (ubo.depthPyramidLevels == 0) {
+		return textureLod(samplerLinearDepth, uv, 0.0).r;
+	}
+	float screenDistance = length((uv - centerUV) * dim);
+	float level = clamp(floor(log2(max(screenDistance, 1.0))) - float(LOG_MAX_OFFSET), 0.0, float(ubo.depthPyramidLevels - 1));
+	return textureLod(samplerDepthPyramid, uv, level).r;
+}
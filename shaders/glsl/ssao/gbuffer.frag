@@ -1,5 +1,7 @@
 #version 450
 
+#extension GL_GOOGLE_include_directive : require
+
 layout (location = 0) in vec3 inNormal;
 layout (location = 1) in vec2 inUV;
 layout (location = 2) in vec3 inColor;
@@ -20,6 +22,12 @@ layout (set = 0, binding = 0) uniform UBO
 
 layout (set = 1, binding = 0) uniform sampler2D samplerColormap;
 
+// If set, view space positions are reconstructed from the depth attachment and the position attachment is unused
+layout (constant_id = 0) const bool POSITION_FROM_DEPTH = false;
+layout (constant_id = 1) const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.glsl"
+
 float linearDepth(float depth)
 {
 	float z = depth * 2.0f - 1.0f; 
@@ -28,7 +36,9 @@ float linearDepth(float depth)
 
 void main() 
 {
-	outPosition = vec4(inPos, linearDepth(gl_FragCoord.z));
-	outNormal = vec4(normalize(inNormal) * 0.5 + 0.5, 1.0);
+	if (!POSITION_FROM_DEPTH) {
+		outPosition = vec4(inPos, linearDepth(gl_FragCoord.z));
+	}
+	outNormal = encodeNormal(normalize(inNormal));
 	outAlbedo = texture(samplerColormap, inUV) * vec4(inColor, 1.0);
 }
\ No newline at end of file
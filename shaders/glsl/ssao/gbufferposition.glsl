@@ -0,0 +1,32 @@
+// Access to the view space positions stored in (or reconstructed from) the G-Buffer
+// The including shader declares samplerPositionDepth, the POSITION_FROM_DEPTH specialization constant
+// and a uniform block instance named ubo that contains the inverse projection matrix
+
+// Returns the view space position, either read from the position attachment or reconstructed from the depth attachment
+vec3 getViewPosition(vec2 uv)
+{
+	if (POSITION_FROM_DEPTH) {
+		vec4 pos = ubo.invProjection * vec4(uv * 2.0 - 1.0, textureLod(samplerPositionDepth, uv, 0.0).r, 1.0);
+		return pos.xyz / pos.w;
+	}
+	return textureLod(samplerPositionDepth, uv, 0.0).rgb;
+}
+
+// Returns the linear view space depth (positive in front of the camera)
+float getLinearDepth(vec2 uv)
+{
+	if (POSITION_FROM_DEPTH) {
+		// Only the z and w rows of the inverse projection depend on the depth value
+		float depth = textureLod(samplerPositionDepth, uv, 0.0).r;
+		return -(ubo.invProjection[2].z * depth + ubo.invProjection[3].z) / (ubo.invProjection[2].w * depth + ubo.invProjection[3].w);
+	}
+	return textureLod(samplerPositionDepth, uv, 0.0).w;
+}
+
+// Returns the view space position for a linear depth (positive in front of the camera) at uv
+vec3 getViewPositionFromLinearDepth(vec2 uv, float linearDepth)
+{
+	vec4 ray = ubo.invProjection * vec4(uv * 2.0 - 1.0, 1.0, 1.0);
+	ray.xyz /= ray.w;
+	return ray.xyz * (linearDepth / -ray.z);
+}
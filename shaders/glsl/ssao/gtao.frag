@@ -0,0 +1,122 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+// Ground truth ambient occlusion (Jimenez et al. 2016)
+// Finds the two horizons in a number of slices around the view vector and integrates the cosine weighted visibility between them
+// Uses the same inputs and output as ssao.frag, the kernel UBO is not used
+
+layout (binding = 0) uniform sampler2D samplerPositionDepth;
+layout (binding = 1) uniform sampler2D samplerNormal;
+layout (binding = 2) uniform sampler2D ssaoNoise;
+layout (binding = 6) uniform sampler2D samplerLinearDepth;
+layout (binding = 7) uniform sampler2D samplerDepthPyramid;
+
+// The kernel size is the sample budget, each slice marches GTAO_STEPS samples in both directions
+layout (constant_id = 0) const int SSAO_KERNEL_SIZE = 64;
+layout (constant_id = 1) const float SSAO_RADIUS = 0.5;
+layout (constant_id = 2) const bool POSITION_FROM_DEPTH = false;
+layout (constant_id = 3) const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.glsl"
+
+layout (binding = 4) uniform UBO
+{
+	mat4 projection;
+	mat4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	mat4 reprojection;
+	int samplesPerFrame;
+	int resetHistory;
+	int depthPyramidLevels;
+} ubo;
+
+#include "gbufferposition.glsl"
+#include "depthpyramid.glsl"
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out float outFragColor;
+
+const int GTAO_STEPS = 8;
+// Rounded up so that small kernels still evaluate one slice
+const int GTAO_SLICES = (SSAO_KERNEL_SIZE + 2 * GTAO_STEPS - 1) / (2 * GTAO_STEPS);
+const float PI = 3.14159265359;
+const float HALF_PI = 1.57079632679;
+
+// Returns the cosine of the angle between the view vector and the direction to the sample
+// Samples are faded towards the lowest possible horizon between 60% and 100% of the radius
+float horizonCos(vec2 sampleUV, vec2 centerUV, vec2 dim, vec3 fragPos, vec3 viewDir, float lowHorizonCos)
+{
+	vec3 samplePos = getViewPositionFromLinearDepth(sampleUV, sampleLinearDepth(clamp(sampleUV, 0.0, 1.0), centerUV, dim));
+	vec3 delta = samplePos - fragPos;
+	float dist = length(delta);
+	float weight = clamp((SSAO_RADIUS - dist) / (0.4 * SSAO_RADIUS), 0.0, 1.0);
+	return mix(lowHorizonCos, dot(delta / max(dist, 1e-6), viewDir), weight);
+}
+
+void main()
+{
+	vec3 fragPos = getViewPosition(inUV);
+	float depth = -fragPos.z;
+	// Background pixels without a position are not occluded
+	if (depth <= 0.0) {
+		outFragColor = 1.0;
+		return;
+	}
+	vec3 normal = decodeNormal(texture(samplerNormal, inUV));
+	vec3 viewDir = normalize(-fragPos);
+	vec2 dim = vec2(textureSize(samplerLinearDepth, 0));
+
+	// Project the view space radius to pixels, steps are at least one pixel apart
+	float radiusPixels = 0.5 * SSAO_RADIUS * abs(ubo.projection[1][1]) * dim.y / depth;
+	float stepPixels = max(radiusPixels / float(GTAO_STEPS), 1.0);
+
+	// Per pixel rotation of the slices and jitter of the steps from the noise texture
+	ivec2 noiseDim = textureSize(ssaoNoise, 0);
+	vec2 noise = texelFetch(ssaoNoise, ivec2(inUV * dim) % noiseDim, 0).xy * 0.5 + 0.5;
+
+	float visibility = 0.0;
+	for (int slice = 0; slice < GTAO_SLICES; slice++)
+	{
+		float phi = (float(slice) + noise.x) * PI / float(GTAO_SLICES);
+		vec2 direction = vec2(cos(phi), sin(phi));
+
+		// View space direction of the slice, found by unprojecting the screen space direction at the pixel's depth
+		vec3 sliceDir = normalize(getViewPositionFromLinearDepth(inUV + direction / dim, depth) - getViewPositionFromLinearDepth(inUV, depth));
+		vec3 orthoDir = sliceDir - dot(sliceDir, viewDir) * viewDir;
+		vec3 axis = normalize(cross(orthoDir, viewDir));
+
+		// Normal projected into the slice plane and its angle to the view vector
+		vec3 projNormal = normal - axis * dot(normal, axis);
+		float projLength = length(projNormal);
+		float cosN = clamp(dot(projNormal, viewDir) / max(projLength, 1e-6), 0.0, 1.0);
+		float n = sign(dot(orthoDir, projNormal)) * acos(cosN);
+
+		// Search both horizons, starting at the tangent plane
+		float lowHorizonCos0 = cos(n + HALF_PI);
+		float lowHorizonCos1 = cos(n - HALF_PI);
+		float horizonCos0 = lowHorizonCos0;
+		float horizonCos1 = lowHorizonCos1;
+		for (int s = 0; s < GTAO_STEPS; s++)
+		{
+			vec2 offset = direction * (1.0 + (float(s) + noise.y) * stepPixels) / dim;
+			horizonCos0 = max(horizonCos0, horizonCos(inUV + offset, inUV, dim, fragPos, viewDir, lowHorizonCos0));
+			horizonCos1 = max(horizonCos1, horizonCos(inUV - offset, inUV, dim, fragPos, viewDir, lowHorizonCos1));
+		}
+
+		// Clamp the horizons to the hemisphere around the normal and integrate the visibility arc analytically
+		float h0 = -acos(horizonCos1);
+		float h1 = acos(horizonCos0);
+		h0 = n + clamp(h0 - n, -HALF_PI, HALF_PI);
+		h1 = n + clamp(h1 - n, -HALF_PI, HALF_PI);
+		float arc0 = (cosN + 2.0 * h0 * sin(n) - cos(2.0 * h0 - n)) * 0.25;
+		float arc1 = (cosN + 2.0 * h1 * sin(n) - cos(2.0 * h1 - n)) * 0.25;
+		visibility += projLength * (arc0 + arc1);
+	}
+
+	outFragColor = clamp(visibility / float(GTAO_SLICES), 0.0, 1.0);
+}
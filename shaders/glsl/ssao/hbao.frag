@@ -0,0 +1,93 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+// Horizon based ambient occlusion, using the per sample horizon term of HBAO+
+// Uses the same inputs and output as ssao.frag, the kernel UBO is not used
+
+layout (binding = 0) uniform sampler2D samplerPositionDepth;
+layout (binding = 1) uniform sampler2D samplerNormal;
+layout (binding = 2) uniform sampler2D ssaoNoise;
+layout (binding = 6) uniform sampler2D samplerLinearDepth;
+layout (binding = 7) uniform sampler2D samplerDepthPyramid;
+
+// The kernel size is the sample budget, which is split into directions with several steps each
+layout (constant_id = 0) const int SSAO_KERNEL_SIZE = 64;
+layout (constant_id = 1) const float SSAO_RADIUS = 0.5;
+layout (constant_id = 2) const bool POSITION_FROM_DEPTH = false;
+layout (constant_id = 3) const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.glsl"
+
+layout (binding = 4) uniform UBO
+{
+	mat4 projection;
+	mat4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	mat4 reprojection;
+	int samplesPerFrame;
+	int resetHistory;
+	int depthPyramidLevels;
+} ubo;
+
+#include "gbufferposition.glsl"
+#include "depthpyramid.glsl"
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out float outFragColor;
+
+const int HBAO_DIRECTIONS = 8;
+const int HBAO_STEPS = SSAO_KERNEL_SIZE / HBAO_DIRECTIONS;
+const float PI = 3.14159265359;
+// Sine of the angle above the tangent plane below which samples don't occlude, avoids self occlusion on flat surfaces
+const float angleBias = 0.1;
+
+void main()
+{
+	vec3 fragPos = getViewPosition(inUV);
+	float depth = -fragPos.z;
+	// Background pixels without a position are not occluded
+	if (depth <= 0.0) {
+		outFragColor = 1.0;
+		return;
+	}
+	vec3 normal = decodeNormal(texture(samplerNormal, inUV));
+	vec2 dim = vec2(textureSize(samplerLinearDepth, 0));
+
+	// Project the view space radius to pixels, steps are at least one pixel apart
+	float radiusPixels = 0.5 * SSAO_RADIUS * abs(ubo.projection[1][1]) * dim.y / depth;
+	float stepPixels = max(radiusPixels / float(HBAO_STEPS), 1.0);
+
+	// Per pixel rotation of the directions and jitter of the steps from the noise texture
+	ivec2 noiseDim = textureSize(ssaoNoise, 0);
+	vec2 noise = texelFetch(ssaoNoise, ivec2(inUV * dim) % noiseDim, 0).xy;
+	float rotation = noise.x * PI;
+	float jitter = noise.y * 0.5 + 0.5;
+
+	float occlusion = 0.0;
+	for (int d = 0; d < HBAO_DIRECTIONS; d++)
+	{
+		float angle = rotation + 2.0 * PI * float(d) / float(HBAO_DIRECTIONS);
+		vec2 direction = vec2(cos(angle), sin(angle));
+		for (int s = 0; s < HBAO_STEPS; s++)
+		{
+			vec2 sampleUV = inUV + direction * (1.0 + (float(s) + jitter) * stepPixels) / dim;
+			if (any(lessThan(sampleUV, vec2(0.0))) || any(greaterThan(sampleUV, vec2(1.0)))) {
+				break;
+			}
+			vec3 samplePos = getViewPositionFromLinearDepth(sampleUV, sampleLinearDepth(sampleUV, inUV, dim));
+			vec3 v = samplePos - fragPos;
+			float vv = dot(v, v);
+			float nDotV = dot(normal, v) * inversesqrt(max(vv, 1e-6));
+			// Quadratic falloff that reaches zero at the radius
+			float falloff = clamp(1.0 - vv / (SSAO_RADIUS * SSAO_RADIUS), 0.0, 1.0);
+			occlusion += clamp(nDotV - angleBias, 0.0, 1.0) * falloff;
+		}
+	}
+
+	outFragColor = 1.0 - occlusion / float(HBAO_DIRECTIONS * HBAO_STEPS);
+}
@@ -0,0 +1,52 @@
+// G-Buffer normal encodings, must match the NormalEncoding enum on the host side
+// The including shader declares the NORMAL_ENCODING specialization constant
+const int NORMAL_ENCODING_RGBA8 = 0;
+// Octahedral encoding stored in a signed two channel format (R16G16_SNORM or R16G16_SFLOAT)
+const int NORMAL_ENCODING_OCT16 = 1;
+// Octahedral encoding remapped to [0..1] and stored in R8G8_UNORM
+const int NORMAL_ENCODING_OCT8 = 2;
+
+vec2 signNotZero(vec2 v)
+{
+	return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Projects the normal onto the octahedron and unfolds the lower hemisphere into the corners of the [-1..1] square
+vec2 octEncode(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	return (n.z >= 0.0) ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+}
+
+vec3 octDecode(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0) {
+		n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+	}
+	return normalize(n);
+}
+
+vec4 encodeNormal(vec3 n)
+{
+	switch (NORMAL_ENCODING) {
+		case NORMAL_ENCODING_OCT16:
+			return vec4(octEncode(n), 0.0, 1.0);
+		case NORMAL_ENCODING_OCT8:
+			return vec4(octEncode(n) * 0.5 + 0.5, 0.0, 1.0);
+		default:
+			return vec4(n * 0.5 + 0.5, 1.0);
+	}
+}
+
+vec3 decodeNormal(vec4 encoded)
+{
+	switch (NORMAL_ENCODING) {
+		case NORMAL_ENCODING_OCT16:
+			return octDecode(encoded.xy);
+		case NORMAL_ENCODING_OCT8:
+			return octDecode(encoded.xy * 2.0 - 1.0);
+		default:
+			return normalize(encoded.rgb * 2.0 - 1.0);
+	}
+}
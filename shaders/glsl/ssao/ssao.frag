@@ -1,11 +1,19 @@
 #version 450
 
+#extension GL_GOOGLE_include_directive : require
+
 layout (binding = 0) uniform sampler2D samplerPositionDepth;
 layout (binding = 1) uniform sampler2D samplerNormal;
 layout (binding = 2) uniform sampler2D ssaoNoise;
+layout (binding = 6) uniform sampler2D samplerLinearDepth;
+layout (binding = 7) uniform sampler2D samplerDepthPyramid;
 
 layout (constant_id = 0) const int SSAO_KERNEL_SIZE = 64;
 layout (constant_id = 1) const float SSAO_RADIUS = 0.5;
+layout (constant_id = 2) const bool POSITION_FROM_DEPTH = false;
+layout (constant_id = 3) const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.glsl"
 
 layout (binding = 3) uniform UBOSSAOKernel
 {
@@ -15,8 +23,22 @@ layout (binding = 3) uniform UBOSSAOKernel
 layout (binding = 4) uniform UBO 
 {
 	mat4 projection;
+	mat4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	mat4 reprojection;
+	// Number of kernel samples evaluated per frame, less than the kernel size if results are accumulated temporally
+	int samplesPerFrame;
+	int resetHistory;
+	// Number of levels of the depth pyramid, zero if samples are read from the full resolution linear depth
+	int depthPyramidLevels;
 } ubo;
 
+#include "gbufferposition.glsl"
+#include "depthpyramid.glsl"
+
 layout (location = 0) in vec2 inUV;
 
 layout (location = 0) out float outFragColor;
@@ -24,13 +46,19 @@ layout (location = 0) out float outFragColor;
 void main() 
 {
 	// Get G-Buffer values
-	vec3 fragPos = texture(samplerPositionDepth, inUV).rgb;
-	vec3 normal = normalize(texture(samplerNormal, inUV).rgb * 2.0 - 1.0);
+	vec3 fragPos = getViewPosition(inUV);
+	vec3 normal = decodeNormal(texture(samplerNormal, inUV));
+
+	// In temporal mode each frame evaluates the next subset of the kernel, the noise pattern moves after each full cycle
+	// Without temporal accumulation the frame index is zero and all samples are evaluated
+	int cycleLength = SSAO_KERNEL_SIZE / ubo.samplesPerFrame;
+	int firstSample = (ubo.frameIndex % cycleLength) * ubo.samplesPerFrame;
+	vec2 noiseShift = vec2(ivec2(ubo.frameIndex / cycleLength) * ivec2(1, 3));
 
 	// Get a random vector using a noise lookup
-	ivec2 texDim = textureSize(samplerPositionDepth, 0); 
+	ivec2 texDim = textureSize(samplerLinearDepth, 0);
 	ivec2 noiseDim = textureSize(ssaoNoise, 0);
-	const vec2 noiseUV = vec2(float(texDim.x)/float(noiseDim.x), float(texDim.y)/(noiseDim.y)) * inUV;  
+	const vec2 noiseUV = vec2(float(texDim.x)/float(noiseDim.x), float(texDim.y)/(noiseDim.y)) * inUV + noiseShift / vec2(noiseDim);
 	vec3 randomVec = texture(ssaoNoise, noiseUV).xyz * 2.0 - 1.0;
 	
 	// Create TBN matrix
@@ -42,9 +70,9 @@ void main()
 	float occlusion = 0.0f;
 	// remove banding
 	const float bias = 0.025f;
-	for(int i = 0; i < SSAO_KERNEL_SIZE; i++)
+	for(int i = 0; i < ubo.samplesPerFrame; i++)
 	{		
-		vec3 samplePos = TBN * uboSSAOKernel.samples[i].xyz; 
+		vec3 samplePos = TBN * uboSSAOKernel.samples[(firstSample + i) % SSAO_KERNEL_SIZE].xyz; 
 		samplePos = fragPos + samplePos * SSAO_RADIUS; 
 		
 		// project
@@ -53,12 +81,13 @@ void main()
 		offset.xyz /= offset.w; 
 		offset.xyz = offset.xyz * 0.5f + 0.5f; 
 		
-		float sampleDepth = -texture(samplerPositionDepth, offset.xy).w; 
+		// Sample depths are read from the linear depth target at SSAO resolution or the depth pyramid level matching the sample distance
+		float sampleDepth = -sampleLinearDepth(offset.xy, inUV, vec2(texDim));
 
 		float rangeCheck = smoothstep(0.0f, 1.0f, SSAO_RADIUS / abs(fragPos.z - sampleDepth));
 		occlusion += (sampleDepth >= samplePos.z + bias ? 1.0f : 0.0f) * rangeCheck;           
 	}
-	occlusion = 1.0 - (occlusion / float(SSAO_KERNEL_SIZE));
+	occlusion = 1.0 - (occlusion / float(ubo.samplesPerFrame));
 	
 	outFragColor = occlusion;
 }
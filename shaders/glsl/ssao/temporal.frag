@@ -0,0 +1,61 @@
+#version 450
+
+// Temporal accumulation of SSAO results that only evaluate a subset of the kernel each frame
+
+layout (binding = 0) uniform sampler2D samplerSSAO;
+layout (binding = 1) uniform sampler2D samplerLinearDepth;
+// Accumulated result of the previous frame: AO, linear depth and number of accumulated frames
+layout (binding = 2) uniform sampler2D samplerHistory;
+
+layout (binding = 3) uniform UBO
+{
+	mat4 projection;
+	mat4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	// Transforms current view space positions into the previous frame's clip space
+	mat4 reprojection;
+	int samplesPerFrame;
+	int resetHistory;
+} ubo;
+
+layout (constant_id = 0) const int SSAO_KERNEL_SIZE = 64;
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out vec4 outFragColor;
+
+// Relative depth difference above which the history is treated as disoccluded
+const float disocclusionThreshold = 0.05;
+
+void main()
+{
+	float ao = texture(samplerSSAO, inUV).r;
+	float depth = texture(samplerLinearDepth, inUV).r;
+
+	// Reconstruct the view space position from the linear depth
+	vec4 ray = ubo.invProjection * vec4(inUV * 2.0 - 1.0, 1.0, 1.0);
+	ray.xyz /= ray.w;
+	vec3 viewPos = ray.xyz * (depth / -ray.z);
+
+	// Reproject into the previous frame
+	vec4 prevClip = ubo.reprojection * vec4(viewPos, 1.0);
+	vec2 prevUV = (prevClip.xy / prevClip.w) * 0.5 + 0.5;
+
+	bool valid = (ubo.resetHistory == 0) && (depth > 0.0) && all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)));
+	vec4 history = vec4(0.0);
+	if (valid) {
+		history = texture(samplerHistory, prevUV);
+		// The surface seen at the reprojected position last frame must be the same one (depth disocclusion)
+		valid = abs(history.g - prevClip.w) <= disocclusionThreshold * prevClip.w;
+	}
+
+	// Running average over the frames it takes to cycle through the whole kernel, then an exponential moving average
+	float maxFrames = float(SSAO_KERNEL_SIZE / ubo.samplesPerFrame);
+	float frames = valid ? min(history.b + 1.0, maxFrames) : 1.0;
+	float result = valid ? mix(history.r, ao, 1.0 / frames) : ao;
+
+	outFragColor = vec4(result, depth, frames, 1.0);
+}
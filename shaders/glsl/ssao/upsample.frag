@@ -0,0 +1,65 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+layout (binding = 0) uniform sampler2D samplerSSAO;
+layout (binding = 1) uniform sampler2D samplerSSAOBlur;
+layout (binding = 2) uniform sampler2D samplerLinearDepth;
+layout (binding = 3) uniform sampler2D samplerPositionDepth;
+
+layout (binding = 4) uniform UBO
+{
+	mat4 projection;
+	mat4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+} ubo;
+
+layout (constant_id = 0) const bool POSITION_FROM_DEPTH = false;
+
+#include "gbufferposition.glsl"
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out float outFragColor;
+
+// Relative depth difference at which a low resolution sample's weight has fallen to 1/e
+const float depthSharpness = 0.05;
+
+void main()
+{
+	// Background pixels have no depth in the position attachment
+	float depth = max(getLinearDepth(inUV), 1e-3);
+
+	// The four low resolution texels surrounding this pixel (bilinear footprint)
+	ivec2 lowResSize = textureSize(samplerLinearDepth, 0);
+	vec2 pos = inUV * vec2(lowResSize) - 0.5;
+	ivec2 base = ivec2(floor(pos));
+	vec2 f = fract(pos);
+	const ivec2 offsets[4] = ivec2[](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1));
+	float bilinearWeights[4] = float[]((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+
+	// Joint bilateral upsampling: bilinear weights are attenuated by the depth difference to the full resolution pixel
+	// so occlusion doesn't bleed across silhouettes
+	float result = 0.0;
+	float weightSum = 0.0;
+	float nearestDepthDiff = 1e30;
+	float nearestAO = 1.0;
+	for (int i = 0; i < 4; i++) {
+		ivec2 texel = clamp(base + offsets[i], ivec2(0), lowResSize - 1);
+		float sampleDepth = texelFetch(samplerLinearDepth, texel, 0).r;
+		float ao = (ubo.ssaoBlur == 1) ? texelFetch(samplerSSAOBlur, texel, 0).r : texelFetch(samplerSSAO, texel, 0).r;
+		float depthDiff = abs(depth - sampleDepth);
+		float weight = bilinearWeights[i] * exp(-depthDiff / (depthSharpness * depth));
+		result += ao * weight;
+		weightSum += weight;
+		if (depthDiff < nearestDepthDiff) {
+			nearestDepthDiff = depthDiff;
+			nearestAO = ao;
+		}
+	}
+
+	// If no low resolution sample is on the same surface, fall back to the one closest in depth
+	outFragColor = (weightSum > 1e-4) ? result / weightSum : nearestAO;
+}
@@ -1,7 +1,7 @@
 // Copyright 2020 Google LLC
 
-Texture2D textureposition : register(t0);
-SamplerState samplerposition : register(s0);
+Texture2D texturePositionDepth : register(t0);
+SamplerState samplerPositionDepth : register(s0);
 Texture2D textureNormal : register(t1);
 SamplerState samplerNormal : register(s1);
 Texture2D textureAlbedo : register(t2);
@@ -12,27 +12,40 @@ Texture2D textureSSAOBlur : register(t4);
 SamplerState samplerSSAOBlur : register(s4);
 struct UBO
 {
-	float4x4 _dummy;
+	float4x4 projection;
+	float4x4 invProjection;
 	int ssao;
 	int ssaoOnly;
 	int ssaoBlur;
 };
-cbuffer uboParams : register(b5) { UBO uboParams; };
+cbuffer ubo : register(b5) { UBO ubo; };
+
+// If set, binding 0 is the depth attachment and view space positions are reconstructed from it
+[[vk::constant_id(0)]] const bool POSITION_FROM_DEPTH = false;
+[[vk::constant_id(1)]] const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.hlsl"
+#include "gbufferposition.hlsl"
 
 float4 main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
 {
-	float3 fragPos = textureposition.Sample(samplerposition, inUV).rgb;
-	float3 normal = normalize(textureNormal.Sample(samplerNormal, inUV).rgb * 2.0 - 1.0);
+	float3 fragPos = getViewPosition(inUV);
+	float3 normal = decodeNormal(textureNormal.Sample(samplerNormal, inUV));
 	float4 albedo = textureAlbedo.Sample(samplerAlbedo, inUV);
 
-	float ssao = (uboParams.ssaoBlur == 1) ? textureSSAOBlur.Sample(samplerSSAOBlur, inUV).r : textureSSAO.Sample(samplerSSAO, inUV).r;
+	// The AO targets are only written if they are used, so they are only sampled then
+	float ssao = 1.0;
+	if (ubo.ssao == 1 || ubo.ssaoOnly == 1)
+	{
+		ssao = (ubo.ssaoBlur == 1) ? textureSSAOBlur.Sample(samplerSSAOBlur, inUV).r : textureSSAO.Sample(samplerSSAO, inUV).r;
+	}
 
 	float3 lightPos = float3(0.0, 0.0, 0.0);
 	float3 L = normalize(lightPos - fragPos);
 	float NdotL = max(0.5, dot(normal, L));
 
 	float4 outFragColor;
-	if (uboParams.ssaoOnly == 1)
+	if (ubo.ssaoOnly == 1)
 	{
 		outFragColor.rgb = ssao.rrr;
 	}
@@ -40,11 +53,11 @@ float4 main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
 	{
 		float3 baseColor = albedo.rgb * NdotL;
 
-		if (uboParams.ssao == 1)
+		if (ubo.ssao == 1)
 		{
 			outFragColor.rgb = ssao.rrr;
 
-			if (uboParams.ssaoOnly != 1)
+			if (ubo.ssaoOnly != 1)
 				outFragColor.rgb *= baseColor;
 		}
 		else
@@ -53,4 +66,4 @@ float4 main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
 		}
 	}
 	return outFragColor;
-}
\ No newline at end of file
+}
@@ -0,0 +1,20 @@
+Texture2D texturePositionDepth : register(t0);
+SamplerState samplerPositionDepth : register(s0);
+
+struct UBO
+{
+	float4x4 projection;
+	float4x4 invProjection;
+};
+cbuffer ubo : register(b1) { UBO ubo; };
+
+[[vk::constant_id(0)]] const bool POSITION_FROM_DEPTH = false;
+
+#include "gbufferposition.hlsl"
+
+float main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
+{
+	// Point sample the full resolution G-Buffer at the center of the SSAO texel
+	// This picks the same G-Buffer texel as the nearest lookups of the SSAO pass, so depth and position stay consistent
+	return getLinearDepth(inUV);
+}
@@ -0,0 +1,17 @@
+// Sampling of the min/max linear depth pyramid
+// The including shader declares textureLinearDepth, textureDepthPyramid, their samplers and a constant buffer instance named ubo that contains depthPyramidLevels
+
+// Samples closer than 2^LOG_MAX_OFFSET pixels to the center always read the full resolution level
+#define LOG_MAX_OFFSET 3
+
+// Returns the linear depth at uv, read from the pyramid level that matches the screen space distance to the pixel being shaded
+// Coarser levels return the closest depth of their footprint
+float sampleLinearDepth(float2 uv, float2 centerUV, float2 dim)
+{
+	if (ubo.depthPyramidLevels == 0) {
+		return textureLinearDepth.SampleLevel(samplerLinearDepth, uv, 0.0).r;
+	}
+	float screenDistance = length((uv - centerUV) * dim);
+	float level = clamp(floor(log2(max(screenDistance, 1.0))) - float(LOG_MAX_OFFSET), 0.0, float(ubo.depthPyramidLevels - 1));
+	return textureDepthPyramid.SampleLevel(samplerDepthPyramid, uv, level).r;
+}
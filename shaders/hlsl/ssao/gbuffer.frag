@@ -23,6 +23,12 @@ cbuffer ubo : register(b0) { UBO ubo; }
 Texture2D textureColorMap : register(t0, space1);
 SamplerState samplerColorMap : register(s0, space1);
 
+// If set, view space positions are reconstructed from the depth attachment and the position attachment is unused
+[[vk::constant_id(0)]] const bool POSITION_FROM_DEPTH = false;
+[[vk::constant_id(1)]] const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.hlsl"
+
 struct FSOutput
 {
 	float4 Position : SV_TARGET0;
@@ -39,8 +45,10 @@ float linearDepth(float depth)
 FSOutput main(VSOutput input)
 {
 	FSOutput output = (FSOutput)0;
-	output.Position = float4(input.WorldPos, linearDepth(input.Pos.z));
-	output.Normal = float4(normalize(input.Normal) * 0.5 + 0.5, 1.0);
+	if (!POSITION_FROM_DEPTH) {
+		output.Position = float4(input.WorldPos, linearDepth(input.Pos.z));
+	}
+	output.Normal = encodeNormal(normalize(input.Normal));
 	output.Albedo = textureColorMap.Sample(samplerColorMap, input.UV) * float4(input.Color, 1.0);
 	return output;
-}
\ No newline at end of file
+}
@@ -0,0 +1,32 @@
+// Access to the view space positions stored in (or reconstructed from) the G-Buffer
+// The including shader declares texturePositionDepth, samplerPositionDepth, the POSITION_FROM_DEPTH specialization constant
+// and a constant buffer instance named ubo that contains the inverse projection matrix
+
+// Returns the view space position, either read from the position attachment or reconstructed from the depth attachment
+float3 getViewPosition(float2 uv)
+{
+	if (POSITION_FROM_DEPTH) {
+		float4 pos = mul(ubo.invProjection, float4(uv * 2.0 - 1.0, texturePositionDepth.SampleLevel(samplerPositionDepth, uv, 0.0).r, 1.0));
+		return pos.xyz / pos.w;
+	}
+	return texturePositionDepth.SampleLevel(samplerPositionDepth, uv, 0.0).rgb;
+}
+
+// Returns the linear view space depth (positive in front of the camera)
+float getLinearDepth(float2 uv)
+{
+	if (POSITION_FROM_DEPTH) {
+		// Only the z and w rows of the inverse projection depend on the depth value
+		float depth = texturePositionDepth.SampleLevel(samplerPositionDepth, uv, 0.0).r;
+		return -(ubo.invProjection[2][2] * depth + ubo.invProjection[2][3]) / (ubo.invProjection[3][2] * depth + ubo.invProjection[3][3]);
+	}
+	return texturePositionDepth.SampleLevel(samplerPositionDepth, uv, 0.0).w;
+}
+
+// Returns the view space position for a linear depth (positive in front of the camera) at uv
+float3 getViewPositionFromLinearDepth(float2 uv, float linearDepth)
+{
+	float4 ray = mul(ubo.invProjection, float4(uv * 2.0 - 1.0, 1.0, 1.0));
+	ray.xyz /= ray.w;
+	return ray.xyz * (linearDepth / -ray.z);
+}
@@ -0,0 +1,122 @@
+// Ground truth ambient occlusion (Jimenez et al. 2016)
+// Finds the two horizons in a number of slices around the view vector and integrates the cosine weighted visibility between them
+// Uses the same inputs and output as ssao.frag, the kernel constant buffer is not used
+
+Texture2D texturePositionDepth : register(t0);
+SamplerState samplerPositionDepth : register(s0);
+Texture2D textureNormal : register(t1);
+SamplerState samplerNormal : register(s1);
+Texture2D ssaoNoiseTexture : register(t2);
+SamplerState ssaoNoiseSampler : register(s2);
+Texture2D textureLinearDepth : register(t6);
+SamplerState samplerLinearDepth : register(s6);
+Texture2D textureDepthPyramid : register(t7);
+SamplerState samplerDepthPyramid : register(s7);
+
+// The kernel size is the sample budget, each slice marches GTAO_STEPS samples in both directions
+[[vk::constant_id(0)]] const int SSAO_KERNEL_SIZE = 64;
+[[vk::constant_id(1)]] const float SSAO_RADIUS = 0.5;
+[[vk::constant_id(2)]] const bool POSITION_FROM_DEPTH = false;
+[[vk::constant_id(3)]] const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.hlsl"
+
+struct UBO
+{
+	float4x4 projection;
+	float4x4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	float4x4 reprojection;
+	int samplesPerFrame;
+	int resetHistory;
+	int depthPyramidLevels;
+};
+cbuffer ubo : register(b4) { UBO ubo; };
+
+#include "gbufferposition.hlsl"
+#include "depthpyramid.hlsl"
+
+#define GTAO_STEPS 8
+#define PI 3.14159265359
+#define HALF_PI 1.57079632679
+
+// Returns the cosine of the angle between the view vector and the direction to the sample
+// Samples are faded towards the lowest possible horizon between 60% and 100% of the radius
+float horizonCos(float2 sampleUV, float2 centerUV, float2 dim, float3 fragPos, float3 viewDir, float lowHorizonCos)
+{
+	float3 samplePos = getViewPositionFromLinearDepth(sampleUV, sampleLinearDepth(clamp(sampleUV, 0.0, 1.0), centerUV, dim));
+	float3 delta = samplePos - fragPos;
+	float dist = length(delta);
+	float weight = saturate((SSAO_RADIUS - dist) / (0.4 * SSAO_RADIUS));
+	return lerp(lowHorizonCos, dot(delta / max(dist, 1e-6), viewDir), weight);
+}
+
+float main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
+{
+	// Rounded up so that small kernels still evaluate one slice
+	const int slices = (SSAO_KERNEL_SIZE + 2 * GTAO_STEPS - 1) / (2 * GTAO_STEPS);
+	float3 fragPos = getViewPosition(inUV);
+	float depth = -fragPos.z;
+	// Background pixels without a position are not occluded
+	if (depth <= 0.0) {
+		return 1.0;
+	}
+	float3 normal = decodeNormal(textureNormal.Sample(samplerNormal, inUV));
+	float3 viewDir = normalize(-fragPos);
+	int2 texDim;
+	textureLinearDepth.GetDimensions(texDim.x, texDim.y);
+	float2 dim = float2(texDim);
+
+	// Project the view space radius to pixels, steps are at least one pixel apart
+	float radiusPixels = 0.5 * SSAO_RADIUS * abs(ubo.projection[1][1]) * dim.y / depth;
+	float stepPixels = max(radiusPixels / float(GTAO_STEPS), 1.0);
+
+	// Per pixel rotation of the slices and jitter of the steps from the noise texture
+	int2 noiseDim;
+	ssaoNoiseTexture.GetDimensions(noiseDim.x, noiseDim.y);
+	float2 noise = ssaoNoiseTexture.Load(int3(int2(inUV * dim) % noiseDim, 0)).xy * 0.5 + 0.5;
+
+	float visibility = 0.0;
+	for (int slice = 0; slice < slices; slice++)
+	{
+		float phi = (float(slice) + noise.x) * PI / float(slices);
+		float2 direction = float2(cos(phi), sin(phi));
+
+		// View space direction of the slice, found by unprojecting the screen space direction at the pixel's depth
+		float3 sliceDir = normalize(getViewPositionFromLinearDepth(inUV + direction / dim, depth) - getViewPositionFromLinearDepth(inUV, depth));
+		float3 orthoDir = sliceDir - dot(sliceDir, viewDir) * viewDir;
+		float3 axis = normalize(cross(orthoDir, viewDir));
+
+		// Normal projected into the slice plane and its angle to the view vector
+		float3 projNormal = normal - axis * dot(normal, axis);
+		float projLength = length(projNormal);
+		float cosN = saturate(dot(projNormal, viewDir) / max(projLength, 1e-6));
+		float n = sign(dot(orthoDir, projNormal)) * acos(cosN);
+
+		// Search both horizons, starting at the tangent plane
+		float lowHorizonCos0 = cos(n + HALF_PI);
+		float lowHorizonCos1 = cos(n - HALF_PI);
+		float horizonCos0 = lowHorizonCos0;
+		float horizonCos1 = lowHorizonCos1;
+		for (int s = 0; s < GTAO_STEPS; s++)
+		{
+			float2 offset = direction * (1.0 + (float(s) + noise.y) * stepPixels) / dim;
+			horizonCos0 = max(horizonCos0, horizonCos(inUV + offset, inUV, dim, fragPos, viewDir, lowHorizonCos0));
+			horizonCos1 = max(horizonCos1, horizonCos(inUV - offset, inUV, dim, fragPos, viewDir, lowHorizonCos1));
+		}
+
+		// Clamp the horizons to the hemisphere around the normal and integrate the visibility arc analytically
+		float h0 = -acos(horizonCos1);
+		float h1 = acos(horizonCos0);
+		h0 = n + clamp(h0 - n, -HALF_PI, HALF_PI);
+		h1 = n + clamp(h1 - n, -HALF_PI, HALF_PI);
+		float arc0 = (cosN + 2.0 * h0 * sin(n) - cos(2.0 * h0 - n)) * 0.25;
+		float arc1 = (cosN + 2.0 * h1 * sin(n) - cos(2.0 * h1 - n)) * 0.25;
+		visibility += projLength * (arc0 + arc1);
+	}
+
+	return saturate(visibility / float(slices));
+}
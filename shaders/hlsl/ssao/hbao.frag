@@ -0,0 +1,93 @@
+// Horizon based ambient occlusion, using the per sample horizon term of HBAO+
+// Uses the same inputs and output as ssao.frag, the kernel constant buffer is not used
+
+Texture2D texturePositionDepth : register(t0);
+SamplerState samplerPositionDepth : register(s0);
+Texture2D textureNormal : register(t1);
+SamplerState samplerNormal : register(s1);
+Texture2D ssaoNoiseTexture : register(t2);
+SamplerState ssaoNoiseSampler : register(s2);
+Texture2D textureLinearDepth : register(t6);
+SamplerState samplerLinearDepth : register(s6);
+Texture2D textureDepthPyramid : register(t7);
+SamplerState samplerDepthPyramid : register(s7);
+
+// The kernel size is the sample budget, which is split into directions with several steps each
+[[vk::constant_id(0)]] const int SSAO_KERNEL_SIZE = 64;
+[[vk::constant_id(1)]] const float SSAO_RADIUS = 0.5;
+[[vk::constant_id(2)]] const bool POSITION_FROM_DEPTH = false;
+[[vk::constant_id(3)]] const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.hlsl"
+
+struct UBO
+{
+	float4x4 projection;
+	float4x4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	float4x4 reprojection;
+	int samplesPerFrame;
+	int resetHistory;
+	int depthPyramidLevels;
+};
+cbuffer ubo : register(b4) { UBO ubo; };
+
+#include "gbufferposition.hlsl"
+#include "depthpyramid.hlsl"
+
+#define HBAO_DIRECTIONS 8
+#define PI 3.14159265359
+// Sine of the angle above the tangent plane below which samples don't occlude, avoids self occlusion on flat surfaces
+static const float angleBias = 0.1;
+
+float main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
+{
+	const int steps = SSAO_KERNEL_SIZE / HBAO_DIRECTIONS;
+	float3 fragPos = getViewPosition(inUV);
+	float depth = -fragPos.z;
+	// Background pixels without a position are not occluded
+	if (depth <= 0.0) {
+		return 1.0;
+	}
+	float3 normal = decodeNormal(textureNormal.Sample(samplerNormal, inUV));
+	int2 texDim;
+	textureLinearDepth.GetDimensions(texDim.x, texDim.y);
+	float2 dim = float2(texDim);
+
+	// Project the view space radius to pixels, steps are at least one pixel apart
+	float radiusPixels = 0.5 * SSAO_RADIUS * abs(ubo.projection[1][1]) * dim.y / depth;
+	float stepPixels = max(radiusPixels / float(steps), 1.0);
+
+	// Per pixel rotation of the directions and jitter of the steps from the noise texture
+	int2 noiseDim;
+	ssaoNoiseTexture.GetDimensions(noiseDim.x, noiseDim.y);
+	float2 noise = ssaoNoiseTexture.Load(int3(int2(inUV * dim) % noiseDim, 0)).xy;
+	float rotation = noise.x * PI;
+	float jitter = noise.y * 0.5 + 0.5;
+
+	float occlusion = 0.0;
+	for (int d = 0; d < HBAO_DIRECTIONS; d++)
+	{
+		float angle = rotation + 2.0 * PI * float(d) / float(HBAO_DIRECTIONS);
+		float2 direction = float2(cos(angle), sin(angle));
+		for (int s = 0; s < steps; s++)
+		{
+			float2 sampleUV = inUV + direction * (1.0 + (float(s) + jitter) * stepPixels) / dim;
+			if (any(sampleUV < 0.0) || any(sampleUV > 1.0)) {
+				break;
+			}
+			float3 samplePos = getViewPositionFromLinearDepth(sampleUV, sampleLinearDepth(sampleUV, inUV, dim));
+			float3 v = samplePos - fragPos;
+			float vv = dot(v, v);
+			float nDotV = dot(normal, v) * rsqrt(max(vv, 1e-6));
+			// Quadratic falloff that reaches zero at the radius
+			float falloff = saturate(1.0 - vv / (SSAO_RADIUS * SSAO_RADIUS));
+			occlusion += saturate(nDotV - angleBias) * falloff;
+		}
+	}
+
+	return 1.0 - occlusion / float(HBAO_DIRECTIONS * steps);
+}
@@ -0,0 +1,50 @@
+// G-Buffer normal encodings, must match the NormalEncoding enum on the host side
+// The including shader declares the NORMAL_ENCODING specialization constant
+#define NORMAL_ENCODING_RGBA8 0
+// Octahedral encoding stored in a signed two channel format (R16G16_SNORM or R16G16_SFLOAT)
+#define NORMAL_ENCODING_OCT16 1
+// Octahedral encoding remapped to [0..1] and stored in R8G8_UNORM
+#define NORMAL_ENCODING_OCT8 2
+
+float2 signNotZero(float2 v)
+{
+	return float2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Projects the normal onto the octahedron and unfolds the lower hemisphere into the corners of the [-1..1] square
+float2 octEncode(float3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	return (n.z >= 0.0) ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+}
+
+float3 octDecode(float2 e)
+{
+	float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0) {
+		n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+	}
+	return normalize(n);
+}
+
+float4 encodeNormal(float3 n)
+{
+	if (NORMAL_ENCODING == NORMAL_ENCODING_OCT16) {
+		return float4(octEncode(n), 0.0, 1.0);
+	}
+	if (NORMAL_ENCODING == NORMAL_ENCODING_OCT8) {
+		return float4(octEncode(n) * 0.5 + 0.5, 0.0, 1.0);
+	}
+	return float4(n * 0.5 + 0.5, 1.0);
+}
+
+float3 decodeNormal(float4 encoded)
+{
+	if (NORMAL_ENCODING == NORMAL_ENCODING_OCT16) {
+		return octDecode(encoded.xy);
+	}
+	if (NORMAL_ENCODING == NORMAL_ENCODING_OCT8) {
+		return octDecode(encoded.xy * 2.0 - 1.0);
+	}
+	return normalize(encoded.rgb * 2.0 - 1.0);
+}
@@ -6,10 +6,18 @@ Texture2D textureNormal : register(t1);
 SamplerState samplerNormal : register(s1);
 Texture2D ssaoNoiseTexture : register(t2);
 SamplerState ssaoNoiseSampler : register(s2);
+Texture2D textureLinearDepth : register(t6);
+SamplerState samplerLinearDepth : register(s6);
+Texture2D textureDepthPyramid : register(t7);
+SamplerState samplerDepthPyramid : register(s7);
 
 #define SSAO_KERNEL_ARRAY_SIZE 64
 [[vk::constant_id(0)]] const int SSAO_KERNEL_SIZE = 64;
 [[vk::constant_id(1)]] const float SSAO_RADIUS = 0.5;
+[[vk::constant_id(2)]] const bool POSITION_FROM_DEPTH = false;
+[[vk::constant_id(3)]] const int NORMAL_ENCODING = 0;
+
+#include "normalencoding.hlsl"
 
 struct UBOSSAOKernel
 {
@@ -20,21 +28,41 @@ cbuffer uboSSAOKernel : register(b3) { UBOSSAOKernel uboSSAOKernel; };
 struct UBO
 {
 	float4x4 projection;
+	float4x4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	float4x4 reprojection;
+	// Number of kernel samples evaluated per frame, less than the kernel size if results are accumulated temporally
+	int samplesPerFrame;
+	int resetHistory;
+	// Number of levels of the depth pyramid, zero if samples are read from the full resolution linear depth
+	int depthPyramidLevels;
 };
 cbuffer ubo : register(b4) { UBO ubo; };
 
+#include "gbufferposition.hlsl"
+#include "depthpyramid.hlsl"
+
 float main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
 {
 	// Get G-Buffer values
-	float3 fragPos = texturePositionDepth.Sample(samplerPositionDepth, inUV).rgb;
-	float3 normal = normalize(textureNormal.Sample(samplerNormal, inUV).rgb * 2.0 - 1.0);
+	float3 fragPos = getViewPosition(inUV);
+	float3 normal = decodeNormal(textureNormal.Sample(samplerNormal, inUV));
+
+	// In temporal mode each frame evaluates the next subset of the kernel, the noise pattern moves after each full cycle
+	// Without temporal accumulation the frame index is zero and all samples are evaluated
+	int cycleLength = SSAO_KERNEL_SIZE / ubo.samplesPerFrame;
+	int firstSample = (ubo.frameIndex % cycleLength) * ubo.samplesPerFrame;
+	float2 noiseShift = float2(int2(ubo.frameIndex / cycleLength, ubo.frameIndex / cycleLength) * int2(1, 3));
 
 	// Get a random vector using a noise lookup
 	int2 texDim;
-	texturePositionDepth.GetDimensions(texDim.x, texDim.y);
+	textureLinearDepth.GetDimensions(texDim.x, texDim.y);
 	int2 noiseDim;
 	ssaoNoiseTexture.GetDimensions(noiseDim.x, noiseDim.y);
-	const float2 noiseUV = float2(float(texDim.x)/float(noiseDim.x), float(texDim.y)/(noiseDim.y)) * inUV;
+	const float2 noiseUV = float2(float(texDim.x)/float(noiseDim.x), float(texDim.y)/(noiseDim.y)) * inUV + noiseShift / float2(noiseDim);
 	float3 randomVec = ssaoNoiseTexture.Sample(ssaoNoiseSampler, noiseUV).xyz * 2.0 - 1.0;
 
 	// Create TBN matrix
@@ -44,9 +72,11 @@ float main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
 
 	// Calculate occlusion value
 	float occlusion = 0.0f;
-	for(int i = 0; i < SSAO_KERNEL_SIZE; i++)
+	// remove banding
+	const float bias = 0.025f;
+	for(int i = 0; i < ubo.samplesPerFrame; i++)
 	{
-		float3 samplePos = mul(TBN, uboSSAOKernel.samples[i].xyz);
+		float3 samplePos = mul(TBN, uboSSAOKernel.samples[(firstSample + i) % SSAO_KERNEL_SIZE].xyz);
 		samplePos = fragPos + samplePos * SSAO_RADIUS;
 
 		// project
@@ -55,13 +85,13 @@ float main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
 		offset.xyz /= offset.w;
 		offset.xyz = offset.xyz * 0.5f + 0.5f;
 
-		float sampleDepth = -texturePositionDepth.Sample(samplerPositionDepth, offset.xy).w;
+		// Sample depths are read from the linear depth target at SSAO resolution or the depth pyramid level matching the sample distance
+		float sampleDepth = -sampleLinearDepth(offset.xy, inUV, float2(texDim));
 
 		float rangeCheck = smoothstep(0.0f, 1.0f, SSAO_RADIUS / abs(fragPos.z - sampleDepth));
-		occlusion += (sampleDepth >= samplePos.z ? 1.0f : 0.0f) * rangeCheck;
+		occlusion += (sampleDepth >= samplePos.z + bias ? 1.0f : 0.0f) * rangeCheck;
 	}
-	occlusion = 1.0 - (occlusion / float(SSAO_KERNEL_SIZE));
+	occlusion = 1.0 - (occlusion / float(ubo.samplesPerFrame));
 
 	return occlusion;
 }
-
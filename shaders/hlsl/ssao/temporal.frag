@@ -0,0 +1,59 @@
+// Temporal accumulation of SSAO results that only evaluate a subset of the kernel each frame
+
+Texture2D textureSSAO : register(t0);
+SamplerState samplerSSAO : register(s0);
+Texture2D textureLinearDepth : register(t1);
+SamplerState samplerLinearDepth : register(s1);
+// Accumulated result of the previous frame: AO, linear depth and number of accumulated frames
+Texture2D textureHistory : register(t2);
+SamplerState samplerHistory : register(s2);
+
+struct UBO
+{
+	float4x4 projection;
+	float4x4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+	int frameIndex;
+	// Transforms current view space positions into the previous frame's clip space
+	float4x4 reprojection;
+	int samplesPerFrame;
+	int resetHistory;
+};
+cbuffer ubo : register(b3) { UBO ubo; };
+
+[[vk::constant_id(0)]] const int SSAO_KERNEL_SIZE = 64;
+
+// Relative depth difference above which the history is treated as disoccluded
+static const float disocclusionThreshold = 0.05;
+
+float4 main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
+{
+	float ao = textureSSAO.Sample(samplerSSAO, inUV).r;
+	float depth = textureLinearDepth.Sample(samplerLinearDepth, inUV).r;
+
+	// Reconstruct the view space position from the linear depth
+	float4 ray = mul(ubo.invProjection, float4(inUV * 2.0 - 1.0, 1.0, 1.0));
+	ray.xyz /= ray.w;
+	float3 viewPos = ray.xyz * (depth / -ray.z);
+
+	// Reproject into the previous frame
+	float4 prevClip = mul(ubo.reprojection, float4(viewPos, 1.0));
+	float2 prevUV = (prevClip.xy / prevClip.w) * 0.5 + 0.5;
+
+	bool valid = (ubo.resetHistory == 0) && (depth > 0.0) && all(prevUV >= 0.0) && all(prevUV <= 1.0);
+	float4 history = float4(0.0, 0.0, 0.0, 0.0);
+	if (valid) {
+		history = textureHistory.Sample(samplerHistory, prevUV);
+		// The surface seen at the reprojected position last frame must be the same one (depth disocclusion)
+		valid = abs(history.g - prevClip.w) <= disocclusionThreshold * prevClip.w;
+	}
+
+	// Running average over the frames it takes to cycle through the whole kernel, then an exponential moving average
+	float maxFrames = float(SSAO_KERNEL_SIZE / ubo.samplesPerFrame);
+	float frames = valid ? min(history.b + 1.0, maxFrames) : 1.0;
+	float result = valid ? lerp(history.r, ao, 1.0 / frames) : ao;
+
+	return float4(result, depth, frames, 1.0);
+}
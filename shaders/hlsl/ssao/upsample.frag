@@ -0,0 +1,63 @@
+Texture2D textureSSAO : register(t0);
+SamplerState samplerSSAO : register(s0);
+Texture2D textureSSAOBlur : register(t1);
+SamplerState samplerSSAOBlur : register(s1);
+Texture2D textureLinearDepth : register(t2);
+SamplerState samplerLinearDepth : register(s2);
+Texture2D texturePositionDepth : register(t3);
+SamplerState samplerPositionDepth : register(s3);
+
+struct UBO
+{
+	float4x4 projection;
+	float4x4 invProjection;
+	int ssao;
+	int ssaoOnly;
+	int ssaoBlur;
+};
+cbuffer ubo : register(b4) { UBO ubo; };
+
+[[vk::constant_id(0)]] const bool POSITION_FROM_DEPTH = false;
+
+#include "gbufferposition.hlsl"
+
+// Relative depth difference at which a low resolution sample's weight has fallen to 1/e
+static const float depthSharpness = 0.05;
+
+float main([[vk::location(0)]] float2 inUV : TEXCOORD0) : SV_TARGET
+{
+	// Background pixels have no depth in the position attachment
+	float depth = max(getLinearDepth(inUV), 1e-3);
+
+	// The four low resolution texels surrounding this pixel (bilinear footprint)
+	int2 lowResSize;
+	textureLinearDepth.GetDimensions(lowResSize.x, lowResSize.y);
+	float2 pos = inUV * float2(lowResSize) - 0.5;
+	int2 base = int2(floor(pos));
+	float2 f = frac(pos);
+	const int2 offsets[4] = { int2(0, 0), int2(1, 0), int2(0, 1), int2(1, 1) };
+	float bilinearWeights[4] = { (1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y };
+
+	// Joint bilateral upsampling: bilinear weights are attenuated by the depth difference to the full resolution pixel
+	// so occlusion doesn't bleed across silhouettes
+	float result = 0.0;
+	float weightSum = 0.0;
+	float nearestDepthDiff = 1e30;
+	float nearestAO = 1.0;
+	for (int i = 0; i < 4; i++) {
+		int3 texel = int3(clamp(base + offsets[i], int2(0, 0), lowResSize - 1), 0);
+		float sampleDepth = textureLinearDepth.Load(texel).r;
+		float ao = (ubo.ssaoBlur == 1) ? textureSSAOBlur.Load(texel).r : textureSSAO.Load(texel).r;
+		float depthDiff = abs(depth - sampleDepth);
+		float weight = bilinearWeights[i] * exp(-depthDiff / (depthSharpness * depth));
+		result += ao * weight;
+		weightSum += weight;
+		if (depthDiff < nearestDepthDiff) {
+			nearestDepthDiff = depthDiff;
+			nearestAO = ao;
+		}
+	}
+
+	// If no low resolution sample is on the same surface, fall back to the one closest in depth
+	return (weightSum > 1e-4) ? result / weightSum : nearestAO;
+}